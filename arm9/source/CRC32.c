@@ -9,6 +9,7 @@
 // The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
 // =====================================================================================
 #include <nds.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include "DracoUtils.h"
@@ -52,67 +53,278 @@ const u32 crc32_table[256] = {
     0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94, 0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D,  // 248 [0xF8 .. 0xFF]
 };
 
+// ------------------------------------------------------------------------------
+// Slice-by-8 tables. Table 0 is the classic table above and each of the others
+// is the one before it advanced by one more zero byte - this lets us fold eight
+// bytes into the CRC per loop with eight independent lookups instead of eight
+// dependent ones. The 7K of extra tables is built at first use.
+// ------------------------------------------------------------------------------
+static u32 crc32_slice[7][256];
+static u8  crc32_slice_ready = 0;
+
+static void crc32_build_slices(void)
+{
+    for (u32 i=0; i<256; i++)
+    {
+        u32 crc = crc32_table[i];
+        for (u8 k=0; k<7; k++)
+        {
+            crc = (crc >> 8) ^ crc32_table[crc & 0xFF];
+            crc32_slice[k][i] = crc;
+        }
+    }
+    crc32_slice_ready = 1;
+}
+
 // --------------------------------------------------
 // Compute the CRC of a memory buffer of any size...
 // --------------------------------------------------
 u32 getCRC32(u8 *buf, u32 size)
 {
-    u32 crc = 0xFFFFFFFF;
+    return CRC32_FINAL(crc32_update(CRC32_START, buf, size));
+}
 
-    for (int i=0; i < size; i++)
+// ------------------------------------------------------------------------------
+// The original one-byte-at-a-time table walk. Kept as the reference for the
+// benchmark below (and it's what the slice-by-8 must match bit-for-bit).
+// ------------------------------------------------------------------------------
+static u32 crc32_update_bytewise(u32 crc, const u8 *buf, u32 size)
+{
+    for (u32 i=0; i < size; i++)
     {
-        crc = (crc >> 8) ^ crc32_table[(crc & 0xFF) ^ (u8)buf[i]]; 
+        crc = (crc >> 8) ^ crc32_table[(crc & 0xFF) ^ buf[i]];
     }
-    
-    return ~crc;
+
+    return crc;
 }
 
+// ------------------------------------------------------------------------------
+// Streaming CRC - start with CRC32_START, feed in as many buffers as you like and
+// finish with CRC32_FINAL(). This lets us checksum a file a chunk at a time as it
+// streams in from the SD card. Output is identical to the classic table walk so
+// the CRCs used as keys in DracoDS.DAT are unchanged.
+// ------------------------------------------------------------------------------
+u32 crc32_update(u32 crc, const u8 *buf, u32 size)
+{
+    if (!crc32_slice_ready) crc32_build_slices();
 
-// ------------------------------------------------------------------------------------
-// Read the file in and compute CRC... it's a bit slow but good enough and accurate!
-// When this routine finishes, the file will be read into TapeCartDiskBuffer[]
-// ------------------------------------------------------------------------------------
-u32 getFileCrc(const char* filename)
+    // Byte at a time until we're word aligned...
+    while (size && ((uintptr_t)buf & 3))
+    {
+        crc = (crc >> 8) ^ crc32_table[(crc & 0xFF) ^ *buf++];
+        size--;
+    }
+
+    // Eight bytes per loop - the DS is little-endian so the first byte is in the low bits
+    const u32 *words = (const u32 *)buf;
+    while (size >= 8)
+    {
+        u32 lo = *words++ ^ crc;
+        u32 hi = *words++;
+        crc = crc32_slice[6][lo & 0xFF]         ^ crc32_slice[5][(lo >> 8) & 0xFF] ^
+              crc32_slice[4][(lo >> 16) & 0xFF] ^ crc32_slice[3][lo >> 24]         ^
+              crc32_slice[2][hi & 0xFF]         ^ crc32_slice[1][(hi >> 8) & 0xFF] ^
+              crc32_slice[0][(hi >> 16) & 0xFF] ^ crc32_table[hi >> 24];
+        size -= 8;
+    }
+
+    // And whatever is left over...
+    buf = (const u8 *)words;
+    while (size--)
+    {
+        crc = (crc >> 8) ^ crc32_table[(crc & 0xFF) ^ *buf++];
+    }
+
+    return crc;
+}
+
+// ------------------------------------------------------------------------------
+// Throughput micro-benchmark - CRC the 64K at the start of TapeCartDiskBuffer[]
+// with both the old and new methods and report KB/sec for each. Timer 3 at 64
+// divide is 523,656 ticks per second. Run when the debugger is enabled.
+// ------------------------------------------------------------------------------
+u32 crc32_bench_bytewise = 0;       // KB/sec of the classic table walk
+u32 crc32_bench_slice8   = 0;       // KB/sec of the slice-by-8
+u8  crc32_bench_match    = 0;       // 1 if both produced the same CRC
+
+static u32 crc32_bench_rate(u32 ticks)
 {
-    u32 crc1 = 0;
-    u32 crc2 = 1;
-    int bytesRead1 = 0;
-    int bytesRead2 = 1;
-
-    // --------------------------------------------------------------------------------------------
-    // I've seen some rare issues with reading files from the SD card on a DSi so we're doing
-    // this slow and careful - we will read twice and ensure that we get the same CRC both 
-    // times in order for us to declare that this is a valid read. When we're done, the game
-    // ROM will be placed in the TapeCartDiskBuffer[] and will be ready for use by the rest of the system.
-    // --------------------------------------------------------------------------------------------
-    do
+    return ticks ? ((64 * 523656) / ticks) : 0;
+}
+
+void crc32_benchmark(void)
+{
+    u32 crc1, crc2;
+
+    if (!crc32_slice_ready) crc32_build_slices();
+
+    TIMER3_CR = 0; TIMER3_DATA = 0;
+    TIMER3_CR = TIMER_ENABLE | TIMER_DIV_64;
+    crc1 = crc32_update_bytewise(CRC32_START, TapeCartDiskBuffer, 0x10000);
+    crc32_bench_bytewise = crc32_bench_rate(TIMER3_DATA);
+
+    TIMER3_CR = 0; TIMER3_DATA = 0;
+    TIMER3_CR = TIMER_ENABLE | TIMER_DIV_64;
+    crc2 = crc32_update(CRC32_START, TapeCartDiskBuffer, 0x10000);
+    crc32_bench_slice8 = crc32_bench_rate(TIMER3_DATA);
+
+    TIMER3_CR = 0;
+    crc32_bench_match = (crc1 == crc2);
+}
+
+
+// ------------------------------------------------------------------------------------------
+// I've seen some rare issues with reading files from the SD card on a DSi so every file is
+// verified as it's read. The file is opened once and read in large chunks straight into the
+// caller's buffer, with the CRC accumulated as each chunk comes in. We remember the running
+// CRC at the end of every chunk. Only chunks with a reason to doubt them go back to the SD
+// card: any whose bytes in memory no longer match the CRC they arrived with, plus one sample
+// chunk per load (a different one each time). Once any read has come back differently the
+// card is misbehaving and from then on every chunk is checked. A chunk that disagrees is read until two reads
+// in a row agree. So a file of more than one chunk costs one read plus a chunk, not two -
+// a file that fits in one chunk is still read twice. Only the bytes actually read are CRC'd.
+// ------------------------------------------------------------------------------------------
+u32 file_load_ms      = 0;      // How long the last file load took
+u32 file_load_bytes   = 0;      // How many bytes the last file load read
+u32 file_load_retries = 0;      // Chunks that had to be re-read (since power-on)
+
+static u32 load_chunk_crc[LOAD_MAX_CHUNKS];     // Running CRC at the end of each chunk
+static u32 load_chunk_len[LOAD_MAX_CHUNKS];
+static u8  load_scratch[LOAD_CHUNK_SIZE] __attribute__((aligned(4)));
+
+static u32 load_ticks      = 0;
+static u16 load_timer_last = 0;
+static u8  load_sample     = 0;     // Moves the sample chunk along from one load to the next
+
+// Timer 3 is free outside of the emulation - at 1024 divide it wraps every 2 seconds so we count wraps
+static void load_timer_start(void)
+{
+    TIMER3_CR = 0;
+    TIMER3_DATA = 0;
+    TIMER3_CR = TIMER_ENABLE | TIMER_DIV_1024;
+    load_ticks = 0;
+    load_timer_last = 0;
+}
+
+static void load_timer_poll(void)
+{
+    u16 now = TIMER3_DATA;
+    if (now < load_timer_last) load_ticks += 65536;
+    load_timer_last = now;
+}
+
+// ------------------------------------------------------------------------------------------
+// Read chunk 'i' from the SD card again and check it against the CRC it had the first time.
+// Reads that disagree are retried - the new read becomes the candidate and must be confirmed
+// by another - and the confirmed copy goes into the buffer. Returns how many extra reads it took.
+// ------------------------------------------------------------------------------------------
+static u32 load_verify_chunk(FILE *file, u8 *buf, u32 buf_offset, u8 i)
+{
+    u32 pos    = i * LOAD_CHUNK_SIZE;
+    u32 len    = load_chunk_len[i];
+    u32 prev   = i ? load_chunk_crc[i-1] : CRC32_START;
+    u32 expect = load_chunk_crc[i];
+    u32 extra  = 0;
+
+    for (u8 retry=0; ; retry++)
     {
-        // Read #1
-        file_size = 0;
-        crc1 = 0xFFFFFFFF;
-        FILE* file = fopen(filename, "rb");
-        while ((bytesRead1 = fread(TapeCartDiskBuffer, 1, MAX_FILE_SIZE, file)) > 0)
-        {
-            file_size += bytesRead1;
-            for (int i=0; i < bytesRead1; i++)
-            {
-                crc1 = (crc1 >> 8) ^ crc32_table[(crc1 & 0xFF) ^ (u8)TapeCartDiskBuffer[i]]; 
-            }
-        }
-        fclose(file);
+        fseek(file, buf_offset + pos, SEEK_SET);
+        u32 got   = fread(load_scratch, 1, len, file);
+        u32 check = crc32_update(prev, load_scratch, got);
+        load_timer_poll();
 
-        // Read #2
-        crc2 = 0xFFFFFFFF;
-        FILE* file2 = fopen(filename, "rb");
-        while ((bytesRead2 = fread(TapeCartDiskBuffer, 1, MAX_FILE_SIZE, file2)) > 0)
+        if ((got == len) && (check == expect))
         {
-            for (int i=0; i < bytesRead2; i++)
-            {
-                crc2 = (crc2 >> 8) ^ crc32_table[(crc2 & 0xFF) ^ (u8)TapeCartDiskBuffer[i]]; 
-            }
+            memcpy(buf + pos, load_scratch, len);
+            break;
         }
-        fclose(file2);
-   } while (crc1 != crc2);
+        if (retry >= LOAD_MAX_RETRIES) break;   // Just keep what we have...
+
+        extra++;
+        if (got == len) expect = check;
+    }
+
+    file_load_retries += extra;
+    return extra;
+}
+
+u32 ReadFileVerified(const char *filename, u8 *buf, u32 buf_size, u32 buf_offset, u32 *crc_out)
+{
+    u32 size = 0;
+    u32 crc = CRC32_START;
+    u8  chunks = 0;
+
+    load_timer_start();
+
+    FILE *file = fopen(filename, "rb");
+    if (!file)
+    {
+        if (crc_out) *crc_out = 0;
+        return 0;
+    }
+
+    // Pass 1 - read everything, accumulating the CRC as we go
+    if (buf_offset) fseek(file, buf_offset, SEEK_SET);
+    while ((size < buf_size) && (chunks < LOAD_MAX_CHUNKS))
+    {
+        u32 want = ((buf_size - size) < LOAD_CHUNK_SIZE) ? (buf_size - size) : LOAD_CHUNK_SIZE;
+        u32 got  = fread(buf + size, 1, want, file);
+        if (got == 0) break;
+
+        crc = crc32_update(crc, buf + size, got);
+        load_chunk_len[chunks] = got;
+        load_chunk_crc[chunks++] = crc;
+        size += got;
+        load_timer_poll();
+
+        if (got < want) break;
+    }
+
+    // Pass 2 - re-read the sample chunk and any chunk that changed in memory since it arrived
+    u32 doubt = 0;
+    u32 prev  = CRC32_START;
+    for (u8 i=0; i<chunks; i++)
+    {
+        if (crc32_update(prev, buf + (i * LOAD_CHUNK_SIZE), load_chunk_len[i]) != load_chunk_crc[i]) doubt |= (1u << i);
+        prev = load_chunk_crc[i];
+    }
+
+    u32 extra = 0;
+    if (chunks)
+    {
+        u8 sample = load_sample++ % chunks;
+        extra = load_verify_chunk(file, buf, buf_offset, sample);
+        if (file_load_retries) doubt = 0xFFFFFFFF;  // The card has given two different answers since power-on - check it all
+        doubt &= ~(1u << sample);
+    }
+
+    for (u8 i=0; i<chunks; i++)
+    {
+        if (doubt & (1u << i)) extra += load_verify_chunk(file, buf, buf_offset, i);
+    }
+
+    // A chunk that had to be replaced leaves the running CRC from the first pass behind
+    if (extra) crc = crc32_update(CRC32_START, buf, size);
+
+    fclose(file);
+
+    load_timer_poll();
+    file_load_bytes = size;
+    file_load_ms = ((load_ticks + load_timer_last) * 1000) / 32728;
+
+    if (crc_out) *crc_out = CRC32_FINAL(crc);
+    return size;
+}
+
+// ------------------------------------------------------------------------------------
+// Read the file in and compute CRC. When this routine finishes, the file will be read
+// into TapeCartDiskBuffer[] and file_size will be set.
+// ------------------------------------------------------------------------------------
+u32 getFileCrc(const char* filename)
+{
+    u32 crc = 0;
+
+    file_size = ReadFileVerified(filename, TapeCartDiskBuffer, MAX_FILE_SIZE, 0, &crc);
 
-    return ~crc1;
+    return crc;
 }
@@ -13,8 +13,26 @@
 #define CRC32_H
 #include <nds.h>
 
+#define LOAD_CHUNK_SIZE     (32*1024)   // Files are read and verified in chunks of this size...
+#define LOAD_MAX_CHUNKS     32          // ...which is enough for a 1MB buffer
+#define LOAD_MAX_RETRIES    8           // A chunk that never reads the same twice is kept as-is after this
+
+#define CRC32_START         0xFFFFFFFF
+#define CRC32_FINAL(crc)    (~(crc))
+
+extern u32 crc32_bench_bytewise;
+extern u32 crc32_bench_slice8;
+extern u8  crc32_bench_match;
+
+extern u32 file_load_ms;
+extern u32 file_load_bytes;
+extern u32 file_load_retries;
+
 u32 getFileCrc(const char* filename);
 u32 getCRC32(u8 *buf, u32 size);
+u32 crc32_update(u32 crc, const u8 *buf, u32 size);
+void crc32_benchmark(void);
+u32 ReadFileVerified(const char *filename, u8 *buf, u32 buf_size, u32 buf_offset, u32 *crc_out);
 
 #endif
 
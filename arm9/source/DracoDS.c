@@ -40,6 +40,19 @@
 #include "fdc.h"
 #include "vdg.h"
 #include "printf.h"
+#include "rewind.h"
+#include "runahead.h"
+#include "movie.h"
+#include "profile.h"
+#include "perf.h"
+#include "stats.h"
+#include "cpucheck.h"
+#include "trace.h"
+#include "saveload.h"
+#include "CRC32.h"
+#include "loadm.h"
+#include "paste.h"
+#include "basic.h"
 
 // -----------------------------------------------------------------
 // Most handy for development of the emulator is a set of 16 R/W
@@ -353,6 +366,13 @@ void ResetDragonTandy(void)
 
     sound_chip_reset();                   // Reset the sound generator
     dragon_reset();                       // Reset the Dragon/Tandy emulation
+    DracoBootRestore();                   // Straight to the OK prompt if we have a boot snapshot
+    RewindReset();                        // Any rewind history belongs to the old machine
+    RunAheadReset();                      // First frame is drawn the normal way
+    MovieStop();                          // A movie can't survive a reset
+    ProfileReset();                       // Profile the new machine from scratch
+    StatsReset();                         // Opcode/IO counts too (only when built with DRACO_STATS)
+    TraceStart();                         // Trace the first frames after a reset (only when built with DRACO_TRACE)
 
     // -----------------------------------------------------------
     // Timer 1 is used to time frame-to-frame of actual emulation
@@ -402,6 +422,28 @@ void ShowDebugger(void)
     DSPrint(0, idx++, 0, tmp);
     sprintf(tmp, "MPU=%s%d  OUT=%02X %02X %02X %02X  LA=%02X", sam_registers.memory_map_type ? "32K":"64K",sam_registers.mpu_rate, pia0_a_output_latch, pia0_b_output_latch, pia1_a_output_latch, pia1_b_output_latch, cpu.irq_asserted | cpu.firq_asserted | cpu.nmi_latched);
     DSPrint(0, idx++, 0, tmp);
+
+    if (draco_mode >= MODE_DSK) // Disk timing benchmark - commands issued and emulated milliseconds spent busy
+    {
+        sprintf(tmp, "FDC=%s CMD=%-6ld BUSY=%-7ldMS", (fdc_timing ? "ACC":"INS"), fdc_stat_commands, fdc_stat_busy_cycles / FDC_CYCLES_PER_MS);
+        DSPrint(0, idx++, 0, tmp);
+    }
+
+    sprintf(tmp, "LOAD=%-4ldK %-5ldMS  RETRY=%-4ld", file_load_bytes/1024, file_load_ms, file_load_retries);
+    DSPrint(0, idx++, 0, tmp);
+    if (profile_hits)
+    {
+        sprintf(tmp, "PROFILE SAMPLES=%-10ld", profile_samples);
+        DSPrint(0, idx++, 0, tmp);
+    }
+    sprintf(tmp, "RUNAHEAD SAVE=%-4ldUS LOAD=%-4ldUS", runahead_save_us, runahead_load_us);
+    DSPrint(0, idx++, 0, tmp);
+    sprintf(tmp, "REWIND SNAP=%-4ldUS DELTA=%-4ldUS", rewind_snap_us, rewind_delta_us);
+    DSPrint(0, idx++, 0, tmp);
+    sprintf(tmp, "CRC KB/S BYTE=%-5ld SLICE8=%-5ld%s", crc32_bench_bytewise, crc32_bench_slice8, (crc32_bench_match ? "":"!"));
+    DSPrint(0, idx++, 0, tmp);
+    sprintf(tmp, "CPU %2d/%-2d D%d T%-2d KIPS=%-5ld %3ld%%", cpucheck_ops_passed, cpucheck_ops_total, cpucheck_deviations, cpucheck_table_errors, cpucheck_kips, cpucheck_speed);
+    DSPrint(0, idx++, 0, tmp);
 }
 
 
@@ -527,6 +569,11 @@ void MiniMenuShow(bool bClearScreen, u8 sel)
     {
         DSPrint(8,9+mini_menu_items,(sel==mini_menu_items)?2:0,  " SWAP   DISK   ");  mini_menu_items++;
     }
+    DSPrint(8,9+mini_menu_items,(sel==mini_menu_items)?2:0,  " PASTE  TEXT   ");  mini_menu_items++;
+    DSPrint(8,9+mini_menu_items,(sel==mini_menu_items)?2:0,  " SAVE   BASIC  ");  mini_menu_items++;
+    DSPrint(8,9+mini_menu_items,(sel==mini_menu_items)?2:0,  (movie_mode == MOVIE_RECORD) ? " MOVIE  STOP   " : " MOVIE  RECORD ");  mini_menu_items++;
+    DSPrint(8,9+mini_menu_items,(sel==mini_menu_items)?2:0,  " MOVIE  PLAY   ");  mini_menu_items++;
+    DSPrint(8,9+mini_menu_items,(sel==mini_menu_items)?2:0,  " EXPORT STATS  ");  mini_menu_items++;
     DSPrint(8,9+mini_menu_items,(sel==mini_menu_items)?2:0,  " EXIT   MENU   ");  mini_menu_items++;
 }
 
@@ -567,7 +614,12 @@ u8 MiniMenu(void)
                 else if (menuSelection == 4) retVal = MENU_CHOICE_GAME_OPTION;
                 else if (menuSelection == 5) retVal = MENU_CHOICE_DEFINE_KEYS;
                 else if (menuSelection == 6) retVal = MENU_CHOICE_SWAP_DISK;
-                else if (menuSelection == 7) retVal = MENU_CHOICE_NONE;
+                else if (menuSelection == 7) retVal = MENU_CHOICE_PASTE;
+                else if (menuSelection == 8) retVal = MENU_CHOICE_BASIC_EXPORT;
+                else if (menuSelection == 9) retVal = MENU_CHOICE_MOVIE_RECORD;
+                else if (menuSelection == 10) retVal = MENU_CHOICE_MOVIE_PLAY;
+                else if (menuSelection == 11) retVal = MENU_CHOICE_EXPORT_STATS;
+                else if (menuSelection == 12) retVal = MENU_CHOICE_NONE;
                 else retVal = MENU_CHOICE_NONE;
                 break;
             }
@@ -744,6 +796,7 @@ u8 __attribute__((noinline)) handle_meta_key(u8 meta_key)
 
         case MENU_CHOICE_SWAP_DISK:
             SoundPause();
+            MovieStop();
             DracoDSLoadFile(TRUE);
             if (ucGameChoice >= 0)
             {
@@ -758,6 +811,56 @@ u8 __attribute__((noinline)) handle_meta_key(u8 meta_key)
             BottomScreenKeyboard();
             SoundUnPause();
             break;
+
+        case MENU_CHOICE_MOVIE_RECORD:
+            SoundPause();
+            if (movie_mode == MOVIE_RECORD) MovieStop(); else MovieRecord();
+            SoundUnPause();
+            break;
+
+        case MENU_CHOICE_MOVIE_PLAY:
+            SoundPause();
+            MoviePlay();
+            SoundUnPause();
+            break;
+
+        case MENU_CHOICE_EXPORT_STATS:
+            SoundPause();
+            DSPrint(12,0,0,"EXPORTING");
+            ProfileExport();    // Guest profile, subsystem timing trace and opcode/IO counts -
+            PerfExport();       // each one only writes a file if it has something to say
+            StatsExport();
+            WAITVBL;WAITVBL;WAITVBL;
+            DSPrint(12,0,0,"         ");
+            BottomScreenKeyboard();
+            SoundUnPause();
+            break;
+
+        case MENU_CHOICE_BASIC_EXPORT:
+            SoundPause();
+            BasicExport();
+            SoundUnPause();
+            break;
+
+        case MENU_CHOICE_PASTE:
+            SoundPause();
+            MovieStop();    // Pasted text goes in behind the recorded input
+            DracoDSLoadFile(FILES_TEXT);
+            if (ucGameChoice >= 0)
+            {
+                // A BASIC listing goes straight into program memory if BASIC is idle... otherwise it's typed in
+                char *ext = strrchr(gpFic[ucGameChoice].szName, '.');
+                if (ext && (strcasecmp(ext, ".bas") == 0) && BasicLoadFile(gpFic[ucGameChoice].szName))
+                {
+                    DSPrint(12,0,0,"BASIC LOADED");
+                    WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;
+                    DSPrint(12,0,0,"            ");
+                }
+                else PasteFile(gpFic[ucGameChoice].szName);
+            }
+            BottomScreenKeyboard();
+            SoundUnPause();
+            break;
     }
 
     return 0;
@@ -868,6 +971,13 @@ void DracoDS_main(void)
   // Setup the debug buffer for DSi use
   debug_init();
 
+  // With the debugger on, measure how fast we can CRC and check out the CPU core (shown in the debug overlay)
+  if (myGlobalConfig.debugger)
+  {
+      crc32_benchmark();
+      cpu_selfcheck();
+  }
+
   // Get the Emulator ready
   DragonTandyInit(gpFic[ucGameAct].szName);
 
@@ -886,6 +996,9 @@ void DracoDS_main(void)
   timingFrames  = 0;
   emuFps=0;
 
+  // Timer 3 free-runs as the time base for the performance overlay, run-ahead and movie benchmarks
+  PerfTimerStart();
+
   newStreamSampleRate();
 
   // Force the sound engine to turn on when we start emulation
@@ -935,10 +1048,18 @@ void DracoDS_main(void)
                 DSPrint(0,0,0,szChai);
             }
             DisplayStatusLine();
+            PerfShowOverlay();
             emuActFrames = 0;
         }
         emuActFrames++;
 
+        PerfFrame();        // Close out the time spent in each subsystem this frame
+        StatsFrame();       // Frame count for the per-frame opcode/IO averages
+        TraceFrame();       // Instruction trace ends (and is compared) after a set number of frames
+        RewindFrame();      // Snapshot for the rewind history (the work is spread over several frames)
+        DracoQuickFrame();  // Quick-save/load keys and lazy writing of quick-save slots to the SD card
+        DracoBootFrame();   // After a cold start, capture the machine at the OK prompt for next time
+
         // ---------------------------------------------
         // We support Tandy at 60Hz and Dragon at 50Hz
         // ---------------------------------------------
@@ -956,12 +1077,14 @@ void DracoDS_main(void)
         //
         // This is how we time frame-to frame to keep the game running at 50FPS
         // ----------------------------------------------------------------------
+        u16 perf_t = PerfStart();
         if (myConfig.machine && (myConfig.gameSpeed == 0)) // NTSC at 100% can use DS sync for a tear-free experience
         {
             while (ds_vsync == last_ds_vsync)
             {
                 if (myGlobalConfig.showFPS == 2) break; // If Full Speed, break out...
                 if (tape_motor) break;                  // If running TAPE go full speed
+                if (movie_mode == MOVIE_BENCH) break;   // Benchmarking a movie goes full speed
             }
             last_ds_vsync = ds_vsync;
         }
@@ -971,8 +1094,10 @@ void DracoDS_main(void)
             {
                 if (myGlobalConfig.showFPS == 2) break; // If Full Speed, break out...
                 if (tape_motor) break;                  // If running TAPE go full speed
+                if (movie_mode == MOVIE_BENCH) break;   // Benchmarking a movie goes full speed
             }
         }
+        PerfLap(PERF_WAIT, perf_t);
 
 
         // If the Z80 Debugger is enabled, call it
@@ -981,6 +1106,7 @@ void DracoDS_main(void)
             ShowDebugger();
         }
 
+        perf_t = PerfStart();
         uint16_t keys_current = keysCurrent();
 
         // ------------------------------------------------------------------------------------
@@ -995,8 +1121,13 @@ void DracoDS_main(void)
             }
             else if (draco_mode == MODE_CAS)
             {
-                // START key is also special...
-                if (keys_current & KEY_START)
+                // START key is also special... if we can, load a machine code program directly
+                if ((keys_current & KEY_START) && (myConfig.loadType == 1) && !myConfig.loadmTyped && LoadmFromTape())
+                {
+                    bFirstTime = 0;
+                    bFirstTimeSelect = 0;   // Already running - nothing left for SELECT to do
+                }
+                else if (keys_current & KEY_START)
                 {
                     bFirstTime = 0;
                     BufferKey(7);     // C
@@ -1035,7 +1166,11 @@ void DracoDS_main(void)
                     bFirstTime = 0;
                     char *fn = disk_get_filename();
 
-                    if (!fn) // No files found... maybe DOS disk...
+                    if (!myConfig.loadmTyped && LoadmFromDisk(check_filename_for_file()))
+                    {
+                        bFirstTimeSelect = 0;   // Loaded and running - nothing left for SELECT to EXEC
+                    }
+                    else if (!fn) // No files found... maybe DOS disk...
                     {
                         BufferKey(8);     // D
                         BufferKey(19);    // O
@@ -1175,7 +1310,11 @@ void DracoDS_main(void)
       // Hold the key press for a brief instant... To allow the
       // emulated CPU to 'see' the key briefly... Good enough.
       // --------------------------------------------------------------
-      if (BufferedKeysReadIdx == BufferedKeysWriteIdx)
+      if (paste_active)
+      {
+          PasteFrame(keys_current);   // The paste engine has the keyboard until it's done
+      }
+      else if (BufferedKeysReadIdx == BufferedKeysWriteIdx)
       {
           if (key_debounce > 0) key_debounce--;
           else
@@ -1269,6 +1408,10 @@ void DracoDS_main(void)
                     WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;
                     DSPrint(12,0,0,"        ");
               }
+              else if ((nds_key & KEY_L) && (nds_key & KEY_R) && (nds_key & KEY_A))
+              {
+                    RewindStep();   // Hold to keep stepping back through the rewind history
+              }
               else if  (nds_key & (KEY_UP | KEY_DOWN | KEY_LEFT | KEY_RIGHT | KEY_A | KEY_B | KEY_START | KEY_SELECT | KEY_R | KEY_L | KEY_X | KEY_Y))
               {
                   if (myConfig.dpad == DPAD_SLIDE_N_GLIDE) // CHUCKIE-EGG Style... hold left/right or up/down for a few frames
@@ -1377,6 +1520,15 @@ void DracoDS_main(void)
                                   case 70:
                                     BufferKey(16); BufferKey(19); BufferKey(48); BufferKey(255); // LOOK
                                     break;
+                                  case 71:
+                                    DracoQuickKey(QUICK_KEY_SAVE);
+                                    break;
+                                  case 72:
+                                    DracoQuickKey(QUICK_KEY_LOAD);
+                                    break;
+                                  case 73:
+                                    DracoQuickKey(QUICK_KEY_SLOT);
+                                    break;
                               }
                           }
                           else // This is a keyboard maping... handle that here... just set the appopriate kbd_key
@@ -1542,6 +1694,11 @@ void DracoDS_main(void)
       {
          if ((++autoFireTimer & 0xf) > 8)  JoyState &= ~JST_FIRE;
       }
+
+      PerfLap(PERF_INPUT, perf_t);
+
+      RunAheadFrame();  // With the new input in place, peek a frame or two into the future
+      MovieFrame();     // Record the input for this frame... or replace it with the recorded input
     }
   }
 }
@@ -1748,6 +1905,13 @@ void LoadBIOSFiles(void)
     if (!size) size = ReadFileCarefully("/roms/bios/disk11.rom",      DiskROM, 0x2000, 0);
     if (!size) size = ReadFileCarefully("/data/bios/disk11.rom",      DiskROM, 0x2000, 0);
     if (size) bDISKBIOS_found = true;
+
+    // Identifies this set of ROMs - boot snapshots are only good for the ROMs they were taken with
+    u32 crc = CRC32_START;
+    crc = crc32_update(crc, DragonBASIC, sizeof(DragonBASIC));
+    crc = crc32_update(crc, CoCoBASIC,   sizeof(CoCoBASIC));
+    crc = crc32_update(crc, DiskROM,     sizeof(DiskROM));
+    myGlobalConfig.bios_checksums = CRC32_FINAL(crc);
 }
 
 /************************************************************************************
@@ -27,6 +27,11 @@ extern u32 DX, DY;
 #define MENU_CHOICE_SWAP_DISK   0x05
 #define MENU_CHOICE_DEFINE_KEYS 0x06
 #define MENU_CHOICE_GAME_OPTION 0x07
+#define MENU_CHOICE_PASTE       0x08
+#define MENU_CHOICE_BASIC_EXPORT 0x09
+#define MENU_CHOICE_MOVIE_RECORD 0x0A
+#define MENU_CHOICE_MOVIE_PLAY   0x0B
+#define MENU_CHOICE_EXPORT_STATS 0x0C
 #define MENU_CHOICE_MENU        0xFF        // Special brings up a mini-menu of choices
 
 // ------------------------------------------------------------------------------
@@ -41,7 +46,7 @@ extern u32 DX, DY;
 #define JST_FIRE            0x0010
 #define JST_FIRE2           0x0020
 
-#define MAX_KEY_OPTIONS     71
+#define MAX_KEY_OPTIONS     74
 
 // What format is the input file?
 #define MODE_CART           1
@@ -27,7 +27,10 @@
 #include "printf.h"
 
 #include "CRC32.h"
+#include "fdc.h"
 #include "printf.h"
+#include "saveload.h"
+#include "dircache.h"
 
 short int   fileCount=0;
 short int   ucGameAct=0;
@@ -129,7 +132,10 @@ const char szKeyName[MAX_KEY_OPTIONS][16] = {
   "PULL LEFT ...",
   "PULL RIGHT ...",
   "EXAMINE",
-  "LOOK"            // 70
+  "LOOK",           // 70
+  "QUICK SAVE",
+  "QUICK LOAD",
+  "QUICK SLOT +"    // 73
 };
 
 // -------------------------------------------------------------------------------------------------------------------------
@@ -383,6 +389,8 @@ void dsDisplayFiles(u16 NoDebGame, u8 ucSel)
         DSPrint(1,6+ucBcl,(ucSel == ucBcl ? 2 : 0 ),"                              ");
     }
   }
+  DirCachePage(NoDebGame, 17);          // Read the cached info for this page if we haven't yet
+  DirCacheShowInfo(NoDebGame+ucSel);   // Anything we know about the highlighted game
 }
 
 
@@ -417,6 +425,7 @@ void DracoDSFindFiles(u8 bDiskOnly)
 
   uNbFile=0;
   fileCount=0;
+  u32 signature = CRC32_START;   // CRC of the sorted listing - if it matches the directory cache only its header is read
 
   dir = opendir(".");
   while (((pent=readdir(dir))!=NULL) && (uNbFile<MAX_FILES))
@@ -427,8 +436,8 @@ void DracoDSFindFiles(u8 bDiskOnly)
     {
       if (!((szFile[0] == '.') && (strlen(szFile) == 1)))
       {
-        // Do not include the [sav] and [pok] directories
-        if ((strcasecmp(szFile, "sav") != 0) && (strcasecmp(szFile, "pok") != 0))
+        // Do not include the [sav] and [pok] directories (exported BASIC listings are in [sav] though)
+        if (((strcasecmp(szFile, "sav") != 0) || (bDiskOnly == FILES_TEXT)) && (strcasecmp(szFile, "pok") != 0))
         {
             strcpy(gpFic[uNbFile].szName,szFile);
             gpFic[uNbFile].uType = DIRECTORY;
@@ -440,6 +449,16 @@ void DracoDSFindFiles(u8 bDiskOnly)
     else {
       if ((strlen(szFile)>4) && (strlen(szFile)<(MAX_FILENAME_LEN-4)) && (szFile[0] != '.') && (szFile[0] != '_'))  // For MAC don't allow files starting with an underscore
       {
+        if (bDiskOnly == FILES_TEXT)
+        {
+            if ( (strcasecmp(strrchr(szFile, '.'), ".txt") == 0) || (strcasecmp(strrchr(szFile, '.'), ".bas") == 0) )  {
+              strcpy(gpFic[uNbFile].szName,szFile);
+              gpFic[uNbFile].uType = DRACO_FILE;
+              uNbFile++;
+              fileCount++;
+            }
+            continue;
+        }
         if ( (strcasecmp(strrchr(szFile, '.'), ".ccc") == 0) )  {
           strcpy(gpFic[uNbFile].szName,szFile);
           gpFic[uNbFile].uType = DRACO_FILE;
@@ -473,13 +492,21 @@ void DracoDSFindFiles(u8 bDiskOnly)
   }
   closedir(dir);
 
-  // ----------------------------------------------
-  // If we found any files, go sort the list...
-  // ----------------------------------------------
-  if (fileCount)
+  // -----------------------------------------------------------------------
+  // If we found any files, go sort the list... the directory cache is keyed
+  // on the sorted listing so the order readdir() returns doesn't matter.
+  // -----------------------------------------------------------------------
+  qsort (gpFic, fileCount, sizeof(FIDraco), Filescmp);
+
+  for (u16 i=0; i<fileCount; i++)
   {
-    qsort (gpFic, fileCount, sizeof(FIDraco), Filescmp);
+    signature = crc32_update(signature, (u8 *)gpFic[i].szName, strlen(gpFic[i].szName));
+    signature = crc32_update(signature, &gpFic[i].uType, 1);
   }
+  signature = CRC32_FINAL(signature);
+
+  if ((bDiskOnly == FILES_TEXT) || !fileCount) DirCacheClear();    // Text files aren't games - leave the directory cache alone
+  else DirCacheOpen(signature);
 }
 
 // ----------------------------------------------------------------
@@ -651,7 +678,7 @@ u8 DracoDSLoadFile(u8 bDiskOnly)
       {
           u8 isDisk = strcasecmp(strrchr(gpFic[ucGameAct].szName, '.'), ".dsk");
           u8 isCass = strcasecmp(strrchr(gpFic[ucGameAct].szName, '.'), ".cas");
-          if (!bDiskOnly || (isDisk == 0) || (isCass == 0))
+          if (!bDiskOnly || (bDiskOnly == FILES_TEXT) || (isDisk == 0) || (isCass == 0))
           {
               bDone=true;
               ucGameChoice = ucGameAct;
@@ -714,14 +741,67 @@ u8 DracoDSLoadFile(u8 bDiskOnly)
 }
 
 
+// ---------------------------------------------------------------------------
+// The game configurations are an open-addressed hash table keyed on the game
+// CRC (linear probing). The table in memory is exactly what is on disk so a
+// lookup is a probe or two and saving one game touches only its own record.
+// ---------------------------------------------------------------------------
+static inline u16 ConfigHomeSlot(u32 crc)
+{
+    return (u16)(crc % MAX_CONFIGS);
+}
+
+// Find the slot holding this CRC or the first empty slot where it would go. Returns -1 if the table is full.
+static s16 ConfigProbe(u32 crc)
+{
+    u16 slot = ConfigHomeSlot(crc);
+
+    for (u16 i=0; i<MAX_CONFIGS; i++)
+    {
+        if ((AllConfigs[slot].game_crc == crc) || (AllConfigs[slot].game_crc == 0x00000000)) return slot;
+        if (++slot == MAX_CONFIGS) slot = 0;
+    }
+    return -1;
+}
+
+// ---------------------------------------------------------------------------
+// Write the global config and either just one game record or (slot < 0)
+// the entire table of game configurations.
+// ---------------------------------------------------------------------------
+static u8 WriteConfigFile(s16 slot)
+{
+    FILE *fp = NULL;
+
+    if (slot >= 0) fp = fopen("/data/DracoDS.DAT", "rb+");
+    if (fp != NULL)
+    {
+        fwrite(&myGlobalConfig, sizeof(myGlobalConfig), 1, fp);        // Write the global config
+        fseek(fp, sizeof(myGlobalConfig) + (slot * sizeof(struct Config_t)), SEEK_SET);
+        fwrite(&AllConfigs[slot], sizeof(struct Config_t), 1, fp);    // And just the one game record
+        fclose(fp);
+        return 1;
+    }
+
+    // No file yet (or we were asked for all of it) - write the whole thing
+    fp = fopen("/data/DracoDS.DAT", "wb+");
+    if (fp != NULL)
+    {
+        fwrite(&myGlobalConfig, sizeof(myGlobalConfig), 1, fp); // Write the global config
+        fwrite(&AllConfigs, sizeof(AllConfigs), 1, fp);         // Write the array of all configurations
+        fclose(fp);
+        return 1;
+    }
+    return 0;
+}
+
 // ---------------------------------------------------------------------------
 // Write out the DracoDS.DAT configuration file to capture the settings for
 // each game.  This one file contains global settings ~1000 game settings.
+// Only the global settings and the current game's record are written.
 // ---------------------------------------------------------------------------
 void SaveConfig(bool bShow)
 {
-    FILE *fp;
-    int slot = 0;
+    s16 slot = -1;
 
     if (bShow) DSPrint(1,23,0, (char*)"     SAVING CONFIGURATION     ");
 
@@ -731,24 +811,14 @@ void SaveConfig(bool bShow)
     // If there is a game loaded, save that into a slot... re-use the same slot if it exists
     myConfig.game_crc = file_crc;
 
-    // Find the slot we should save into...
-    for (slot=0; slot<MAX_CONFIGS; slot++)
-    {
-        if (AllConfigs[slot].game_crc == myConfig.game_crc)  // Got a match?!
-        {
-            break;
-        }
-        if (AllConfigs[slot].game_crc == 0x00000000)  // Didn't find it... use a blank slot...
-        {
-            break;
-        }
-    }
-
     // --------------------------------------------------------------------------
     // Copy our current game configuration to the main configuration database...
+    // If the table is somehow full, the game takes over its home slot.
     // --------------------------------------------------------------------------
     if (myConfig.game_crc != 0x00000000)
     {
+        slot = ConfigProbe(myConfig.game_crc);
+        if (slot < 0) slot = ConfigHomeSlot(myConfig.game_crc);
         memcpy(&AllConfigs[slot], &myConfig, sizeof(struct Config_t));
     }
 
@@ -767,15 +837,12 @@ void SaveConfig(bool bShow)
     {
         mkdir("/data", 0777);   // Doesn't exist - make it...
     }
-    fp = fopen("/data/DracoDS.DAT", "wb+");
-    if (fp != NULL)
+
+    // With no game loaded there's no record to write - a slot of 0 just rewrites an unchanged record
+    if (!WriteConfigFile((slot < 0) ? 0 : slot))
     {
-        fwrite(&myGlobalConfig, sizeof(myGlobalConfig), 1, fp); // Write the global config
-        fwrite(&AllConfigs, sizeof(AllConfigs), 1, fp);         // Write the array of all configurations
-        fclose(fp);
+        DSPrint(1,23,0, (char*)"   ERROR SAVING CONFIG FILE!   ");
     }
-    else
-    DSPrint(1,23,0, (char*)"   ERROR SAVING CONFIG FILE!   ");
 
     if (bShow)
     {
@@ -785,15 +852,6 @@ void SaveConfig(bool bShow)
 }
 
 
-// Return values for file type detection
-typedef enum {
-    TAPE_ERROR_NO_HEADER = -1,
-    TAPE_ERROR_BAD_CHECKSUM = -2,
-    TAPE_TYPE_BASIC = 0,      // Requires CLOAD
-    TAPE_TYPE_DATA = 1,
-    TAPE_TYPE_MACHINE = 2     // Requires CLOADM
-} CoCoTapeType;
-
 /**
  * Detects the type of a CoCo/Dragon 32 tape file from a .CAS memory buffer.
  * @param buffer Pointer to the raw .CAS data array.
@@ -917,6 +975,13 @@ void SetDefaultGlobalConfig(void)
     myGlobalConfig.debugger       = 0;    // Debugger is not shown by default
     myGlobalConfig.defMachine     = 1;    // Set to Tandy by default (0=Dragon)
     myGlobalConfig.defDiskSave    = 1;    // Default is to auto-save disk files
+    myGlobalConfig.rewind         = 0;    // Rewind history costs a snapshot every 10 frames plus delta work each frame (L+R+A to rewind)
+    myGlobalConfig.quickPersist   = 0;    // Quick-save slots are only kept in RAM by default
+    myGlobalConfig.bootSnap       = 1;    // Skip the BASIC cold start using a snapshot of the OK prompt
+    myGlobalConfig.runAhead       = 0;    // Run-ahead costs an extra frame (or two) of emulation per frame shown
+    myGlobalConfig.movieBench     = 0;    // Movies play back at normal speed with video and sound
+    myGlobalConfig.profiler       = 0;    // The guest profiler needs 256K for its histogram
+    myGlobalConfig.perfOverlay    = 0;    // Per-subsystem timing overlay on the bottom screen
 }
 
 void SetDefaultGameConfig(void)
@@ -940,8 +1005,8 @@ void SetDefaultGameConfig(void)
     myConfig.sensitivityX   = 0;                           // Normal Analog X Sensitivity
     myConfig.sensitivityY   = 0;                           // Normal Analog Y Sensitivity
     myConfig.clickFilter    = 1;                           // Sound click filter (for games like Androne but not for Demon Attack)
-    myConfig.reserved1      = 0;
-    myConfig.reserved2      = 0;
+    myConfig.diskTiming     = FDC_TIMING_INSTANT;
+    myConfig.loadmTyped     = 0;                           // Machine code programs are loaded directly (not typed)
 
     // We only support TANDY in disk mode
     if ((draco_mode == MODE_DSK) || (draco_mode == MODE_CART))
@@ -1078,11 +1143,48 @@ void LoadConfig(void)
     {
         ReadFileCarefully("/data/DracoDS.DAT", (u8*)&AllConfigs, sizeof(AllConfigs), sizeof(myGlobalConfig)); // Read the full game array of configs
 
+        if (myGlobalConfig.config_ver == CONFIG_VERSION_LINEAR)
+        {
+            // ---------------------------------------------------------------
+            // Older versions stored the games one after the other. Re-hash
+            // them into the table and write out the whole file once.
+            // ---------------------------------------------------------------
+            struct Config_t *pOld = (struct Config_t *)malloc(sizeof(AllConfigs));
+            if (pOld)
+            {
+                memcpy(pOld, AllConfigs, sizeof(AllConfigs));
+                memset(&AllConfigs, 0x00, sizeof(AllConfigs));
+                for (u16 i=0; i<MAX_CONFIGS; i++)
+                {
+                    if (pOld[i].game_crc == 0x00000000) break;
+                    s16 slot = ConfigProbe(pOld[i].game_crc);
+                    if (slot >= 0) memcpy(&AllConfigs[slot], &pOld[i], sizeof(struct Config_t));
+                }
+                free(pOld);
+
+                // The newer global options sit in what were spare bytes - give them their defaults
+                struct GlobalConfig_t oldGlobal = myGlobalConfig;
+                SetDefaultGlobalConfig();
+                myGlobalConfig.bios_checksums = oldGlobal.bios_checksums;
+                memcpy(myGlobalConfig.szLastFile, oldGlobal.szLastFile, sizeof(myGlobalConfig.szLastFile));
+                memcpy(myGlobalConfig.szLastPath, oldGlobal.szLastPath, sizeof(myGlobalConfig.szLastPath));
+                myGlobalConfig.showFPS     = oldGlobal.showFPS;
+                myGlobalConfig.lastDir     = oldGlobal.lastDir;
+                myGlobalConfig.defMachine  = oldGlobal.defMachine;
+                myGlobalConfig.defDiskSave = oldGlobal.defDiskSave;
+                myGlobalConfig.debugger    = oldGlobal.debugger;
+
+                myGlobalConfig.config_ver = CONFIG_VERSION;
+                WriteConfigFile(-1);
+            }
+        }
+
         if (myGlobalConfig.config_ver != CONFIG_VERSION)
         {
             memset(&AllConfigs, 0x00, sizeof(AllConfigs));
             SetDefaultGameConfig();
             SetDefaultGlobalConfig();
+            remove("/data/DracoDS.DAT");    // So the save below writes the whole file fresh
             SaveConfig(FALSE);
         }
     }
@@ -1095,6 +1197,18 @@ void LoadConfig(void)
     }
 }
 
+// -------------------------------------------------------------------------
+// Find the configuration slot for a game CRC. Returns -1 if there isn't one.
+// -------------------------------------------------------------------------
+s16 FindConfigSlot(u32 crc)
+{
+    if (crc == 0x00000000) return -1;
+
+    s16 slot = ConfigProbe(crc);
+    if ((slot >= 0) && (AllConfigs[slot].game_crc == crc)) return slot;
+    return -1;
+}
+
 // -------------------------------------------------------------------------
 // Try to match our loaded game to a configuration my matching CRCs
 // -------------------------------------------------------------------------
@@ -1107,13 +1221,10 @@ void FindConfig(void)
     // -----------------------------------------------------------------
     SetDefaultGameConfig();
 
-    for (u16 slot=0; slot<MAX_CONFIGS; slot++)
+    s16 slot = FindConfigSlot(file_crc);
+    if (slot >= 0)  // Got a match?!
     {
-        if (AllConfigs[slot].game_crc == file_crc)  // Got a match?!
-        {
-            memcpy(&myConfig, &AllConfigs[slot], sizeof(struct Config_t));
-            break;
-        }
+        memcpy(&myConfig, &AllConfigs[slot], sizeof(struct Config_t));
     }
 
     clear_firq_immediate = 0;
@@ -1145,9 +1256,11 @@ const struct options_t Option_Table[2][20] =
     {
         {"MACHINE TYPE",   {"DRAGON 32", "TANDY COCO"},                                &myConfig.machine,           2},
         {"CASS LOAD",      {"MANUAL", "CLOADM [EXEC]", "CLOAD [RUN]"},                 &myConfig.loadType,          3},
+        {"LOADM",          {"DIRECT", "TYPED"},                                        &myConfig.loadmTyped,        2},
         {"AUTO FIRE",      {"OFF", "ON"},                                              &myConfig.autoFire,          2},
         {"GAME SPEED",     {"100%", "110%", "120%", "130%", "90%", "80%"},             &myConfig.gameSpeed,         6},
         {"DISK WRITE",     {"OFF", "ON"},                                              &myConfig.diskSave,          2},
+        {"DISK TIMING",    {"INSTANT", "ACCURATE"},                                    &myConfig.diskTiming,        2},
         {"FORCE CSS",      {"NORMAL", "COLOR SET 0", "COLOR SET 1"},                   &myConfig.forceCSS,          3},
         {"ARTIFACTS",      {"BLUE/ORANGE", "ORANGE/BLUE", "OFF (BW)"},                 &myConfig.artifacts,         3},
         {"NDS D-PAD",      {"NORMAL", "SLIDE-N-GLIDE", "DIAGONALS"},                   &myConfig.dpad,              3},
@@ -1168,6 +1281,13 @@ const struct options_t Option_Table[2][20] =
         {"DISK WRITE",     {"OFF", "ON"},                                              &myGlobalConfig.defDiskSave, 2},
         {"START DIR",      {"/ROMS/DRAGON",  "/ROMS/COCO", "LAST USED DIR"},           &myGlobalConfig.lastDir,     3},
         {"FPS",            {"OFF", "ON", "ON FULLSPEED"},                              &myGlobalConfig.showFPS,     3},
+        {"REWIND",         {"OFF", "ON"},                                              &myGlobalConfig.rewind,      2},
+        {"QUICK SAVE SD",  {"OFF", "ON"},                                              &myGlobalConfig.quickPersist,2},
+        {"FAST BOOT",      {"OFF", "ON"},                                              &myGlobalConfig.bootSnap,    2},
+        {"RUN AHEAD",      {"OFF", "1 FRAME", "2 FRAMES"},                             &myGlobalConfig.runAhead,    3},
+        {"MOVIE PLAYBACK", {"NORMAL", "BENCHMARK"},                                    &myGlobalConfig.movieBench,  2},
+        {"PROFILER",       {"OFF", "ON"},                                              &myGlobalConfig.profiler,    2},
+        {"PERF OVERLAY",   {"OFF", "ON"},                                              &myGlobalConfig.perfOverlay, 2},
         {"DEBUGGER",       {"OFF", "ON"},                                              &myGlobalConfig.debugger,    2},
         {NULL,             {"",      ""},                                              NULL,                        1},
     }
@@ -1582,51 +1702,40 @@ void ReadFileCRCAndConfig(void)
 
     // Grab the all-important file CRC - this also loads the file into TapeCartDiskBuffer[]
     getfile_crc(gpFic[ucGameChoice].szName);
+    DirCacheUpdate(ucGameChoice, file_crc);
 
     FindConfig();    // Try to find keymap and config for this file...
 }
 
 
 // ----------------------------------------------------------------------
-// Read file twice and ensure we get the same CRC... if not, do it again
-// until we get a clean read. Return the filesize to the caller...
+// Read a file (or part of one) into the buffer given, verifying the read
+// as we go - see ReadFileVerified(). Return the filesize to the caller...
 // ----------------------------------------------------------------------
 u32 ReadFileCarefully(char *filename, u8 *buf, u32 buf_size, u32 buf_offset)
 {
-    u32 crc1 = 0;
-    u32 crc2 = 1;
-    u32 fileSize = 0;
-
-    // --------------------------------------------------------------------------------------------
-    // I've seen some rare issues with reading files from the SD card on a DSi so we're doing
-    // this slow and careful - we will read twice and ensure that we get the same CRC both times.
-    // --------------------------------------------------------------------------------------------
-    do
-    {
-        // Read #1
-        crc1 = 0xFFFFFFFF;
-        FILE* file = fopen(filename, "rb");
-        if (file)
-        {
-            if (buf_offset) fseek(file, buf_offset, SEEK_SET);
-            fileSize = fread(buf, 1, buf_size, file);
-            crc1 = getCRC32(buf, buf_size);
-            fclose(file);
-        }
+    return ReadFileVerified(filename, buf, buf_size, buf_offset, NULL);
+}
 
-        // Read #2
-        crc2 = 0xFFFFFFFF;
-        FILE* file2 = fopen(filename, "rb");
-        if (file2)
-        {
-            if (buf_offset) fseek(file2, buf_offset, SEEK_SET);
-            fread(buf, 1, buf_size, file2);
-            crc2 = getCRC32(buf, buf_size);
-            fclose(file2);
-        }
-   } while (crc1 != crc2); // If the file couldn't be read, file_size will be 0 and the CRCs will both be 0xFFFFFFFF
+// ----------------------------------------------------------------------
+// Everything we write for a game goes in sav/<game>.<ext> - the save
+// states, quick slots, movies, traces, profiles and exports. The game's
+// own three letter extension is swapped for 'ext'. We go back to the
+// starting directory (and make sav if need be) so 'fn' opens as-is.
+// ----------------------------------------------------------------------
+void DracoSavFilename(char *fn, const char *ext)
+{
+    chdir(initial_path);
 
-   return fileSize;
+    DIR* dir = opendir("sav");
+    if (dir) closedir(dir);    // Directory exists... close it out and move on.
+    else mkdir("sav", 0777);   // Otherwise create the directory...
+    sprintf(fn,"sav/%s", initial_file);
+
+    int len = strlen(fn);
+    fn[len-3] = ext[0];
+    fn[len-2] = ext[1];
+    fn[len-1] = ext[2];
 }
 
 // --------------------------------------------------------------------
@@ -1936,6 +2045,8 @@ u8 DragonTandyInit(char *szGame)
 
   RetFct = loadgame(szGame);      // Load up the .ccc or .cas game
 
+  DracoQuickReset();              // Quick-save slots belong to the previous game
+
   ResetDragonTandy();
 
   // Return with result
@@ -1947,7 +2058,7 @@ u8 DragonTandyInit(char *szGame)
  ********************************************************************************/
 void DragonTandyRun(void)
 {
-  dragon_reset();                         // Ensure the Dragon/Tandy Emulation is ready
+  // DragonTandyInit() has just reset the machine (and restored any boot snapshot) in ResetDragonTandy()
   BottomScreenKeyboard();                 // Show the game-related screen with keypad / keyboard
 }
 
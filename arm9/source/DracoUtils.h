@@ -21,11 +21,14 @@
 #define MAX_FILE_SIZE               (256*1024) // 256K is big enough for any .CAS or .CCC file or standard (160K / 180K) .DSK file
 
 #define MAX_CONFIGS                 970
-#define CONFIG_VERSION              0x0007
+#define CONFIG_VERSION              0x0008
+#define CONFIG_VERSION_LINEAR       0x0007  // Games stored one after another - re-hashed into the table on load
 
 #define DRACO_FILE                  0x01
 #define DIRECTORY                   0x02
 
+#define FILES_TEXT                  0x02    // For DracoDSLoadFile() - list .txt and .bas text files rather than games
+
 #define ID_SHM_CANCEL               0x00
 #define ID_SHM_YES                  0x01
 #define ID_SHM_NO                   0x02
@@ -54,6 +57,15 @@ extern u32 tape_pos;
 extern u16 tape_motor;
 extern u8  bDISKBIOS_found;
 
+// Return values for file type detection
+typedef enum {
+    TAPE_ERROR_NO_HEADER = -1,
+    TAPE_ERROR_BAD_CHECKSUM = -2,
+    TAPE_TYPE_BASIC = 0,      // Requires CLOAD
+    TAPE_TYPE_DATA = 1,
+    TAPE_TYPE_MACHINE = 2     // Requires CLOADM
+} CoCoTapeType;
+
 typedef struct {
   char szName[MAX_FILENAME_LEN+1];
   u8 uType;
@@ -74,13 +86,13 @@ struct __attribute__((__packed__)) GlobalConfig_t
     u8  lastDir;
     u8  defMachine;
     u8  defDiskSave;
-    u8  global_03;
-    u8  global_04;
-    u8  global_05;
-    u8  global_06;
-    u8  global_07;
-    u8  global_08;
-    u8  global_09;
+    u8  rewind;
+    u8  quickPersist;
+    u8  bootSnap;
+    u8  runAhead;
+    u8  movieBench;
+    u8  profiler;
+    u8  perfOverlay;
     u8  global_10;
     u8  global_11;
     u8  global_12;
@@ -107,8 +119,8 @@ struct __attribute__((__packed__)) Config_t
     u8  sensitivityX;
     u8  sensitivityY;
     u8  clickFilter;
-    u8  reserved1;
-    u8  reserved2;
+    u8  diskTiming;
+    u8  loadmTyped;
 };
 
 extern struct Config_t       myConfig;
@@ -129,6 +141,7 @@ extern u8 BufferedKeysReadIdx;
 extern u8 TapeCartDiskBuffer[MAX_FILE_SIZE];
 
 extern FIDraco gpFic[MAX_FILES];
+extern short int fileCount;
 extern short int ucGameAct;
 extern short int ucGameChoice;
 
@@ -143,6 +156,7 @@ extern void FadeToColor(unsigned char ucSens, unsigned short ucBG, unsigned char
 extern u8   DracoDSLoadFile(u8 bDiskOnly);
 extern void DisplayFileName(void);
 extern u32  ReadFileCarefully(char *filename, u8 *buf, u32 buf_size, u32 buf_offset);
+extern void DracoSavFilename(char *fn, const char *ext);
 extern u8   loadgame(const char *path);
 extern u8   DragonTandyInit(char *szGame);
 extern void DragonTandySetPalette(void);
@@ -150,6 +164,8 @@ extern void DragonTandyRun(void);
 extern void dragon_reset(void);
 extern u32  dragon_run(void);
 extern void getfile_crc(const char *path);
+extern s16  FindConfigSlot(u32 crc);
+extern int  detect_cas_file_type(const uint8_t *buffer, size_t size);
 extern void DracoLoadState();
 extern void DracoSaveState();
 extern void intro_logo(void);
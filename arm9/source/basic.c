@@ -0,0 +1,365 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#include <nds.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "DracoDS.h"
+#include "DracoUtils.h"
+#include "cpu.h"
+#include "mem.h"
+#include "saveload.h"
+#include "printf.h"
+
+#include "basic.h"
+
+// ---------------------------------------------------------------------------------------
+// Keyword tables - the index into each table plus $80 is the token. Both machines run
+// the same Microsoft BASIC but Dragon BASIC merged the Extended keywords into the middle
+// of the list so the tokens differ. Disk BASIC keywords only exist with the Disk ROM in.
+// ---------------------------------------------------------------------------------------
+static const char *coco_commands[] =
+{
+    "FOR", "GO", "REM", "'", "ELSE", "IF", "DATA", "PRINT", "ON", "INPUT", "END", "NEXT", "DIM", "READ", "RUN", "RESTORE",
+    "RETURN", "STOP", "POKE", "CONT", "LIST", "CLEAR", "NEW", "CLOAD", "CSAVE", "OPEN", "CLOSE", "LLIST", "SET", "RESET", "CLS", "MOTOR",
+    "SOUND", "AUDIO", "EXEC", "SKIPF", "TAB(", "TO", "SUB", "THEN", "NOT", "STEP", "OFF", "+", "-", "*", "/", "^",
+    "AND", "OR", ">", "=", "<",
+    // Extended Color BASIC ($B5)
+    "DEL", "EDIT", "TRON", "TROFF", "DEF", "LET", "LINE", "PCLS", "PSET", "PRESET", "SCREEN",
+    "PCLEAR", "COLOR", "CIRCLE", "PAINT", "GET", "PUT", "DRAW", "PCOPY", "PMODE", "PLAY", "DLOAD", "RENUM", "FN", "USING",
+    // Disk Extended Color BASIC ($CE)
+    "DIR", "DRIVE", "FIELD", "FILES", "KILL", "LOAD", "LSET", "MERGE", "RENAME", "RSET", "SAVE", "WRITE", "VERIFY", "UNLOAD", "DSKINI", "BACKUP",
+    "COPY", "DSKI$", "DSKO$", "DOS",
+};
+#define COCO_COMMANDS_EXT   0x4E    // Count without the Disk BASIC keywords
+
+static const char *coco_functions[] =
+{
+    "SGN", "INT", "ABS", "USR", "RND", "SIN", "PEEK", "LEN", "STR$", "VAL", "ASC", "CHR$", "EOF", "JOYSTK", "LEFT$", "RIGHT$",
+    "MID$", "POINT", "INKEY$", "MEM",
+    // Extended Color BASIC ($94)
+    "ATN", "COS", "TAN", "EXP", "FIX", "LOG", "POS", "SQR", "HEX$", "VARPTR", "INSTR", "TIMER",
+    "PPOINT", "STRING$",
+    // Disk Extended Color BASIC ($A2)
+    "CVN", "FREE", "LOC", "LOF", "MKN$", "AS",
+};
+#define COCO_FUNCTIONS_EXT  0x22
+
+static const char *dragon_commands[] =
+{
+    "FOR", "GO", "REM", "'", "ELSE", "IF", "DATA", "PRINT", "ON", "INPUT", "END", "NEXT", "DIM", "READ", "LET", "RUN",
+    "RESTORE", "RETURN", "STOP", "POKE", "CONT", "LIST", "CLEAR", "NEW", "DEF", "CLOAD", "CSAVE", "OPEN", "CLOSE", "LLIST", "SET", "RESET",
+    "CLS", "MOTOR", "SOUND", "AUDIO", "EXEC", "SKIPF", "DEL", "EDIT", "TRON", "TROFF", "LINE", "PCLS", "PSET", "PRESET", "SCREEN", "PCLEAR",
+    "COLOR", "CIRCLE", "PAINT", "GET", "PUT", "DRAW", "PCOPY", "PMODE", "PLAY", "DLOAD", "RENUM", "TAB(", "TO", "SUB", "FN", "THEN",
+    "NOT", "STEP", "OFF", "+", "-", "*", "/", "^", "AND", "OR", ">", "=", "<", "USING",
+};
+
+static const char *dragon_functions[] =
+{
+    "SGN", "INT", "ABS", "POS", "RND", "SQR", "LOG", "EXP", "SIN", "COS", "TAN", "ATN", "PEEK", "LEN", "STR$", "VAL",
+    "ASC", "CHR$", "EOF", "JOYSTK", "FIX", "HEX$", "LEFT$", "RIGHT$", "MID$", "POINT", "INKEY$", "MEM", "VARPTR", "INSTR", "TIMER", "PPOINT",
+    "STRING$", "USR",
+};
+
+#define TABLE_SIZE(t)   (sizeof(t) / sizeof(t[0]))
+
+static const char **basic_cmds  = NULL;
+static const char **basic_funcs = NULL;
+static u8 basic_num_cmds  = 0;
+static u8 basic_num_funcs = 0;
+
+static void basic_select_tables(void)
+{
+    if (myConfig.machine)
+    {
+        u8 disk = (draco_mode >= MODE_DSK);
+        basic_cmds      = coco_commands;
+        basic_funcs     = coco_functions;
+        basic_num_cmds  = disk ? TABLE_SIZE(coco_commands)  : COCO_COMMANDS_EXT;
+        basic_num_funcs = disk ? TABLE_SIZE(coco_functions) : COCO_FUNCTIONS_EXT;
+    }
+    else
+    {
+        basic_cmds      = dragon_commands;
+        basic_funcs     = dragon_functions;
+        basic_num_cmds  = TABLE_SIZE(dragon_commands);
+        basic_num_funcs = TABLE_SIZE(dragon_functions);
+    }
+}
+
+static inline u16 basic_word(u16 addr)
+{
+    return (memory_RAM[addr] << 8) | memory_RAM[addr+1];
+}
+
+static inline void basic_set_word(u8 *dst, u16 val)
+{
+    dst[0] = val >> 8;
+    dst[1] = val & 0xFF;
+}
+
+// Match a keyword at the start of 'src' the way BASIC does - commands first, then functions, first match wins
+static u8 basic_match(const char *src, u32 len, u8 *token, u8 *is_func)
+{
+    for (u8 pass=0; pass<2; pass++)
+    {
+        const char **table = pass ? basic_funcs : basic_cmds;
+        u8 count = pass ? basic_num_funcs : basic_num_cmds;
+
+        for (u8 i=0; i<count; i++)
+        {
+            u8 klen = strlen(table[i]);
+            if (klen > len) continue;
+
+            u8 j;
+            for (j=0; j<klen; j++)
+            {
+                if (toupper((int)src[j]) != table[i][j]) break;
+            }
+            if (j == klen)
+            {
+                *token = 0x80 + i;
+                *is_func = pass;
+                return klen;
+            }
+        }
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------------------
+// Crunch one line of text (without the line number) into 'dst' the way BASIC would had it
+// been typed in. Returns the number of bytes written or 0 if it doesn't fit.
+// ---------------------------------------------------------------------------------------
+static u32 basic_crunch(const char *src, u32 len, u8 *dst, u32 room)
+{
+    u32 out = 0;
+    u8 in_quote = 0, in_data = 0;
+    u32 i = 0;
+
+    while (i < len)
+    {
+        char ch = src[i];
+        u8 token, is_func, klen = 0;
+
+        if (out + 3 > room) return 0;
+
+        if (ch == '"') in_quote = !in_quote;
+        if (ch == ':' && !in_quote) in_data = 0;
+
+        if (!in_quote && !in_data)
+        {
+            if (ch == '?') {token = 0x87; is_func = 0; klen = 1;}   // PRINT
+            else klen = basic_match(&src[i], len - i, &token, &is_func);
+        }
+
+        if (!klen)
+        {
+            dst[out++] = (in_quote || in_data) ? ch : toupper((int)ch);
+            i++;
+            continue;
+        }
+
+        if (is_func) dst[out++] = BASIC_TOKEN_FUNCTION;
+        else if (((token == BASIC_TOKEN_REM_QUOTE) || (token == BASIC_TOKEN_ELSE)) && !(out && (dst[out-1] == ':'))) dst[out++] = ':';
+        dst[out++] = token;
+        i += klen;
+
+        if (!is_func && ((token == BASIC_TOKEN_REM) || (token == BASIC_TOKEN_REM_QUOTE)))
+        {
+            // The rest of the line is a comment
+            for (; i < len; i++)
+            {
+                if (out >= room) return 0;
+                dst[out++] = src[i];
+            }
+        }
+        if (!is_func && (token == BASIC_TOKEN_DATA)) in_data = 1;
+    }
+    return out;
+}
+
+// ---------------------------------------------------------------------------------------
+// Tokenize a whole text listing into program lines starting at BASIC's TXTTAB and put it
+// in place of any program already in memory. Nothing is touched unless BASIC is idle at
+// the OK prompt (the same rule as LOADM - a cartridge or machine code game owns that RAM
+// and BASIC may be part way through an interrupt), every line has a line number in
+// ascending order and the result fits below the string space.
+// ---------------------------------------------------------------------------------------
+u8 BasicLoadText(const char *text, u32 len)
+{
+    if (!boot_at_ok_prompt() || (cpu_get_cc() & BASIC_CC_IRQ_MASK)) return 0;
+
+    u8 *prog = CompressBuffer + BASIC_MAX_TEXT;
+    u32 room = sizeof(CompressBuffer) - BASIC_MAX_TEXT;
+    u16 start = basic_word(BASIC_TXTTAB);
+    u16 limit = basic_word(BASIC_FRETOP);
+    u32 pos = 0, size = 0;
+    s32 last_line = -1;
+
+    basic_select_tables();
+
+    while (pos < len)
+    {
+        // Find the end of this line
+        u32 eol = pos;
+        while ((eol < len) && (text[eol] != '\n') && (text[eol] != '\r')) eol++;
+
+        u32 i = pos;
+        while ((i < eol) && ((text[i] == ' ') || (text[i] == '\t'))) i++;
+
+        if (i < eol)
+        {
+            u32 line = 0;
+            if (!isdigit((int)text[i])) return 0;
+            while ((i < eol) && isdigit((int)text[i])) line = (line * 10) + (text[i++] - '0');
+            if ((line > BASIC_MAX_LINE) || ((s32)line <= last_line)) return 0;
+            while ((i < eol) && (text[i] == ' ')) i++;
+
+            if ((size + 5) > room) return 0;
+            u32 n = basic_crunch(&text[i], eol - i, &prog[size + 4], room - size - 5);
+            if (!n && (i < eol)) return 0;
+
+            basic_set_word(&prog[size], start + size + 4 + n + 1);   // Link to the next line
+            basic_set_word(&prog[size + 2], line);
+            prog[size + 4 + n] = 0x00;
+            size += 4 + n + 1;
+            last_line = line;
+        }
+
+        pos = eol + 1;
+    }
+
+    if ((size + 2) > room) return 0;
+    prog[size++] = 0x00;    // End of program
+    prog[size++] = 0x00;
+
+    if ((start + size + BASIC_STACK_ROOM) > limit) return 0;
+
+    memcpy(&memory_RAM[start], prog, size);
+
+    // Fix up the pointers as if the program had been typed in - no variables, no strings
+    u16 vartab = start + size;
+    basic_set_word(&memory_RAM[BASIC_VARTAB], vartab);
+    basic_set_word(&memory_RAM[BASIC_ARYTAB], vartab);
+    basic_set_word(&memory_RAM[BASIC_ARYEND], vartab);
+    basic_set_word(&memory_RAM[BASIC_STRTAB], basic_word(BASIC_MEMSIZ));
+
+    return 1;
+}
+
+// ---------------------------------------------------------------------------------------
+// Detokenize the program in memory into text the way LIST shows it. Returns the length
+// or 0 if there's no program (or the line chain looks broken).
+// ---------------------------------------------------------------------------------------
+u32 BasicListText(char *out, u32 room)
+{
+    u16 addr = basic_word(BASIC_TXTTAB);
+    u32 len = 0;
+    char szLine[8];
+
+    basic_select_tables();
+
+    while (1)
+    {
+        u16 next = basic_word(addr);
+        if (next == 0) break;
+        if ((next <= addr) || (next >= 0x8000)) return 0;
+
+        sprintf(szLine, "%u ", basic_word(addr + 2));
+        if ((len + strlen(szLine)) >= room) return 0;
+        strcpy(&out[len], szLine);
+        len += strlen(szLine);
+
+        for (u16 p = addr + 4; memory_RAM[p] && (p < next); p++)
+        {
+            u8 ch = memory_RAM[p];
+            const char *word = NULL;
+
+            if (ch == BASIC_TOKEN_FUNCTION)
+            {
+                ch = memory_RAM[++p];
+                if ((ch >= 0x80) && ((ch - 0x80) < basic_num_funcs)) word = basic_funcs[ch - 0x80];
+            }
+            else if (ch >= 0x80)
+            {
+                if ((ch - 0x80) < basic_num_cmds) word = basic_cmds[ch - 0x80];
+            }
+            else if ((ch == ':') && ((memory_RAM[p+1] == BASIC_TOKEN_REM_QUOTE) || (memory_RAM[p+1] == BASIC_TOKEN_ELSE)))
+            {
+                continue;   // The colon BASIC slipped in ahead of ' and ELSE
+            }
+
+            if (word)
+            {
+                if ((len + strlen(word)) >= room) return 0;
+                strcpy(&out[len], word);
+                len += strlen(word);
+            }
+            else if (ch < 0x80)
+            {
+                if ((len + 1) >= room) return 0;
+                out[len++] = ch;
+            }
+        }
+
+        if ((len + 1) >= room) return 0;
+        out[len++] = '\n';
+        addr = next;
+    }
+
+    return len;
+}
+
+u8 BasicLoadFile(const char *filename)
+{
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) return 0;
+
+    u32 len = fread(CompressBuffer, 1, BASIC_MAX_TEXT, fp);
+    fclose(fp);
+
+    return (len > 0) && BasicLoadText((const char *)CompressBuffer, len);
+}
+
+u8 BasicExportFile(const char *filename)
+{
+    u32 len = BasicListText((char *)CompressBuffer, sizeof(CompressBuffer));
+    if (!len) return 0;
+
+    FILE *fp = fopen(filename, "wb");
+    if (!fp) return 0;
+
+    u8 bOK = (fwrite(CompressBuffer, len, 1, fp) == 1);
+    fclose(fp);
+
+    return bOK;
+}
+
+// ---------------------------------------------------------------------------------------
+// Export the program in memory to sav/<game>.bas next to the save states so it can be
+// edited on the PC and brought back with PASTE TEXT.
+// ---------------------------------------------------------------------------------------
+void BasicExport(void)
+{
+    char szFile[MAX_FILENAME_LEN+8];
+
+    DracoSavFilename(szFile, "bas");
+
+    DSPrint(12,0,0, (BasicExportFile(szFile) ? "BASIC SAVED ":"NO PROGRAM  "));
+    WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;
+    DSPrint(12,0,0,"            ");
+}
+
+// End of file
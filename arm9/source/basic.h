@@ -0,0 +1,47 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#ifndef _BASIC_H_
+#define _BASIC_H_
+
+#include <nds.h>
+
+// ---------------------------------------------------------------------------------------
+// BASIC's program pointers live in the direct page at the same place on the CoCo and the
+// Dragon. A program is a chain of lines: next line address, line number, tokenized text
+// and a zero byte. A next line address of zero ends the program.
+// ---------------------------------------------------------------------------------------
+#define BASIC_TXTTAB            0x0019      // Start of the program
+#define BASIC_VARTAB            0x001B      // Start of simple variables (end of the program)
+#define BASIC_ARYTAB            0x001D      // Start of arrays
+#define BASIC_ARYEND            0x001F      // End of arrays
+#define BASIC_FRETOP            0x0021      // Start of string space
+#define BASIC_STRTAB            0x0023      // Bottom of the strings in use
+#define BASIC_MEMSIZ            0x0027      // Top of memory available to BASIC
+
+#define BASIC_STACK_ROOM        512         // Leave BASIC at least this much stack below the strings
+#define BASIC_CC_IRQ_MASK       0x10        // CC.I - set while BASIC is servicing an interrupt
+#define BASIC_MAX_LINE          63999
+#define BASIC_MAX_TEXT          (64*1024)   // Largest text file we'll tokenize
+
+#define BASIC_TOKEN_FUNCTION    0xFF        // Functions are this byte followed by the function token
+#define BASIC_TOKEN_REM         0x82
+#define BASIC_TOKEN_REM_QUOTE   0x83        // ' is stored as a colon and this token...
+#define BASIC_TOKEN_ELSE        0x84        // ...as is ELSE
+#define BASIC_TOKEN_DATA        0x86
+
+extern u8  BasicLoadText(const char *text, u32 len);
+extern u32 BasicListText(char *out, u32 room);
+extern u8  BasicLoadFile(const char *filename);
+extern u8  BasicExportFile(const char *filename);
+extern void BasicExport(void);
+
+#endif // _BASIC_H_
@@ -32,12 +32,11 @@
 #include    "mc6809e.h"
 #include    "mem.h"
 #include    "cpu.h"
+#include    "stats.h"
+#include    "trace.h"
 
 extern u32 debug[0x10];
 
-#define CPU_CYCLES_PER_LINE             57
-#define CPU_CYCLES_PER_LINE_OVERCLOCK   (CPU_CYCLES_PER_LINE * 2)
-
 /* -----------------------------------------
    Local definitions
 ----------------------------------------- */
@@ -54,12 +53,27 @@ extern u32 debug[0x10];
 #define     VEC_SWI3                0xfff2
 #define     VEC_RESERVED            0xfff0
 
-/* Indexed addressing post-byte bit fields
+/* Fused op-code pairs (see fuse_ready()). Build with -DCPU_FUSION=0
+ * to send every op-code around the main loop - e.g. to compare the
+ * KIPS shown in the debugger with and without.
+ */
+#define     FUSE_BRANCH             0x01        // Compare, test or count followed by a short conditional branch
+#define     FUSE_STORE              0x02        // Load followed by a store of the same register
+
+#ifndef CPU_FUSION
+#define     CPU_FUSION              (FUSE_BRANCH | FUSE_STORE)
+#endif
+
+/* What the op-code just run may be fused with. The stores
+ * are the op-code with the addressing mode bits clear.
  */
-#define     INDX_POST_5BIT_OFF      0x80
-#define     INDX_POST_REG           0x60
-#define     INDX_POST_INDIRECT      0x10
-#define     INDX_POST_MODE          0x0f
+#define     FUSE_NONE               0x00
+#define     FUSE_BCC                0x20        // Any short conditional branch
+#define     FUSE_STA                0x87
+#define     FUSE_STB                0xc7
+#define     FUSE_STD                0xcd
+#define     FUSE_STX                0x8f
+#define     FUSE_STU                0xcf
 
 /* Condition-code register bit
  */
@@ -72,6 +86,27 @@ extern u32 debug[0x10];
 #define     GET_REG_LOW(r)          ((uint8_t)r)
 #define     SIG_EXTEND(b)           ((((uint8_t)b) & 0x80) ? (((uint16_t)b) | 0xff00):((uint16_t)b))
 
+/* Working copy of the hottest registers.
+ * cpu_run() keeps PC and S in a local copy of this for the whole time
+ * slice so the compiler can hold them in machine registers rather than
+ * re-reading the global 'cpu' after every memory write (a byte store into
+ * RAM may alias anything). Only these two are worth it - with every
+ * register local there are more live values than callee-saved machine
+ * registers and the calls out to the IO handlers force them all to the
+ * stack, which measured slower than leaving them in 'cpu'. The copy is
+ * written back when cpu_run() returns and around the op-codes handled by
+ * the out-of-line helpers which still work on 'cpu' (stacking, SWI, RTI).
+ * The IO handlers only ever touch interrupt lines, never the registers.
+ */
+typedef struct
+{
+    uint16_t    pc;
+    uint16_t    s;
+} cpu_regs_t;
+
+#define     REGS_LOAD(r)            {r.pc = cpu.pc; r.s = cpu.s;}
+#define     REGS_SPILL(r)           {cpu.pc = r.pc; cpu.s = r.s;}
+
 /* -----------------------------------------
    Module functions
 ----------------------------------------- */
@@ -96,7 +131,7 @@ void    cwai(uint8_t byte);
 void    daa(void);
 uint8_t dec(uint8_t byte);
 uint8_t eor(uint8_t acc, uint8_t byte);
-void    exg(uint8_t regs);
+void    exg(cpu_regs_t *r, uint8_t regs);
 uint8_t inc(uint8_t byte);
 uint8_t lsr(uint8_t byte);
 uint8_t neg(uint8_t byte);
@@ -114,15 +149,18 @@ void    sex(void);
 uint8_t sub(uint8_t acc, uint8_t byte);
 void    subd(uint16_t word);
 void    swi(int swi_id);
-void    tfr(uint8_t regs);
+void    tfr(cpu_regs_t *r, uint8_t regs);
 void    tst(uint8_t byte);
 
 /* CPU op-code support functions
  */
-void     branch(int instruction, int long_short, uint16_t effective_address);
-int      get_eff_addr(int op_code);
-uint16_t read_register(int reg);
-void     write_register(int reg, uint16_t data);
+void     branch(cpu_regs_t *r, int instruction, int long_short, uint16_t effective_address);
+int      get_eff_addr(cpu_regs_t *r, int op_code);
+int      fuse_ready(int cycles_per_line);
+uint16_t get_index_reg(cpu_regs_t *r, int reg_select);
+void     set_index_reg(cpu_regs_t *r, int reg_select, uint16_t value);
+uint16_t read_register(cpu_regs_t *r, int reg);
+void     write_register(cpu_regs_t *r, int reg, uint16_t data);
 
 /* Condition code register CC functions
  */
@@ -148,24 +186,49 @@ void    set_cc(uint8_t value);
  */
 cpu_state_t cpu  __attribute__((section(".dtcm")));
 
-struct cc_t
+/* CC flags are kept one per byte. The first four (C, V, Z, N) overlay
+ * a single word so the 8-bit ALU helpers can set all four with one store.
+ */
+union cc_t
 {
-    int c;
-    int v;
-    int z;
-    int n;
-    int i;
-    int h;
-    int f;
-    int e;
-} cc __attribute__((section(".dtcm")));
+    struct
+    {
+        uint8_t c;
+        uint8_t v;
+        uint8_t z;
+        uint8_t n;
+        uint8_t i;
+        uint8_t h;
+        uint8_t f;
+        uint8_t e;
+    };
+    uint32_t cvzn;
+} cc __attribute__((section(".dtcm"))) __attribute__((aligned(4)));
+
+/* C, Z and N for every 9-bit ALU result (bit 8 is the carry/borrow out of
+ * an 8-bit add or subtract) laid out to match 'cc.cvzn'. The V flag also
+ * needs both operands so it is worked out separately and OR'd in with CC_V8().
+ * This is built by the preprocessor - 2K fits the data cache far better than
+ * a table indexed by both operands and the carry would (128K+ per operation).
+ * It lives in DTCM with 'cc' so the lookup never waits on a cache miss - it
+ * can't be const there (the section is writable data).
+ */
+#define     CC_C_BYTE               0x00000001
+#define     CC_V_BYTE               0x00000100
+#define     CC_NZC(i)               ((((i) >> 8) & 1) | ((((i) & 0xff) == 0) << 16) | ((((i) >> 7) & 1) << 24))
+#define     CC_NZC4(i)              CC_NZC(i),      CC_NZC(i+1),      CC_NZC(i+2),      CC_NZC(i+3)
+#define     CC_NZC16(i)             CC_NZC4(i),     CC_NZC4(i+4),     CC_NZC4(i+8),     CC_NZC4(i+12)
+#define     CC_NZC64(i)             CC_NZC16(i),    CC_NZC16(i+16),   CC_NZC16(i+32),   CC_NZC16(i+48)
+#define     CC_NZC256(i)            CC_NZC64(i),    CC_NZC64(i+64),   CC_NZC64(i+128),  CC_NZC64(i+192)
+
+static uint32_t cc_nzc[512] __attribute__((section(".dtcm"))) __attribute__((aligned(32))) = {CC_NZC256(0), CC_NZC256(256)};
+
+#define     CC_V8(val1, val2, res)  (((((val1) ^ (res)) & ((val2) ^ (res))) & 0x80) << 1)    // V flag placed for 'cc.cvzn'
 
 int cycles_this_scanline    __attribute__((section(".dtcm"))) = 0;
 
 #define     d       ((uint16_t)(((uint16_t)cpu.a << 8) + cpu.b))    // Accumulator D
 
-static uint16_t *reg_lookup[4] __attribute__((section(".dtcm"))) = {&cpu.x, &cpu.y, &cpu.u, &cpu.s};
-
 
 /*------------------------------------------------
  * cpu_init()
@@ -219,6 +282,12 @@ int cpu_init(int address)
 void cpu_halt(int state)
 {
     cpu.halt_asserted = state;
+
+    // The CPU finishes the current instruction and then sits idle until the line is released
+    if (state && (cpu.cpu_state == CPU_EXEC))
+    {
+        cpu.cpu_state = CPU_HALT_LINE;
+    }
 }
 
 /*------------------------------------------------
@@ -290,6 +359,51 @@ void cpu_check_reset(void)
     }
 }
 
+/*------------------------------------------------
+ * cpu_get_cc()
+ *
+ *  Return the CC register as a packed 8-bit value.
+ *  The flags are kept unpacked while running so
+ *  this is used to snapshot the CPU state.
+ *
+ *  param:  Nothing
+ *  return: 8-bit value of CC register
+ */
+uint8_t cpu_get_cc(void)
+{
+    return get_cc();
+}
+
+/*------------------------------------------------
+ * cpu_set_cc()
+ *
+ *  Set the CC register from a packed 8-bit value
+ *  (used when restoring a CPU state snapshot).
+ *
+ *  param:  8-bit value of CC register
+ *  return: Nothing
+ */
+void cpu_set_cc(uint8_t value)
+{
+    set_cc(value);
+}
+
+/*------------------------------------------------
+ * cpu_op_cycles()
+ *
+ *  Return the base cycle count from the op-code
+ *  tables (used by the CPU self-check).
+ *
+ *  param:  Page (0, 0x10 or 0x11) and op-code
+ *  return: Base cycles for the op-code
+ */
+uint8_t cpu_op_cycles(int page, int op_code)
+{
+    if (page == 0x10) return machine_code_10[op_code & 0xff].cycles;
+    if (page == 0x11) return machine_code_11[op_code & 0xff].cycles;
+    return machine_code[op_code & 0xff].cycles;
+}
+
 /*------------------------------------------------
  * cpu_run()
  *
@@ -306,9 +420,14 @@ ITCM_CODE void cpu_run(void)
     uint8_t     operand8;
     uint16_t    operand16;
     int         op_code;
+    int         fuse_op;
+
+    cpu_regs_t  r;
 
     int cycles_per_line = (sam_registers.mpu_rate) ? CPU_CYCLES_PER_LINE_OVERCLOCK : CPU_CYCLES_PER_LINE;
 
+    REGS_LOAD(r);
+
     while (1)
     {
         /* Latch interrupt requests - these can change between opcode processing so must be re-latched every CPU pass
@@ -323,6 +442,15 @@ ITCM_CODE void cpu_run(void)
          */
         if (cpu.cpu_state) // Something OTHER than CPU_EXEC
         {
+            if (cpu.cpu_state == CPU_HALT_LINE)
+            {
+                if (cpu.halt_asserted)
+                {
+                    break;  // Held off the bus - nothing runs until the HALT line is released
+                }
+                cpu.cpu_state = CPU_EXEC;
+            }
+
             if ( cpu.cpu_state == CPU_SYNC )
             {
                 if ( intr_latch & (INT_NMI | INT_FIRQ | INT_IRQ) )
@@ -331,7 +459,7 @@ ITCM_CODE void cpu_run(void)
                 }
                 else
                 {
-                    return; // Waiting for an interrupt (masked or not)
+                    break;  // Waiting for an interrupt (masked or not)
                 }
             }
 
@@ -340,22 +468,22 @@ ITCM_CODE void cpu_run(void)
                 if (intr_latch & INT_NMI)
                 {
                     cpu.cpu_state = CPU_EXEC;
-                    cpu.pc = (mem_read(VEC_NMI) << 8) + mem_read(VEC_NMI+1);
+                    r.pc = (mem_read(VEC_NMI) << 8) + mem_read(VEC_NMI+1);
                     intr_latch = 0;
                 }
                 else if ( !(cc.f) && (intr_latch & INT_FIRQ) )
                 {
                     cpu.cpu_state = CPU_EXEC;
-                    cpu.pc = (mem_read(VEC_FIRQ) << 8) + mem_read(VEC_FIRQ+1);
+                    r.pc = (mem_read(VEC_FIRQ) << 8) + mem_read(VEC_FIRQ+1);
                     intr_latch = 0;
                 }
                 else if ( !(cc.i) && (intr_latch & INT_IRQ) )
                 {
                     cpu.cpu_state = CPU_EXEC;
-                    cpu.pc = (mem_read(VEC_IRQ) << 8) + mem_read(VEC_IRQ+1);
+                    r.pc = (mem_read(VEC_IRQ) << 8) + mem_read(VEC_IRQ+1);
                     intr_latch = 0;
                 }
-                else return; // We're waiting for an unmasked interrupt
+                else break; // We're waiting for an unmasked interrupt
             }
         }
 
@@ -387,18 +515,18 @@ ITCM_CODE void cpu_run(void)
                 cc.e = CC_FLAG_SET;
                 cycles_this_scanline += 19;
 
-                mem_write_fast(--cpu.s, cpu.pc & 0xff);
-                mem_write_fast(--cpu.s, (cpu.pc >> 8) & 0xff);
-                mem_write_fast(--cpu.s, cpu.u & 0xff);
-                mem_write_fast(--cpu.s, (cpu.u >> 8) & 0xff);
-                mem_write_fast(--cpu.s, cpu.y & 0xff);
-                mem_write_fast(--cpu.s, (cpu.y >> 8) & 0xff);
-                mem_write_fast(--cpu.s, cpu.x & 0xff);
-                mem_write_fast(--cpu.s, (cpu.x >> 8) & 0xff);
-                mem_write_fast(--cpu.s, cpu.dp);
-                mem_write_fast(--cpu.s, cpu.b);
-                mem_write_fast(--cpu.s, cpu.a);
-                mem_write_fast(--cpu.s, get_cc());
+                mem_write_fast(--r.s, r.pc & 0xff);
+                mem_write_fast(--r.s, (r.pc >> 8) & 0xff);
+                mem_write_fast(--r.s, cpu.u & 0xff);
+                mem_write_fast(--r.s, (cpu.u >> 8) & 0xff);
+                mem_write_fast(--r.s, cpu.y & 0xff);
+                mem_write_fast(--r.s, (cpu.y >> 8) & 0xff);
+                mem_write_fast(--r.s, cpu.x & 0xff);
+                mem_write_fast(--r.s, (cpu.x >> 8) & 0xff);
+                mem_write_fast(--r.s, cpu.dp);
+                mem_write_fast(--r.s, cpu.b);
+                mem_write_fast(--r.s, cpu.a);
+                mem_write_fast(--r.s, get_cc());
 
                 cpu.nmi_latched = 0;
                 intr_latch &= ~INT_NMI;
@@ -406,7 +534,7 @@ ITCM_CODE void cpu_run(void)
                 cc.f = CC_FLAG_SET;
                 cc.i = CC_FLAG_SET;
 
-                cpu.pc = (mem_read(VEC_NMI) << 8) + mem_read(VEC_NMI+1);
+                r.pc = (mem_read(VEC_NMI) << 8) + mem_read(VEC_NMI+1);
             }
             else if ( !(cc.f) && (intr_latch & INT_FIRQ) )
             {
@@ -414,14 +542,14 @@ ITCM_CODE void cpu_run(void)
                 cc.e = CC_FLAG_CLR;
                 cycles_this_scanline += 10;
 
-                mem_write_fast(--cpu.s, cpu.pc & 0xff);
-                mem_write_fast(--cpu.s, (cpu.pc >> 8) & 0xff);
-                mem_write_fast(--cpu.s, get_cc());
+                mem_write_fast(--r.s, r.pc & 0xff);
+                mem_write_fast(--r.s, (r.pc >> 8) & 0xff);
+                mem_write_fast(--r.s, get_cc());
 
                 cc.f = CC_FLAG_SET;
                 cc.i = CC_FLAG_SET;
 
-                cpu.pc = (mem_read(VEC_FIRQ) << 8) + mem_read(VEC_FIRQ+1);
+                r.pc = (mem_read(VEC_FIRQ) << 8) + mem_read(VEC_FIRQ+1);
 
                 extern u8 clear_firq_immediate;
                 if (clear_firq_immediate) // Shamus hack
@@ -435,27 +563,29 @@ ITCM_CODE void cpu_run(void)
                 cc.e = CC_FLAG_SET;
                 cycles_this_scanline += 21;
 
-                mem_write_fast(--cpu.s, cpu.pc & 0xff);
-                mem_write_fast(--cpu.s, (cpu.pc >> 8) & 0xff);
-                mem_write_fast(--cpu.s, cpu.u & 0xff);
-                mem_write_fast(--cpu.s, (cpu.u >> 8) & 0xff);
-                mem_write_fast(--cpu.s, cpu.y & 0xff);
-                mem_write_fast(--cpu.s, (cpu.y >> 8) & 0xff);
-                mem_write_fast(--cpu.s, cpu.x & 0xff);
-                mem_write_fast(--cpu.s, (cpu.x >> 8) & 0xff);
-                mem_write_fast(--cpu.s, cpu.dp);
-                mem_write_fast(--cpu.s, cpu.b);
-                mem_write_fast(--cpu.s, cpu.a);
-                mem_write_fast(--cpu.s, get_cc());
+                mem_write_fast(--r.s, r.pc & 0xff);
+                mem_write_fast(--r.s, (r.pc >> 8) & 0xff);
+                mem_write_fast(--r.s, cpu.u & 0xff);
+                mem_write_fast(--r.s, (cpu.u >> 8) & 0xff);
+                mem_write_fast(--r.s, cpu.y & 0xff);
+                mem_write_fast(--r.s, (cpu.y >> 8) & 0xff);
+                mem_write_fast(--r.s, cpu.x & 0xff);
+                mem_write_fast(--r.s, (cpu.x >> 8) & 0xff);
+                mem_write_fast(--r.s, cpu.dp);
+                mem_write_fast(--r.s, cpu.b);
+                mem_write_fast(--r.s, cpu.a);
+                mem_write_fast(--r.s, get_cc());
 
                 cc.i = CC_FLAG_SET;
 
-                cpu.pc = (mem_read(VEC_IRQ) << 8) + mem_read(VEC_IRQ+1);
+                r.pc = (mem_read(VEC_IRQ) << 8) + mem_read(VEC_IRQ+1);
             }
         }
 
+        TRACE_OP(REGS_SPILL(r));
+
         // Fetch the OP Code directly from memory
-        op_code = mem_read_pc(cpu.pc++);
+        op_code = mem_read_pc(r.pc++);
 
         // Process the Op-Code... handle the double-byte instructions as part of the normal case
         {
@@ -465,17 +595,25 @@ ITCM_CODE void cpu_run(void)
              */
             cycles_this_scanline += machine_code[op_code].cycles;
 
-            eff_addr = get_eff_addr(machine_code[op_code].mode);
+            STATS_OP(0, op_code);
+            STATS_MODE(machine_code[op_code].mode);
+
+            eff_addr = get_eff_addr(&r, machine_code[op_code].mode);
+
+            fuse_op = FUSE_NONE;
 
             switch ( op_code )
             {
                 case 0x11:
                 {
-                    op_code = mem_read_pc(cpu.pc++);
+                    op_code = mem_read_pc(r.pc++);
 
                     cycles_this_scanline += machine_code_11[op_code].cycles;
 
-                    eff_addr = get_eff_addr(machine_code_11[op_code].mode);
+                    STATS_OP(2, op_code);
+                    STATS_MODE(machine_code_11[op_code].mode);
+
+                    eff_addr = get_eff_addr(&r, machine_code_11[op_code].mode);
 
                     switch ( op_code )
                     {
@@ -487,6 +625,7 @@ ITCM_CODE void cpu_run(void)
                         case 0xb3:
                             operand16 = mem_read16(eff_addr);
                             cmp16(cpu.u, operand16);
+                            fuse_op = FUSE_BCC;
                             break;
 
                         /* CMPS
@@ -496,13 +635,16 @@ ITCM_CODE void cpu_run(void)
                         case 0xac:
                         case 0xbc:
                             operand16 = mem_read16(eff_addr);
-                            cmp16(cpu.s, operand16);
+                            cmp16(r.s, operand16);
+                            fuse_op = FUSE_BCC;
                             break;
 
                         /* SWI3
                          */
                         case 0x3f:
+                            REGS_SPILL(r);
                             swi(3);
+                            REGS_LOAD(r);
                             break;
 
                         case 0x3d:  // Technically invalid... but MUL
@@ -525,11 +667,14 @@ ITCM_CODE void cpu_run(void)
 
                 case 0x10:
                 {
-                    op_code = mem_read_pc(cpu.pc++);
+                    op_code = mem_read_pc(r.pc++);
 
                     cycles_this_scanline += machine_code_10[op_code].cycles;
 
-                    eff_addr = get_eff_addr(machine_code_10[op_code].mode);
+                    STATS_OP(1, op_code);
+                    STATS_MODE(machine_code_10[op_code].mode);
+
+                    eff_addr = get_eff_addr(&r, machine_code_10[op_code].mode);
 
                     switch ( op_code )
                     {
@@ -541,6 +686,7 @@ ITCM_CODE void cpu_run(void)
                         case 0xb3:
                             operand16 = mem_read16(eff_addr);
                             cmp16(d, operand16);
+                            fuse_op = FUSE_BCC;
                             break;
 
                         /* CMPY
@@ -551,6 +697,7 @@ ITCM_CODE void cpu_run(void)
                         case 0xbc:
                             operand16 = mem_read16(eff_addr);
                             cmp16(cpu.y, operand16);
+                            fuse_op = FUSE_BCC;
                             break;
 
                         /* LDS
@@ -559,9 +706,9 @@ ITCM_CODE void cpu_run(void)
                         case 0xde:
                         case 0xee:
                         case 0xfe:
-                            cpu.s = mem_read16(eff_addr);
-                            eval_cc_z16(cpu.s);
-                            eval_cc_n16(cpu.s);
+                            r.s = mem_read16(eff_addr);
+                            eval_cc_z16(r.s);
+                            eval_cc_n16(r.s);
                             cc.v = CC_FLAG_CLR;
                             cpu.nmi_armed = 1;
                             break;
@@ -583,10 +730,10 @@ ITCM_CODE void cpu_run(void)
                         case 0xdf:
                         case 0xef:
                         case 0xff:
-                            mem_write(eff_addr, (uint8_t) (cpu.s >> 8));
-                            mem_write(eff_addr + 1, (uint8_t) (cpu.s));
-                            eval_cc_z16(cpu.s);
-                            eval_cc_n16(cpu.s);
+                            mem_write(eff_addr, (uint8_t) (r.s >> 8));
+                            mem_write((eff_addr + 1) & 0xffff, (uint8_t) (r.s));
+                            eval_cc_z16(r.s);
+                            eval_cc_n16(r.s);
                             cc.v = CC_FLAG_CLR;
                             break;
 
@@ -596,7 +743,7 @@ ITCM_CODE void cpu_run(void)
                         case 0xaf:
                         case 0xbf:
                             mem_write(eff_addr, (uint8_t) (cpu.y >> 8));
-                            mem_write(eff_addr + 1, (uint8_t) (cpu.y));
+                            mem_write((eff_addr + 1) & 0xffff, (uint8_t) (cpu.y));
                             eval_cc_z16(cpu.y);
                             eval_cc_n16(cpu.y);
                             cc.v = CC_FLAG_CLR;
@@ -611,13 +758,15 @@ ITCM_CODE void cpu_run(void)
                         /* Long conditional branches
                          */
                         case 0x22 ... 0x2f:
-                            branch(op_code, 1, eff_addr);
+                            branch(&r, op_code, 1, eff_addr);
                             break;
 
                         /* SWI2
                          */
                         case 0x3f:
+                            REGS_SPILL(r);
                             swi(2);
+                            REGS_LOAD(r);
                             break;
 
                         case 0xcf:
@@ -762,6 +911,7 @@ ITCM_CODE void cpu_run(void)
                 case 0xb5:
                     operand8 = (uint8_t) mem_read(eff_addr);
                     bit(cpu.a, operand8);
+                    fuse_op = FUSE_BCC;
                     break;
 
                 /* BITB
@@ -772,6 +922,7 @@ ITCM_CODE void cpu_run(void)
                 case 0xf5:
                     operand8 = (uint8_t) mem_read(eff_addr);
                     bit(cpu.b, operand8);
+                    fuse_op = FUSE_BCC;
                     break;
 
                 /* CLR, CLRA, CLRB
@@ -799,6 +950,7 @@ ITCM_CODE void cpu_run(void)
                 case 0xb1:
                     operand8 = (uint8_t) mem_read(eff_addr);
                     cmp(cpu.a, operand8);
+                    fuse_op = FUSE_BCC;
                     break;
 
                 /* CMPB
@@ -809,6 +961,7 @@ ITCM_CODE void cpu_run(void)
                 case 0xf1:
                     operand8 = (uint8_t) mem_read(eff_addr);
                     cmp(cpu.b, operand8);
+                    fuse_op = FUSE_BCC;
                     break;
 
                 /* CMPX
@@ -819,6 +972,7 @@ ITCM_CODE void cpu_run(void)
                 case 0xbc:
                     operand16 = mem_read16(eff_addr);
                     cmp16(cpu.x, operand16);
+                    fuse_op = FUSE_BCC;
                     break;
 
                 /* COM, COMA, COMB
@@ -843,7 +997,9 @@ ITCM_CODE void cpu_run(void)
                  */
                 case 0x3c:
                     operand8 = (uint8_t) mem_read(eff_addr);
+                    REGS_SPILL(r);
                     cwai(operand8);
+                    REGS_LOAD(r);
                     break;
 
                 /* DAA
@@ -861,14 +1017,17 @@ ITCM_CODE void cpu_run(void)
                     operand8 = (uint8_t) mem_read(eff_addr);
                     operand8 = dec(operand8);
                     mem_write(eff_addr, operand8);
+                    fuse_op = FUSE_BCC;
                     break;
 
                 case 0x4a:
                     cpu.a = dec(cpu.a);
+                    fuse_op = FUSE_BCC;
                     break;
 
                 case 0x5a:
                     cpu.b = dec(cpu.b);
+                    fuse_op = FUSE_BCC;
                     break;
 
                 /* EORA
@@ -895,7 +1054,7 @@ ITCM_CODE void cpu_run(void)
                  */
                 case 0x1e:
                     operand8 = (uint8_t) mem_read(eff_addr);
-                    exg(operand8);
+                    exg(&r, operand8);
                     break;
 
                 /* INC, INCA, INCB
@@ -910,10 +1069,12 @@ ITCM_CODE void cpu_run(void)
 
                 case 0x4c:
                     cpu.a = inc(cpu.a);
+                    fuse_op = FUSE_BCC;
                     break;
 
                 case 0x5c:
                     cpu.b = inc(cpu.b);
+                    fuse_op = FUSE_BCC;
                     break;
 
                 /* JMP
@@ -921,7 +1082,7 @@ ITCM_CODE void cpu_run(void)
                 case 0x0e:
                 case 0x6e:
                 case 0x7e:
-                    cpu.pc = eff_addr;
+                    r.pc = eff_addr;
                     break;
 
                 /* JSR
@@ -929,9 +1090,9 @@ ITCM_CODE void cpu_run(void)
                 case 0x9d:
                 case 0xad:
                 case 0xbd:
-                    mem_write_fast(--cpu.s, GET_REG_LOW(cpu.pc));
-                    mem_write_fast(--cpu.s, GET_REG_HIGH(cpu.pc));
-                    cpu.pc = eff_addr;
+                    mem_write_fast(--r.s, GET_REG_LOW(r.pc));
+                    mem_write_fast(--r.s, GET_REG_HIGH(r.pc));
+                    r.pc = eff_addr;
                     break;
 
                 /* LDA
@@ -941,9 +1102,8 @@ ITCM_CODE void cpu_run(void)
                 case 0xa6:
                 case 0xb6:
                     cpu.a = (uint8_t) mem_read(eff_addr);
-                    eval_cc_z((uint16_t) cpu.a);
-                    eval_cc_n((uint16_t) cpu.a);
-                    cc.v = CC_FLAG_CLR;
+                    tst(cpu.a);
+                    fuse_op = FUSE_STA;
                     break;
 
                 /* LDB
@@ -953,9 +1113,8 @@ ITCM_CODE void cpu_run(void)
                 case 0xe6:
                 case 0xf6:
                     cpu.b = (uint8_t) mem_read(eff_addr);
-                    eval_cc_z((uint16_t) cpu.b);
-                    eval_cc_n((uint16_t) cpu.b);
-                    cc.v = CC_FLAG_CLR;
+                    tst(cpu.b);
+                    fuse_op = FUSE_STB;
                     break;
 
                 /* LDD
@@ -965,10 +1124,11 @@ ITCM_CODE void cpu_run(void)
                 case 0xec:
                 case 0xfc:
                     cpu.a = (uint8_t) mem_read(eff_addr);
-                    cpu.b = (uint8_t) mem_read(eff_addr+1);
+                    cpu.b = (uint8_t) mem_read((eff_addr + 1) & 0xffff);
                     eval_cc_z16(d);
                     eval_cc_n16(d);
                     cc.v = CC_FLAG_CLR;
+                    fuse_op = FUSE_STD;
                     break;
 
                 /* LDU
@@ -981,6 +1141,7 @@ ITCM_CODE void cpu_run(void)
                     eval_cc_z16(cpu.u);
                     eval_cc_n16(cpu.u);
                     cc.v = CC_FLAG_CLR;
+                    fuse_op = FUSE_STU;
                     break;
 
                 /* LDX
@@ -993,6 +1154,7 @@ ITCM_CODE void cpu_run(void)
                     eval_cc_z16(cpu.x);
                     eval_cc_n16(cpu.x);
                     cc.v = CC_FLAG_CLR;
+                    fuse_op = FUSE_STX;
                     break;
 
                 /* LEA
@@ -1000,15 +1162,17 @@ ITCM_CODE void cpu_run(void)
                 case 0x30:
                     cpu.x = eff_addr;
                     eval_cc_z16(cpu.x);
+                    fuse_op = FUSE_BCC;
                     break;
 
                 case 0x31:
                     cpu.y = eff_addr;
                     eval_cc_z16(cpu.y);
+                    fuse_op = FUSE_BCC;
                     break;
 
                 case 0x32:
-                    cpu.s = eff_addr;
+                    r.s = eff_addr;
                     cpu.nmi_armed = 1;
                     break;
 
@@ -1103,24 +1267,32 @@ ITCM_CODE void cpu_run(void)
                  */
                 case 0x34:
                     operand8 = (uint8_t) mem_read(eff_addr);
+                    REGS_SPILL(r);
                     pshs(operand8);
+                    REGS_LOAD(r);
                     break;
 
                 case 0x36:
                     operand8 = (uint8_t) mem_read(eff_addr);
+                    REGS_SPILL(r);
                     pshu(operand8);
+                    REGS_LOAD(r);
                     break;
 
                 /* PULS, PULU
                  */
                 case 0x35:
                     operand8 = (uint8_t) mem_read(eff_addr);
+                    REGS_SPILL(r);
                     puls(operand8);
+                    REGS_LOAD(r);
                     break;
 
                 case 0x37:
                     operand8 = (uint8_t) mem_read(eff_addr);
+                    REGS_SPILL(r);
                     pulu(operand8);
+                    REGS_LOAD(r);
                     break;
 
                 /* ROL, ROLA, ROLB
@@ -1162,7 +1334,9 @@ ITCM_CODE void cpu_run(void)
                 /* RTI
                  */
                 case 0x3b:
+                    REGS_SPILL(r);
                     rti();
+                    REGS_LOAD(r);
                     break;
 
                 /* RTS
@@ -1170,10 +1344,10 @@ ITCM_CODE void cpu_run(void)
                 case 0x39:
                      /* Restore PC and return
                       */
-                     operand8 = mem_read(cpu.s++);
-                     cpu.pc = (uint16_t) operand8 << 8;
-                     operand8 = mem_read(cpu.s++);
-                     cpu.pc += operand8;
+                     operand8 = mem_read(r.s++);
+                     r.pc = (uint16_t) operand8 << 8;
+                     operand8 = mem_read(r.s++);
+                     r.pc += operand8;
                      break;
 
                 /* SBCA
@@ -1208,9 +1382,7 @@ ITCM_CODE void cpu_run(void)
                 case 0xa7:
                 case 0xb7:
                     mem_write(eff_addr, cpu.a);
-                    eval_cc_z((uint16_t) cpu.a);
-                    eval_cc_n((uint16_t) cpu.a);
-                    cc.v = CC_FLAG_CLR;
+                    tst(cpu.a);
                     break;
 
                 /* STB
@@ -1219,9 +1391,7 @@ ITCM_CODE void cpu_run(void)
                 case 0xe7:
                 case 0xf7:
                     mem_write(eff_addr, cpu.b);
-                    eval_cc_z((uint16_t) cpu.b);
-                    eval_cc_n((uint16_t) cpu.b);
-                    cc.v = CC_FLAG_CLR;
+                    tst(cpu.b);
                     break;
 
                 /* STD
@@ -1230,7 +1400,7 @@ ITCM_CODE void cpu_run(void)
                 case 0xed:
                 case 0xfd:
                     mem_write(eff_addr, cpu.a);
-                    mem_write(eff_addr + 1, cpu.b);
+                    mem_write((eff_addr + 1) & 0xffff, cpu.b);
                     eval_cc_z16(d);
                     eval_cc_n16(d);
                     cc.v = CC_FLAG_CLR;
@@ -1242,7 +1412,7 @@ ITCM_CODE void cpu_run(void)
                 case 0xef:
                 case 0xff:
                     mem_write(eff_addr, (uint8_t) (cpu.u >> 8));
-                    mem_write(eff_addr + 1, (uint8_t) (cpu.u));
+                    mem_write((eff_addr + 1) & 0xffff, (uint8_t) (cpu.u));
                     eval_cc_z16(cpu.u);
                     eval_cc_n16(cpu.u);
                     cc.v = CC_FLAG_CLR;
@@ -1254,7 +1424,7 @@ ITCM_CODE void cpu_run(void)
                 case 0xaf:
                 case 0xbf:
                     mem_write(eff_addr, (uint8_t) (cpu.x >> 8));
-                    mem_write(eff_addr + 1, (uint8_t) (cpu.x));
+                    mem_write((eff_addr + 1) & 0xffff, (uint8_t) (cpu.x));
                     eval_cc_z16(cpu.x);
                     eval_cc_n16(cpu.x);
                     cc.v = CC_FLAG_CLR;
@@ -1293,7 +1463,9 @@ ITCM_CODE void cpu_run(void)
                 /* SWI
                  */
                 case 0x3f:
+                    REGS_SPILL(r);
                     swi(1);
+                    REGS_LOAD(r);
                     break;
 
                 /* SYNC
@@ -1310,19 +1482,21 @@ ITCM_CODE void cpu_run(void)
                  */
                 case 0x1f:
                     operand8 = (uint8_t) mem_read(eff_addr);
-                    tfr(operand8);
+                    tfr(&r, operand8);
                     break;
 
                 /* TSTA
                  */
                 case 0x4d:
                     tst(cpu.a);
+                    fuse_op = FUSE_BCC;
                     break;
 
                 /* TSTB
                  */
                 case 0x5d:
                     tst(cpu.b);
+                    fuse_op = FUSE_BCC;
                     break;
 
                 /* TST
@@ -1332,13 +1506,14 @@ ITCM_CODE void cpu_run(void)
                 case 0x7d:
                     operand8 = (uint8_t) mem_read(eff_addr);
                     tst(operand8);
+                    fuse_op = FUSE_BCC;
                     break;
 
                 /* BRA / LBRA
                  */
                 case 0x20:
                 case 0x16:
-                    cpu.pc = eff_addr;
+                    r.pc = eff_addr;
                     break;
 
                 /* BRN
@@ -1351,15 +1526,15 @@ ITCM_CODE void cpu_run(void)
                  */
                 case 0x8d:
                 case 0x17:
-                    mem_write_fast(--cpu.s, GET_REG_LOW(cpu.pc));
-                    mem_write_fast(--cpu.s, GET_REG_HIGH(cpu.pc));
-                    cpu.pc = eff_addr;
+                    mem_write_fast(--r.s, GET_REG_LOW(r.pc));
+                    mem_write_fast(--r.s, GET_REG_HIGH(r.pc));
+                    r.pc = eff_addr;
                     break;
 
                 /* Short conditional branches
                  */
                 case 0x22 ... 0x2f:
-                    branch(op_code, 0, eff_addr);
+                    branch(&r, op_code, 0, eff_addr);
                     break;
 
                 case 0x87:
@@ -1393,14 +1568,72 @@ ITCM_CODE void cpu_run(void)
                     cpu.cpu_state = CPU_EXCEPTION;
 
             }
+
+            /* Run the second op-code of a fused pair right here,
+             * without going back around to the interrupt checks.
+             */
+            if ( fuse_op && fuse_ready(cycles_per_line) )
+            {
+                op_code = mem_read_pc(r.pc);
+
+                if ( fuse_op == FUSE_BCC )
+                {
+                    if ( (CPU_FUSION & FUSE_BRANCH) && (op_code >= 0x22) && (op_code <= 0x2f) )
+                    {
+                        TRACE_OP(REGS_SPILL(r));
+
+                        r.pc++;
+                        cycles_this_scanline += machine_code[op_code].cycles;
+
+                        STATS_OP(0, op_code);
+                        STATS_MODE(ADDR_RELATIVE);
+
+                        branch(&r, op_code, 0, get_eff_addr(&r, ADDR_RELATIVE));
+                    }
+                }
+                else if ( (CPU_FUSION & FUSE_STORE) && ((op_code & 0xcf) == fuse_op) && (op_code & 0x30) )
+                {
+                    TRACE_OP(REGS_SPILL(r));
+
+                    r.pc++;
+                    cycles_this_scanline += machine_code[op_code].cycles;
+
+                    STATS_OP(0, op_code);
+                    STATS_MODE(machine_code[op_code].mode);
+
+                    eff_addr = get_eff_addr(&r, machine_code[op_code].mode);
+
+                    /* The register is read after the effective address
+                     * so STX ,X++ still stores the incremented X.
+                     */
+                    if ( fuse_op & 0x08 )
+                    {
+                        operand16 = (fuse_op == FUSE_STD) ? d : ((fuse_op == FUSE_STX) ? cpu.x : cpu.u);
+                        mem_write(eff_addr, GET_REG_HIGH(operand16));
+                        mem_write((eff_addr + 1) & 0xffff, GET_REG_LOW(operand16));
+                        eval_cc_z16(operand16);
+                        eval_cc_n16(operand16);
+                        cc.v = CC_FLAG_CLR;
+                    }
+                    else
+                    {
+                        operand8 = (fuse_op == FUSE_STA) ? cpu.a : cpu.b;
+                        mem_write(eff_addr, operand8);
+                        tst(operand8);
+                    }
+                }
+            }
         }
 
         if (cycles_this_scanline >= cycles_per_line)
         {
             cycles_this_scanline -= cycles_per_line;
+            TRACE_LINE(cycles_per_line);
             break;
         }
     }
+
+    REGS_SPILL(r);
 }
 
 /*------------------------------------------------
@@ -1417,10 +1650,7 @@ inline __attribute__((always_inline)) uint8_t adc(uint8_t acc, uint8_t byte)
     uint8_t addend = (uint8_t)(byte + cc.c);
     result = (acc + addend);
 
-    eval_cc_c(result);
-    eval_cc_z(result);
-    eval_cc_n(result);
-    eval_cc_v(acc, addend, result);
+    cc.cvzn = cc_nzc[result] | CC_V8(acc, addend, result);
     eval_cc_h(acc, addend, result);
 
     return (uint8_t) result;
@@ -1439,10 +1669,7 @@ inline __attribute__((always_inline)) uint8_t add(uint8_t acc, uint8_t byte)
 
     result = (acc + byte);
 
-    eval_cc_c(result);
-    eval_cc_z(result);
-    eval_cc_n(result);
-    eval_cc_v(acc, byte, result);
+    cc.cvzn = cc_nzc[result] | CC_V8(acc, byte, result);
     eval_cc_h(acc, byte, result);
 
     return (uint8_t) result;
@@ -1484,9 +1711,7 @@ inline __attribute__((always_inline)) uint8_t and(uint8_t acc, uint8_t byte)
 
     result = (acc & byte);
 
-    eval_cc_z((uint16_t) result);
-    eval_cc_n((uint16_t) result);
-    cc.v = CC_FLAG_CLR;
+    cc.cvzn = cc_nzc[result] | cc.c;
 
     return result;
 }
@@ -1519,10 +1744,7 @@ inline __attribute__((always_inline)) uint8_t asl(uint8_t byte)
 
     result = ((uint16_t) byte) << 1;
 
-    eval_cc_c(result);
-    eval_cc_z(result);
-    eval_cc_n(result);
-    eval_cc_v(byte, byte, result);
+    cc.cvzn = cc_nzc[result] | CC_V8(byte, byte, result);
 
     return (uint8_t) result;
 }
@@ -1540,9 +1762,7 @@ inline __attribute__((always_inline)) uint8_t asr(uint8_t byte)
 
     result = (byte >> 1) | (byte & 0x80);
 
-    cc.c = byte & 0x01 ? CC_FLAG_SET : CC_FLAG_CLR;
-    eval_cc_z((uint16_t) result);
-    eval_cc_n((uint16_t) result);
+    cc.cvzn = cc_nzc[result] | (cc.cvzn & CC_V_BYTE) | (byte & 0x01);
 
     return result;
 }
@@ -1562,9 +1782,7 @@ inline __attribute__((always_inline))  void bit(uint8_t acc, uint8_t byte)
 
     result = acc & byte;
 
-    eval_cc_z((uint16_t) result);
-    eval_cc_n((uint16_t) result);
-    cc.v = CC_FLAG_CLR;
+    cc.cvzn = cc_nzc[result] | cc.c;
 }
 
 /*------------------------------------------------
@@ -1576,10 +1794,7 @@ inline __attribute__((always_inline))  void bit(uint8_t acc, uint8_t byte)
  */
 inline __attribute__((always_inline)) uint8_t clr(void)
 {
-    cc.c = CC_FLAG_CLR;
-    cc.v = CC_FLAG_CLR;
-    cc.z = CC_FLAG_SET;
-    cc.n = CC_FLAG_CLR;
+    cc.cvzn = cc_nzc[0];
 
     return 0;
 }
@@ -1598,10 +1813,7 @@ inline __attribute__((always_inline))  void cmp(uint8_t arg, uint8_t byte)
 
     result = arg - byte;
 
-    eval_cc_c(result);
-    eval_cc_z(result);
-    eval_cc_n(result);
-    eval_cc_v(arg, ~byte, result);
+    cc.cvzn = cc_nzc[result & 0x1ff] | CC_V8(arg, (uint8_t) ~byte, result);
 }
 
 /*------------------------------------------------
@@ -1637,10 +1849,7 @@ inline __attribute__((always_inline)) uint8_t com(uint8_t byte)
 
     result = ~byte;
 
-    cc.c = CC_FLAG_SET;
-    cc.v = CC_FLAG_CLR;
-    eval_cc_z((uint16_t) result);
-    eval_cc_n((uint16_t) result);
+    cc.cvzn = cc_nzc[result] | CC_C_BYTE;
 
     return result;
 }
@@ -1722,15 +1931,13 @@ inline __attribute__((always_inline)) void daa(void)
  */
 inline __attribute__((always_inline)) uint8_t dec(uint8_t byte)
 {
-    uint16_t result;
+    uint8_t result;
 
     result = byte - 1;
 
-    eval_cc_v(byte, 0xfe, result);
-    eval_cc_z(result);
-    eval_cc_n(result);
+    cc.cvzn = cc_nzc[result] | CC_V8(byte, 0xfe, result) | cc.c;
 
-    return (uint8_t) result;
+    return result;
 }
 
 /*------------------------------------------------
@@ -1746,9 +1953,7 @@ inline __attribute__((always_inline)) uint8_t eor(uint8_t acc, uint8_t byte)
 
     result = acc ^ byte;
 
-    eval_cc_z((uint16_t) result);
-    eval_cc_n((uint16_t) result);
-    cc.v = CC_FLAG_CLR;
+    cc.cvzn = cc_nzc[result] | cc.c;
 
     return result;
 }
@@ -1764,7 +1969,7 @@ inline __attribute__((always_inline)) uint8_t eor(uint8_t acc, uint8_t byte)
  *  Check: if (((regs ^ (regs << 4)) & 0x80) == 0) {...}
  *
  */
-inline __attribute__((always_inline)) void exg(uint8_t regs)
+inline __attribute__((always_inline)) void exg(cpu_regs_t *r, uint8_t regs)
 {
     int         src, dst;
     uint16_t    temp1, temp2;
@@ -1777,11 +1982,11 @@ inline __attribute__((always_inline)) void exg(uint8_t regs)
         // 8-bit to 16-bit register mismatch... in theory, assembler shouldn't allow but 6809 will allow odd behavior here...
     }
 
-    temp1 = read_register(src);
-    temp2 = read_register(dst);
+    temp1 = read_register(r, src);
+    temp2 = read_register(r, dst);
 
-    write_register(dst, temp1);
-    write_register(src, temp2);
+    write_register(r, dst, temp1);
+    write_register(r, src, temp2);
 }
 
 /*------------------------------------------------
@@ -1793,15 +1998,13 @@ inline __attribute__((always_inline)) void exg(uint8_t regs)
  */
 inline __attribute__((always_inline)) uint8_t inc(uint8_t byte)
 {
-    uint16_t result;
+    uint8_t result;
 
     result = byte + 1;
 
-    eval_cc_v(byte, 1, result);
-    eval_cc_z(result);
-    eval_cc_n(result);
+    cc.cvzn = cc_nzc[result] | CC_V8(byte, 1, result) | cc.c;
 
-    return (uint8_t) result;
+    return result;
 }
 
 /*------------------------------------------------
@@ -1817,9 +2020,7 @@ inline __attribute__((always_inline)) uint8_t lsr(uint8_t byte)
 
     result = (byte >> 1) & 0x7f;
 
-    cc.c = byte & 0x01 ? CC_FLAG_SET : CC_FLAG_CLR;
-    eval_cc_z((uint16_t) result);
-    cc.n = CC_FLAG_CLR;
+    cc.cvzn = cc_nzc[result] | (cc.cvzn & CC_V_BYTE) | (byte & 0x01);
 
     return result;
 }
@@ -1837,10 +2038,7 @@ inline __attribute__((always_inline)) uint8_t neg(uint8_t byte)
 
     result =  0 - byte;
 
-    eval_cc_c(result);
-    eval_cc_z(result);
-    eval_cc_n(result);
-    eval_cc_v(0, ~byte, result);
+    cc.cvzn = cc_nzc[result & 0x1ff] | CC_V8(0, (uint8_t) ~byte, result);
 
     return (uint8_t) result;
 }
@@ -1857,9 +2055,7 @@ inline __attribute__((always_inline)) uint8_t or(uint8_t acc, uint8_t byte)
 
     result = acc | byte;
 
-    cc.v = CC_FLAG_CLR;
-    eval_cc_z((uint16_t) result);
-    eval_cc_n((uint16_t) result);
+    cc.cvzn = cc_nzc[result] | cc.c;
 
     return result;
 }
@@ -2157,17 +2353,9 @@ inline __attribute__((always_inline)) uint8_t rol(uint8_t byte)
 {
     uint16_t    result;
 
-    result = (byte << 1);
-
-    if ( cc.c )
-        result |= 0x0001;
-    else
-        result &= 0xfffe;
+    result = (byte << 1) | cc.c;
 
-    eval_cc_c(result);
-    eval_cc_v(byte, byte, result);
-    eval_cc_z(result);
-    eval_cc_n(result);
+    cc.cvzn = cc_nzc[result] | CC_V8(byte, byte, result);
 
     return (uint8_t) result;
 }
@@ -2180,27 +2368,13 @@ inline __attribute__((always_inline)) uint8_t rol(uint8_t byte)
  */
 inline __attribute__((always_inline)) uint8_t ror(uint8_t byte)
 {
-    uint16_t    result;
-
-
-    result = byte;
-
-    if ( cc.c )
-        result |= 0x0100;
-    else
-        result &= 0xfeff;
-
-    if ( byte & 0x01 )
-        cc.c = CC_FLAG_SET;
-    else
-        cc.c = CC_FLAG_CLR;
+    uint8_t     result;
 
-    result = (result >> 1);
+    result = (byte >> 1) | (cc.c << 7);
 
-    eval_cc_z(result);
-    eval_cc_n(result);
+    cc.cvzn = cc_nzc[result] | (cc.cvzn & CC_V_BYTE) | (byte & 0x01);
 
-    return (uint8_t) result;
+    return result;
 }
 
 /*------------------------------------------------
@@ -2262,10 +2436,7 @@ inline __attribute__((always_inline)) uint8_t sbc(uint8_t acc, uint8_t byte)
      */
     uint8_t subtrahend = (uint8_t)(~byte + (1 - cc.c));
 
-    eval_cc_c(result);
-    eval_cc_z(result);
-    eval_cc_n(result);
-    eval_cc_v(acc, subtrahend, result);
+    cc.cvzn = cc_nzc[result & 0x1ff] | CC_V8(acc, subtrahend, result);
 
     return (uint8_t) result;
 }
@@ -2300,10 +2471,7 @@ inline __attribute__((always_inline)) uint8_t sub(uint8_t acc, uint8_t byte)
 
     result = acc - byte;
 
-    eval_cc_c(result);
-    eval_cc_z(result);
-    eval_cc_n(result);
-    eval_cc_v(acc, ~byte, result);
+    cc.cvzn = cc_nzc[result & 0x1ff] | CC_V8(acc, (uint8_t) ~byte, result);
 
     return (uint8_t) result;
 }
@@ -2391,7 +2559,7 @@ void swi(int swi_id)
  *  Check: if (((regs ^ (regs << 4)) & 0x80) == 0) {...}
  *
  */
-void tfr(uint8_t regs)
+inline __attribute__((always_inline)) void tfr(cpu_regs_t *r, uint8_t regs)
 {
     int         src, dst;
     uint16_t    temp1;
@@ -2404,8 +2572,8 @@ void tfr(uint8_t regs)
         // 8-bit to 16-bit register mismatch... in theory, assembler shouldn't allow but 6809 will allow odd behavior here...
     }
     
-    temp1 = read_register(src);
-    write_register(dst, temp1);
+    temp1 = read_register(r, src);
+    write_register(r, dst, temp1);
 }
 
 /*------------------------------------------------
@@ -2416,9 +2584,7 @@ void tfr(uint8_t regs)
  */
 void inline __attribute__((always_inline)) tst(uint8_t byte)
 {
-    eval_cc_z((uint16_t) byte);
-    eval_cc_n((uint16_t) byte);
-    cc.v = CC_FLAG_CLR;
+    cc.cvzn = cc_nzc[byte] | cc.c;
 }
 
 /*------------------------------------------------
@@ -2431,9 +2597,9 @@ void inline __attribute__((always_inline)) tst(uint8_t byte)
  *          pointer to opcode cycles.
  *  return: Nothing
  */
-void inline __attribute__((always_inline)) do_branch(int long_short, uint16_t effective_address)
+void inline __attribute__((always_inline)) do_branch(cpu_regs_t *r, int long_short, uint16_t effective_address)
 {
-    cpu.pc = effective_address;
+    r->pc = effective_address;
     cycles_this_scanline += long_short;
 }
 
@@ -2453,7 +2619,7 @@ void inline __attribute__((always_inline)) do_branch(int long_short, uint16_t ef
  *          pointer to opcode cycles.
  *  return: Nothing
  */
-void inline __attribute__((always_inline)) branch(int instruction, int long_short, uint16_t effective_address)
+void inline __attribute__((always_inline)) branch(cpu_regs_t *r, int instruction, int long_short, uint16_t effective_address)
 {
     /* Parse the branch condition and apply
        offset if branch is taken.
@@ -2464,98 +2630,98 @@ void inline __attribute__((always_inline)) branch(int instruction, int long_shor
          */
         case 0x22:
             if ( cc.c == CC_FLAG_CLR && cc.z == CC_FLAG_CLR )
-                do_branch(long_short, effective_address);
+                do_branch(r, long_short, effective_address);
             break;
 
         /* BLS / LBLS
          */
         case 0x23:
             if ( cc.c == CC_FLAG_SET || cc.z == CC_FLAG_SET )
-                do_branch(long_short, effective_address);
+                do_branch(r, long_short, effective_address);
             break;
 
         /* BHS / LBHS / BCC / LBCC
          */
         case 0x24:
             if ( cc.c == CC_FLAG_CLR )
-                do_branch(long_short, effective_address);
+                do_branch(r, long_short, effective_address);
             break;
 
         /* BLO / LBLO / BCS / LBCS
          */
         case 0x25:
             if ( cc.c == CC_FLAG_SET )
-                do_branch(long_short, effective_address);
+                do_branch(r, long_short, effective_address);
             break;
 
         /* BNE / LBNE
          */
         case 0x26:
             if ( cc.z == CC_FLAG_CLR )
-                do_branch(long_short, effective_address);
+                do_branch(r, long_short, effective_address);
             break;
 
         /* BEQ / LBEQ
          */
         case 0x27:
             if ( cc.z == CC_FLAG_SET )
-                do_branch(long_short, effective_address);
+                do_branch(r, long_short, effective_address);
             break;
 
         /* BVC / LBVC
          */
         case 0x28:
             if ( cc.v == CC_FLAG_CLR )
-                do_branch(long_short, effective_address);
+                do_branch(r, long_short, effective_address);
             break;
 
         /* BVS / LBVS
          */
         case 0x29:
             if ( cc.v == CC_FLAG_SET )
-                do_branch(long_short, effective_address);
+                do_branch(r, long_short, effective_address);
             break;
 
         /* BPL / LBPL
          */
         case 0x2a:
             if ( cc.n == CC_FLAG_CLR )
-                do_branch(long_short, effective_address);
+                do_branch(r, long_short, effective_address);
             break;
 
         /* BMI / LBMI
          */
         case 0x2b:
             if ( cc.n == CC_FLAG_SET )
-                do_branch(long_short, effective_address);
+                do_branch(r, long_short, effective_address);
             break;
 
         /* BGE / LBGE
          */
         case 0x2c:
             if ( cc.n == cc.v )
-                do_branch(long_short, effective_address);
+                do_branch(r, long_short, effective_address);
             break;
 
         /* BLT / LBLT
          */
         case 0x2d:
             if ( cc.n != cc.v )
-                do_branch(long_short, effective_address);
+                do_branch(r, long_short, effective_address);
             break;
 
         /* BGT / LBGT
          */
         case 0x2e:
             if ( cc.n == cc.v && cc.z == CC_FLAG_CLR )
-                do_branch(long_short, effective_address);
+                do_branch(r, long_short, effective_address);
             break;
 
         /* BLE / LBLE
          */
         case 0x2f:
             if ( cc.n != cc.v || cc.z == CC_FLAG_SET )
-                do_branch(long_short, effective_address);
+                do_branch(r, long_short, effective_address);
             break;
 
         /* Exception: Illegal branch code branch()
@@ -2568,6 +2734,64 @@ void inline __attribute__((always_inline)) branch(int instruction, int long_shor
     }
 }
 
+/*------------------------------------------------
+ * fuse_ready()
+ *
+ *  cpu_run() runs some op-code pairs back to back - a
+ *  compare, test or count followed by a short conditional
+ *  branch (the back edge of nearly every delay, copy and
+ *  search loop) and a load followed by a store of the same
+ *  register. The second op-code skips the trip around the
+ *  loop, which only matches running them one at a time if
+ *  nothing would have happened at the top of the loop in
+ *  between: there is still time left on this scanline, no
+ *  interrupt line is up (the first op-code may have just
+ *  raised one with an IO access) and the CPU is still
+ *  executing (the disk controller may have asserted HALT).
+ *  A running trace still gets a record for the second
+ *  op-code - it is taken just before it runs.
+ *
+ *  param:  Cycles in this scanline
+ *  return: Non-zero if the next op-code may be fused
+ */
+inline __attribute__((always_inline)) int fuse_ready(int cycles_per_line)
+{
+    return CPU_FUSION && (cycles_this_scanline < cycles_per_line) &&
+           !(cpu.irq_asserted | cpu.firq_asserted | cpu.nmi_latched) &&
+           (cpu.cpu_state == CPU_EXEC);
+}
+
+/*------------------------------------------------
+ * get_index_reg() / set_index_reg()
+ *
+ *  Read or write the index register selected by
+ *  bits 5 and 6 of an indexed addressing post-byte.
+ *
+ *  param:  Register select (0=X, 1=Y, 2=U, 3=S) and value to write.
+ *  return: Register content for get_index_reg()
+ */
+inline __attribute__((always_inline)) uint16_t get_index_reg(cpu_regs_t *r, int reg_select)
+{
+    switch ( reg_select )
+    {
+        case 0:  return cpu.x;
+        case 1:  return cpu.y;
+        case 2:  return cpu.u;
+        default: return r->s;
+    }
+}
+
+inline __attribute__((always_inline)) void set_index_reg(cpu_regs_t *r, int reg_select, uint16_t value)
+{
+    switch ( reg_select )
+    {
+        case 0:  cpu.x = value; break;
+        case 1:  cpu.y = value; break;
+        case 2:  cpu.u = value; break;
+        default: r->s = value; break;
+    }
+}
+
 /*------------------------------------------------
  * get_eff_addr()
  *
@@ -2578,7 +2802,7 @@ void inline __attribute__((always_inline)) branch(int instruction, int long_shor
  *  param:  Command op code and command cycles and bytes count to update if needed.
  *  return: Effective Address, '0' if error
  */
-inline __attribute__((always_inline)) int get_eff_addr(int mode)
+inline __attribute__((always_inline)) int get_eff_addr(cpu_regs_t *r, int mode)
 {
     uint16_t    operand;
     uint16_t    effective_addr = 0;
@@ -2586,168 +2810,144 @@ inline __attribute__((always_inline)) int get_eff_addr(int mode)
     switch ( mode )
     {
         case ADDR_DIRECT:
-            return ((cpu.dp << 8) + mem_read_pc(cpu.pc++));
+            return ((cpu.dp << 8) + mem_read_pc(r->pc++));
             break;
 
         case ADDR_RELATIVE:
-            operand = mem_read_pc(cpu.pc++);
-            return (cpu.pc + SIG_EXTEND(operand));
+            operand = mem_read_pc(r->pc++);
+            return (r->pc + SIG_EXTEND(operand));
             break;
 
         case ADDR_LRELATIVE:
-            operand = (mem_read_pc(cpu.pc++) << 8);
-            operand += mem_read_pc(cpu.pc++);
-            return (cpu.pc + operand);
+            operand = (mem_read_pc(r->pc++) << 8);
+            operand += mem_read_pc(r->pc++);
+            return (r->pc + operand);
             break;
 
         case ADDR_INDEXED:
             {
                 uint8_t    postbyte;
                 uint8_t    mode;
-                uint8_t    indirect;
                 uint8_t    reg_select;
+                uint16_t   index_reg;
 
-                postbyte = mem_read_pc(cpu.pc++);
-                mode = postbyte & INDX_POST_MODE;
-                indirect = (postbyte & INDX_POST_INDIRECT) ? 1 : 0;
-                reg_select = (uint8_t)((postbyte & INDX_POST_REG) >> 5);
-
-                uint16_t *index_reg = reg_lookup[reg_select];
-                
-                /* Check if 5-bit offset is in the post-byte
-                 * then process more index address bytes if not.
+                /* One table look-up gives the whole post-byte decode
+                 * and the extra cycles (see indexed_mode[] in mc6809e.h)
                  */
-                if ( postbyte & INDX_POST_5BIT_OFF )
-                {
-                    switch ( mode )
-                    {
-                        case 0: // EA = ,index+ Auto post-increment by 1
-                            effective_addr = *index_reg;
-                            (*index_reg) += 1;
-                            cycles_this_scanline += 2;
-                            break;
-
-                        case 1: // EA = ,index++ Auto post-increment by 2
-                            effective_addr = *index_reg;
-                            (*index_reg) += 2;
-                            cycles_this_scanline += indirect ? 6 : 3;
-                            break;
-
-                        case 2: // EA = ,-index Auto pre-decrement by 1
-                            (*index_reg) -= 1;
-                            effective_addr = *index_reg;
-                            cycles_this_scanline += 2;
-                            break;
-
-                        case 3: // EA = ,--index Auto pre-decrement by 2
-                            (*index_reg) -= 2;
-                            effective_addr = *index_reg;
-                            cycles_this_scanline += indirect ? 6 : 3;
-                            break;
-
-                        case 4: // EA = 0,index Zero offset
-                            effective_addr = *index_reg;
-                            cycles_this_scanline += indirect ? 3 : 0;
-                            break;
-
-                        case 5: // EA = B,index Acc-B with index
-                            effective_addr = *index_reg + SIG_EXTEND(cpu.b);
-                            cycles_this_scanline += indirect ? 4 : 1;
-                            break;
-
-                        case 6: // EA = A,index Acc-A with index
-                            effective_addr = *index_reg + SIG_EXTEND(cpu.a);
-                            cycles_this_scanline += indirect ? 4 : 1;
-                            break;
-
-                        case 8: // EA = 8-bit,index 8-bit offset
-                            effective_addr = SIG_EXTEND(mem_read(cpu.pc));
-                            cpu.pc++;
-                            effective_addr += *index_reg;
-                            cycles_this_scanline += indirect ? 4 : 1;
-                            break;
-
-                        case 9: // EA = 16-bit,index 16-bit offset
-                            effective_addr = (mem_read(cpu.pc) << 8);
-                            cpu.pc++;
-                            effective_addr += mem_read(cpu.pc);
-                            cpu.pc++;
-                            effective_addr += *index_reg;
-                            cycles_this_scanline += indirect ? 7 : 4;
-                            break;
+                postbyte = mem_read_pc(r->pc++);
+                mode = indexed_mode[postbyte].mode;
+                cycles_this_scanline += indexed_mode[postbyte].cycles;
 
-                        case 11: // EA = D,index Acc-D with index
-                            effective_addr = *index_reg + d;
-                            cycles_this_scanline += indirect ? 7 : 4;
-                            break;
-
-                        case 12: // EA = 8-bit,pc PC relative
-                            effective_addr = SIG_EXTEND(mem_read(cpu.pc));
-                            cpu.pc++;
-                            effective_addr += cpu.pc;
-                            cycles_this_scanline += indirect ? 4 : 1;
-                            break;
+                reg_select = (mode >> INDX_REG_SHIFT) & 0x03;
+                index_reg = get_index_reg(r, reg_select);
 
-                        case 13: // EA = 16-bit,pc PC relative
-                            effective_addr = (mem_read(cpu.pc) << 8);
-                            cpu.pc++;
-                            effective_addr += mem_read(cpu.pc);
-                            cpu.pc++;
-                            effective_addr += cpu.pc;
-                            cycles_this_scanline += indirect ? 8 : 5;
-                            break;
-
-                        case 15: // EA = [addr] Extended Indirect will always be indirect.
-                            effective_addr = (mem_read(cpu.pc) << 8);
-                            cpu.pc++;
-                            effective_addr += mem_read(cpu.pc);
-                            cpu.pc++;
-                            cycles_this_scanline += 5;
-                            break;
-
-                        default:
-                            /* Exception: Illegal indexing mode get_eff_addr()
-                             */
-                            cpu.cpu_state = CPU_EXCEPTION;
-                    }
-
-                    /* Resolve indirect addresses
-                     * Rely on assembler-generated code to reliably include the indirect bit
-                     * i.e. not for auto inc/dec by one.
-                     */
-                    if ( indirect )
-                    {
-                        effective_addr = (mem_read(effective_addr) << 8) + mem_read(effective_addr + 1);
-                    }
+                switch ( mode & INDX_KIND )
+                {
+                    case INDX_OFF5: // EA = 5-bit,index with the offset sign extended from the post-byte
+                        effective_addr = index_reg + (((postbyte & 0x1f) ^ 0x10) - 0x10);
+                        break;
+
+                    case INDX_ZERO: // EA = 0,index Zero offset
+                        effective_addr = index_reg;
+                        break;
+
+                    case INDX_INC1: // EA = ,index+ Auto post-increment by 1
+                        effective_addr = index_reg;
+                        set_index_reg(r, reg_select, index_reg + 1);
+                        break;
+
+                    case INDX_INC2: // EA = ,index++ Auto post-increment by 2
+                        effective_addr = index_reg;
+                        set_index_reg(r, reg_select, index_reg + 2);
+                        break;
+
+                    case INDX_DEC1: // EA = ,-index Auto pre-decrement by 1
+                        effective_addr = index_reg - 1;
+                        set_index_reg(r, reg_select, effective_addr);
+                        break;
+
+                    case INDX_DEC2: // EA = ,--index Auto pre-decrement by 2
+                        effective_addr = index_reg - 2;
+                        set_index_reg(r, reg_select, effective_addr);
+                        break;
+
+                    case INDX_ACCB: // EA = B,index Acc-B with index
+                        effective_addr = index_reg + SIG_EXTEND(cpu.b);
+                        break;
+
+                    case INDX_ACCA: // EA = A,index Acc-A with index
+                        effective_addr = index_reg + SIG_EXTEND(cpu.a);
+                        break;
+
+                    case INDX_OFF8: // EA = 8-bit,index 8-bit offset
+                        effective_addr = SIG_EXTEND(mem_read(r->pc));
+                        r->pc++;
+                        effective_addr += index_reg;
+                        break;
+
+                    case INDX_OFF16: // EA = 16-bit,index 16-bit offset
+                        effective_addr = (mem_read(r->pc) << 8);
+                        r->pc++;
+                        effective_addr += mem_read(r->pc);
+                        r->pc++;
+                        effective_addr += index_reg;
+                        break;
+
+                    case INDX_ACCD: // EA = D,index Acc-D with index
+                        effective_addr = index_reg + d;
+                        break;
+
+                    case INDX_PC8: // EA = 8-bit,pc PC relative
+                        effective_addr = SIG_EXTEND(mem_read(r->pc));
+                        r->pc++;
+                        effective_addr += r->pc;
+                        break;
+
+                    case INDX_PC16: // EA = 16-bit,pc PC relative
+                        effective_addr = (mem_read(r->pc) << 8);
+                        r->pc++;
+                        effective_addr += mem_read(r->pc);
+                        r->pc++;
+                        effective_addr += r->pc;
+                        break;
+
+                    case INDX_EXT: // EA = [addr] Extended Indirect will always be indirect.
+                        effective_addr = (mem_read(r->pc) << 8);
+                        r->pc++;
+                        effective_addr += mem_read(r->pc);
+                        r->pc++;
+                        break;
+
+                    default:
+                        /* Exception: Illegal indexing mode get_eff_addr()
+                         */
+                        cpu.cpu_state = CPU_EXCEPTION;
                 }
-                /* 5-bit offset is in the post-bytes
+
+                /* Resolve indirect addresses
+                 * Rely on assembler-generated code to reliably include the indirect bit
+                 * i.e. not for auto inc/dec by one.
                  */
-                else
+                if ( mode & INDX_INDIRECT )
                 {
-                    operand = postbyte & 0x001f;
-                    if ( operand & 0x0010 )
-                    {
-                        operand |= 0xfff0;  // Extend the sign of the 5-bit offset into 16-bit
-                    }
-                    effective_addr = *index_reg + operand;
-                    cycles_this_scanline++;
+                    effective_addr = (mem_read(effective_addr) << 8) + mem_read((effective_addr + 1) & 0xffff);
                 }
             }
             break;
 
         case ADDR_EXTENDED:
-            effective_addr = (mem_read_pc(cpu.pc++) << 8);
-            effective_addr += mem_read_pc(cpu.pc++);
+            effective_addr = (mem_read_pc(r->pc++) << 8);
+            effective_addr += mem_read_pc(r->pc++);
             break;
 
         case ADDR_IMMEDIATE:
-            effective_addr = cpu.pc;
-            cpu.pc += 1;
+            effective_addr = r->pc;
+            r->pc += 1;
             break;
 
         case ADDR_LIMMEDIATE:
-            effective_addr = cpu.pc;
-            cpu.pc += 2;
+            effective_addr = r->pc;
+            r->pc += 2;
             break;
 
         case ADDR_INHERENT:
@@ -2769,7 +2969,7 @@ inline __attribute__((always_inline)) int get_eff_addr(int mode)
  *  param:  Register number
  *  return: Register content as uint16_t for all registers
  */
-inline __attribute__((always_inline)) uint16_t read_register(int reg)
+inline __attribute__((always_inline)) uint16_t read_register(cpu_regs_t *r, int reg)
 {
     uint16_t    temp;
 
@@ -2792,11 +2992,11 @@ inline __attribute__((always_inline)) uint16_t read_register(int reg)
             break;
 
         case 4:
-            temp = cpu.s;
+            temp = r->s;
             break;
 
         case 5:
-            temp = cpu.pc;
+            temp = r->pc;
             break;
 
         case 8:
@@ -2834,7 +3034,7 @@ inline __attribute__((always_inline)) uint16_t read_register(int reg)
  *  param:  Register number and data to write into it.
  *  return: Nothing
  */
-void inline __attribute__((always_inline)) write_register(int reg, uint16_t data)
+void inline __attribute__((always_inline)) write_register(cpu_regs_t *r, int reg, uint16_t data)
 {
     switch ( reg )
     {
@@ -2856,12 +3056,12 @@ void inline __attribute__((always_inline)) write_register(int reg, uint16_t data
             break;
 
         case 4:
-            cpu.s = data;
+            r->s = data;
             cpu.nmi_armed = 1;
             break;
 
         case 5:
-            cpu.pc = data;
+            r->pc = data;
             break;
 
         case 8:
@@ -31,6 +31,7 @@ typedef enum
     CPU_EXEC        = 0,    // Normal state instruction execution
     CPU_HALTED      = 1,    // Is halted (for 'cwai')
     CPU_SYNC        = 2,    // Waiting in SYNC state (for 'sync' )
+    CPU_HALT_LINE   = 3,    // HALT line held low by external hardware (disk controller)
     CPU_RESET       = 4,    // Held in reset
     CPU_EXCEPTION   = 5,    // Signal an emulation exception (bad op-code)
 } cpu_run_state_t;
@@ -77,6 +78,9 @@ extern cpu_state_t cpu;
 #define     INT_FIRQ                4
 
 
+#define     CPU_CYCLES_PER_LINE             57
+#define     CPU_CYCLES_PER_LINE_OVERCLOCK   (CPU_CYCLES_PER_LINE * 2)
+
 extern int cycles_this_scanline;
 
 /********************************************************************
@@ -92,4 +96,8 @@ void cpu_irq(int state);
 void cpu_check_reset(void);
 void cpu_run(void);
 
+uint8_t cpu_get_cc(void);
+void    cpu_set_cc(uint8_t value);
+uint8_t cpu_op_cycles(int page, int op_code);
+
 #endif  /* __CPU_H__ */
@@ -0,0 +1,422 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#include <nds.h>
+
+#include <string.h>
+
+#include "cpu.h"
+#include "mem.h"
+#include "sam.h"
+#include "perf.h"
+#include "CRC32.h"
+
+#include "cpucheck.h"
+
+// ---------------------------------------------------------------------------------------
+// A self-check of the 6809 core that runs (along with the CRC benchmark) when a game is
+// launched with the debugger enabled - before the machine is set up so nothing here can
+// disturb the game. Three parts:
+//
+//  1) The cycle counts in the op-code tables are compared against the datasheet.
+//  2) A set of single instructions covering every addressing mode is executed, one at a
+//     time, and the registers, flags, memory and cycles taken are all checked. Then the
+//     op-code pairs cpu_run() fuses are run both ways - one instruction at a time and
+//     both in the same cpu_run() - and the two results must agree exactly.
+//  3) A synthetic mix of common instructions is run flat out and timed.
+//
+// Results are shown on the debugger overlay. Any CPU change should leave 1 and 2 clean
+// and ideally make 3 go up...
+// ---------------------------------------------------------------------------------------
+u16 cpucheck_table_errors = 0;
+u8  cpucheck_ops_passed   = 0;
+u8  cpucheck_ops_total    = 0;
+u8  cpucheck_first_fail   = 0xFF;
+u8  cpucheck_deviations   = 0;
+u32 cpucheck_kips         = 0;
+u32 cpucheck_speed        = 0;
+
+// ---------------------------------------------------------------------------------------
+// Base cycles from the Motorola MC6809E datasheet (DS9846-R2). Indexed is the base before
+// the post-byte adds its share. Zero is an undefined op-code (or a page prefix) and is
+// not checked.
+// ---------------------------------------------------------------------------------------
+static const u8 cpucheck_cycles_page0[256] =
+{
+    6, 0, 0, 6, 6, 0, 6, 6, 6, 6, 6, 0, 6, 6, 3, 6,     // 0x00 - direct read/modify/write
+    0, 0, 2, 4, 0, 0, 5, 9, 0, 2, 3, 0, 3, 2, 8, 6,     // 0x10 - misc
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,     // 0x20 - short branches
+    4, 4, 4, 4, 5, 5, 5, 5, 0, 5, 3, 6,20,11, 0,19,     // 0x30 - lea, stack, rts/rti/cwai/mul/swi
+    2, 0, 0, 2, 2, 0, 2, 2, 2, 2, 2, 0, 2, 2, 0, 2,     // 0x40 - inherent A
+    2, 0, 0, 2, 2, 0, 2, 2, 2, 2, 2, 0, 2, 2, 0, 2,     // 0x50 - inherent B
+    6, 0, 0, 6, 6, 0, 6, 6, 6, 6, 6, 0, 6, 6, 3, 6,     // 0x60 - indexed read/modify/write
+    7, 0, 0, 7, 7, 0, 7, 7, 7, 7, 7, 0, 7, 7, 4, 7,     // 0x70 - extended read/modify/write
+    2, 2, 2, 4, 2, 2, 2, 0, 2, 2, 2, 2, 4, 7, 3, 0,     // 0x80 - A immediate
+    4, 4, 4, 6, 4, 4, 4, 4, 4, 4, 4, 4, 6, 7, 5, 5,     // 0x90 - A direct
+    4, 4, 4, 6, 4, 4, 4, 4, 4, 4, 4, 4, 6, 7, 5, 5,     // 0xA0 - A indexed
+    5, 5, 5, 7, 5, 5, 5, 5, 5, 5, 5, 5, 7, 8, 6, 6,     // 0xB0 - A extended
+    2, 2, 2, 4, 2, 2, 2, 0, 2, 2, 2, 2, 3, 0, 3, 0,     // 0xC0 - B immediate
+    4, 4, 4, 6, 4, 4, 4, 4, 4, 4, 4, 4, 5, 5, 5, 5,     // 0xD0 - B direct
+    4, 4, 4, 6, 4, 4, 4, 4, 4, 4, 4, 4, 5, 5, 5, 5,     // 0xE0 - B indexed
+    5, 5, 5, 7, 5, 5, 5, 5, 5, 5, 5, 5, 6, 6, 6, 6,     // 0xF0 - B extended
+};
+
+// The prefixed pages are sparse - op-code and cycles (long branches add 1 when taken)
+static const u8 cpucheck_cycles_page10[][2] =
+{
+    {0x21,5}, {0x22,5}, {0x23,5}, {0x24,5}, {0x25,5}, {0x26,5}, {0x27,5}, {0x28,5},
+    {0x29,5}, {0x2a,5}, {0x2b,5}, {0x2c,5}, {0x2d,5}, {0x2e,5}, {0x2f,5}, {0x3f,20},
+    {0x83,5}, {0x8c,5}, {0x8e,4}, {0x93,7}, {0x9c,7}, {0x9e,6}, {0x9f,6}, {0xa3,7},
+    {0xac,7}, {0xae,6}, {0xaf,6}, {0xb3,8}, {0xbc,8}, {0xbe,7}, {0xbf,7}, {0xce,4},
+    {0xde,6}, {0xdf,6}, {0xee,6}, {0xef,6}, {0xfe,7}, {0xff,7},
+};
+
+static const u8 cpucheck_cycles_page11[][2] =
+{
+    {0x3f,20}, {0x83,5}, {0x8c,5}, {0x93,7}, {0x9c,7}, {0xa3,7}, {0xac,7}, {0xb3,8}, {0xbc,8},
+};
+
+static void cpucheck_tables(void)
+{
+    cpucheck_table_errors = 0;
+
+    for (u16 op=0; op<256; op++)
+    {
+        if (cpucheck_cycles_page0[op] && (cpu_op_cycles(0, op) != cpucheck_cycles_page0[op])) cpucheck_table_errors++;
+    }
+
+    for (u8 i=0; i<sizeof(cpucheck_cycles_page10)/2; i++)
+    {
+        if (cpu_op_cycles(0x10, cpucheck_cycles_page10[i][0]) != cpucheck_cycles_page10[i][1]) cpucheck_table_errors++;
+    }
+
+    for (u8 i=0; i<sizeof(cpucheck_cycles_page11)/2; i++)
+    {
+        if (cpu_op_cycles(0x11, cpucheck_cycles_page11[i][0]) != cpucheck_cycles_page11[i][1]) cpucheck_table_errors++;
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// Single instruction tests. Every test starts at CPUCHECK_ORG with S at CPUCHECK_STACK and
+// DP at $20. Registers not listed in the 'before' are zero. If mem_addr is set that byte
+// is primed with mem_in beforehand and must hold mem_out afterwards. Everything in the
+// 'after' must match exactly, including the PC and the cycles taken.
+//
+// A test marked 'known' holds the datasheet result for something the core deliberately
+// does differently. It is kept out of the pass count and reported as a deviation until
+// the core matches it.
+// ---------------------------------------------------------------------------------------
+typedef struct
+{
+    u8  code[4];
+    u8  a, b, cc;
+    u16 x, y, u, s;
+    u16 mem_addr;
+    u8  mem_in, mem_out;
+    u8  ra, rb, rcc;
+    u16 rx, ry, ru, rs, rpc;
+    u8  cycles;
+    u8  known;
+} cpucheck_op_t;
+
+#define CC_NONE     0x00
+#define CC_C        0x01
+#define CC_V        0x02
+#define CC_Z        0x04
+#define CC_N        0x08
+#define CC_H        0x20
+
+#define S0          CPUCHECK_STACK
+#define PC(n)       (CPUCHECK_ORG + (n))
+
+static const cpucheck_op_t cpucheck_ops[] =
+{
+    //  code                     A     B     CC        X       Y       U       S       mem     in    out     A     B     CC              X       Y       U       S         PC         cycles
+    {{0x86,0x80},                0x00, 0x00, CC_NONE,  0x0000, 0x0000, 0x0000, S0,     0x0000, 0x00, 0x00,   0x80, 0x00, CC_N,           0x0000, 0x0000, 0x0000, S0,       PC(2),     2},  // LDA #$80
+    {{0x8B,0x01},                0x7F, 0x00, CC_NONE,  0x0000, 0x0000, 0x0000, S0,     0x0000, 0x00, 0x00,   0x80, 0x00, CC_H|CC_N|CC_V, 0x0000, 0x0000, 0x0000, S0,       PC(2),     2},  // ADDA #$01
+    {{0x80,0x01},                0x00, 0x00, CC_NONE,  0x0000, 0x0000, 0x0000, S0,     0x0000, 0x00, 0x00,   0xFF, 0x00, CC_N|CC_C,      0x0000, 0x0000, 0x0000, S0,       PC(2),     2},  // SUBA #$01
+    {{0xCC,0x12,0x34},           0x00, 0x00, CC_NONE,  0x0000, 0x0000, 0x0000, S0,     0x0000, 0x00, 0x00,   0x12, 0x34, CC_NONE,        0x0000, 0x0000, 0x0000, S0,       PC(3),     3},  // LDD #$1234
+    {{0x83,0x00,0x01},           0x00, 0x00, CC_NONE,  0x0000, 0x0000, 0x0000, S0,     0x0000, 0x00, 0x00,   0xFF, 0xFF, CC_N|CC_C,      0x0000, 0x0000, 0x0000, S0,       PC(3),     4},  // SUBD #$0001
+    {{0x8C,0x21,0x00},           0x00, 0x00, CC_NONE,  0x2100, 0x0000, 0x0000, S0,     0x0000, 0x00, 0x00,   0x00, 0x00, CC_Z,           0x2100, 0x0000, 0x0000, S0,       PC(3),     4},  // CMPX #$2100
+    {{0x97,0x10},                0x00, 0x00, CC_NONE,  0x0000, 0x0000, 0x0000, S0,     0x2010, 0xFF, 0x00,   0x00, 0x00, CC_Z,           0x0000, 0x0000, 0x0000, S0,       PC(2),     4},  // STA <$10
+    {{0x00,0x30},                0x00, 0x00, CC_NONE,  0x0000, 0x0000, 0x0000, S0,     0x2030, 0x01, 0xFF,   0x00, 0x00, CC_N|CC_C,      0x0000, 0x0000, 0x0000, S0,       PC(2),     6},  // NEG <$30
+    {{0x7C,0x24,0x00},           0x00, 0x00, CC_NONE,  0x0000, 0x0000, 0x0000, S0,     0x2400, 0x7F, 0x80,   0x00, 0x00, CC_N|CC_V,      0x0000, 0x0000, 0x0000, S0,       PC(3),     7},  // INC $2400
+    {{0xA6,0x80},                0x00, 0x00, CC_NONE,  0x2100, 0x0000, 0x0000, S0,     0x2100, 0x42, 0x42,   0x42, 0x00, CC_NONE,        0x2101, 0x0000, 0x0000, S0,       PC(2),     6},  // LDA ,X+
+    {{0x64,0x84},                0x00, 0x00, CC_NONE,  0x2100, 0x0000, 0x0000, S0,     0x2100, 0x03, 0x01,   0x00, 0x00, CC_C,           0x2100, 0x0000, 0x0000, S0,       PC(2),     6},  // LSR ,X
+    {{0x30,0x05},                0x00, 0x00, CC_NONE,  0x2100, 0x0000, 0x0000, S0,     0x0000, 0x00, 0x00,   0x00, 0x00, CC_NONE,        0x2105, 0x0000, 0x0000, S0,       PC(2),     5},  // LEAX 5,X
+    {{0xA6,0x89,0x01,0x2C},      0x00, 0x00, CC_NONE,  0x2000, 0x0000, 0x0000, S0,     0x212C, 0x77, 0x77,   0x77, 0x00, CC_NONE,        0x2000, 0x0000, 0x0000, S0,       PC(4),     8},  // LDA $012C,X
+    {{0xAD,0x84},                0x00, 0x00, CC_NONE,  0x2500, 0x0000, 0x0000, S0,     S0-2,   0x00, 0x10,   0x00, 0x00, CC_NONE,        0x2500, 0x0000, 0x0000, S0-2,     0x2500,    7},  // JSR ,X
+    {{0x34,0x16},                0x11, 0x22, CC_NONE,  0x3344, 0x0000, 0x0000, S0,     S0-4,   0x00, 0x11,   0x11, 0x22, CC_NONE,        0x3344, 0x0000, 0x0000, S0-4,     PC(2),     9, 1},  // PSHS A,B,X (known)
+    {{0x47},                     0x81, 0x00, CC_NONE,  0x0000, 0x0000, 0x0000, S0,     0x0000, 0x00, 0x00,   0xC0, 0x00, CC_N|CC_C,      0x0000, 0x0000, 0x0000, S0,       PC(1),     2},  // ASRA
+    {{0x49},                     0x80, 0x00, CC_NONE,  0x0000, 0x0000, 0x0000, S0,     0x0000, 0x00, 0x00,   0x00, 0x00, CC_Z|CC_V|CC_C, 0x0000, 0x0000, 0x0000, S0,       PC(1),     2},  // ROLA
+    {{0x1D},                     0x00, 0x80, CC_NONE,  0x0000, 0x0000, 0x0000, S0,     0x0000, 0x00, 0x00,   0xFF, 0x80, CC_N,           0x0000, 0x0000, 0x0000, S0,       PC(1),     2},  // SEX
+    {{0x19},                     0x0A, 0x00, CC_NONE,  0x0000, 0x0000, 0x0000, S0,     0x0000, 0x00, 0x00,   0x10, 0x00, CC_NONE,        0x0000, 0x0000, 0x0000, S0,       PC(1),     2},  // DAA
+    {{0x3D},                     0x10, 0x10, CC_NONE,  0x0000, 0x0000, 0x0000, S0,     0x0000, 0x00, 0x00,   0x01, 0x00, CC_NONE,        0x0000, 0x0000, 0x0000, S0,       PC(1),    11},  // MUL
+    {{0x1F,0x89},                0x5A, 0x00, CC_NONE,  0x0000, 0x0000, 0x0000, S0,     0x0000, 0x00, 0x00,   0x5A, 0x5A, CC_NONE,        0x0000, 0x0000, 0x0000, S0,       PC(2),     6},  // TFR A,B
+    {{0x26,0x02},                0x00, 0x00, CC_NONE,  0x0000, 0x0000, 0x0000, S0,     0x0000, 0x00, 0x00,   0x00, 0x00, CC_NONE,        0x0000, 0x0000, 0x0000, S0,       PC(4),     3},  // BNE (taken)
+    {{0x10,0x27,0x00,0x10},      0x00, 0x00, CC_Z,     0x0000, 0x0000, 0x0000, S0,     0x0000, 0x00, 0x00,   0x00, 0x00, CC_Z,           0x0000, 0x0000, 0x0000, S0,       PC(0x14),  6},  // LBEQ (taken)
+    {{0x10,0x27,0x00,0x10},      0x00, 0x00, CC_NONE,  0x0000, 0x0000, 0x0000, S0,     0x0000, 0x00, 0x00,   0x00, 0x00, CC_NONE,        0x0000, 0x0000, 0x0000, S0,       PC(4),     5},  // LBEQ (not taken)
+    {{0x10,0x8E,0xAB,0xCD},      0x00, 0x00, CC_NONE,  0x0000, 0x0000, 0x0000, S0,     0x0000, 0x00, 0x00,   0x00, 0x00, CC_N,           0x0000, 0xABCD, 0x0000, S0,       PC(4),     4},  // LDY #$ABCD
+    {{0x11,0x83,0x00,0x00},      0x00, 0x00, CC_NONE,  0x0000, 0x0000, 0x0000, S0,     0x0000, 0x00, 0x00,   0x00, 0x00, CC_Z,           0x0000, 0x0000, 0x0000, S0,       PC(4),     5},  // CMPU #$0000
+};
+
+#define CPUCHECK_NUM_OPS    (sizeof(cpucheck_ops) / sizeof(cpucheck_ops[0]))
+
+// Note: the datasheet has PSHS A,B,X at 9 cycles (5 + 1 per byte pushed). The core has always
+// charged 1 + 1 per 16-bit register (7 here) and games have been tuned against that, so it
+// stays a known deviation rather than a failure.
+
+// Run exactly one instruction - cpu_run() returns as soon as the scanline budget is used
+static u8 cpucheck_step(void)
+{
+    cycles_this_scanline = CPU_CYCLES_PER_LINE - 1;
+    cpu_run();
+    return cycles_this_scanline + 1;
+}
+
+static u8 cpucheck_one(const cpucheck_op_t *t)
+{
+    memcpy(&memory_RAM[CPUCHECK_ORG], t->code, sizeof(t->code));
+    if (t->mem_addr) memory_RAM[t->mem_addr] = t->mem_in;
+
+    cpu.a = t->a;   cpu.b = t->b;
+    cpu.x = t->x;   cpu.y = t->y;
+    cpu.u = t->u;   cpu.s = t->s;
+    cpu.dp = 0x20;
+    cpu.pc = CPUCHECK_ORG;
+    cpu_set_cc(t->cc);
+
+    u8 cycles = cpucheck_step();
+
+    if ((cpu.a != t->ra) || (cpu.b != t->rb) || (cpu_get_cc() != t->rcc)) return 0;
+    if ((cpu.x != t->rx) || (cpu.y != t->ry) || (cpu.u != t->ru) || (cpu.s != t->rs)) return 0;
+    if ((cpu.pc != t->rpc) || (cpu.cpu_state != CPU_EXEC) || (cycles != t->cycles)) return 0;
+    if (t->mem_addr && (memory_RAM[t->mem_addr] != t->mem_out)) return 0;
+
+    return 1;
+}
+
+// ---------------------------------------------------------------------------------------
+// Fused pair tests. Each pair is run twice from the same start: first one instruction at
+// a time (so nothing can be fused) and then with a scanline budget that leaves one cycle
+// after the first instruction, so cpu_run() executes exactly two - fused if it can, with
+// a trip around the interrupt checks if it can't. Registers, flags, the data/stack page,
+// the IO port and the cycles taken must all come out the same. Registers not listed are
+// zero and CC starts with interrupts unmasked.
+//
+// The IO port at $FF20 raises an IRQ on any write. The IRQ vector points at a NOP so the
+// unfused run takes the interrupt between the two instructions and runs that instead.
+// ---------------------------------------------------------------------------------------
+#define CPUCHECK_IRQ_PORT       0xFF20
+#define CPUCHECK_VEC_IRQ        0xFFF8
+#define CPUCHECK_IRQ_VECTOR     (CPUCHECK_ORG + 0x80)
+
+typedef struct
+{
+    u8  code[6];
+    u8  a, b;
+    u16 x, y;
+    u16 mem_addr;
+    u8  mem_in;
+} cpucheck_pair_t;
+
+static const cpucheck_pair_t cpucheck_pairs[] =
+{
+    //  code                                A     B     X       Y       mem     in
+    {{0xA6,0x80,0x97,0x40},                 0x00, 0x00, 0x2100, 0x0000, 0x2100, 0x42},    // LDA ,X+   / STA <$40
+    {{0x8E,0x12,0x34,0xAF,0xA1},            0x00, 0x00, 0x0000, 0x2200, 0x0000, 0x00},    // LDX #$1234 / STX ,Y++
+    {{0x8C,0x21,0x10,0x26,0xF3},            0x00, 0x00, 0x2105, 0x0000, 0x0000, 0x00},    // CMPX #$2110 / BNE (taken)
+    {{0x8C,0x21,0x10,0x26,0xF3},            0x00, 0x00, 0x2110, 0x0000, 0x0000, 0x00},    // CMPX #$2110 / BNE (not taken)
+    {{0x5A,0x26,0xFD},                      0x00, 0x02, 0x0000, 0x0000, 0x0000, 0x00},    // DECB / BNE (taken)
+    {{0x86,0x01,0xB7,0xFF,0x20},            0x00, 0x00, 0x0000, 0x0000, 0x0000, 0x00},    // LDA #$01 / STA $FF20 (store raises the IRQ)
+    {{0x7A,0xFF,0x20,0x26,0xFB},            0x00, 0x00, 0x0000, 0x0000, 0x0000, 0x00},    // DEC $FF20 / BNE (IRQ before the branch)
+};
+
+#define CPUCHECK_NUM_PAIRS  (sizeof(cpucheck_pairs) / sizeof(cpucheck_pairs[0]))
+
+typedef struct
+{
+    u8  a, b, cc, dp;
+    u16 x, y, u, s, pc;
+    u8  state, irq;
+    u8  port, cycles;
+    u32 crc;
+} cpucheck_result_t;
+
+// The IRQ port and vector are only hooked up while the pair tests run
+static uint8_t cpucheck_io(uint16_t address, uint8_t data, mem_operation_t op)
+{
+    if (op == MEM_WRITE)
+    {
+        memory_RAM[address] = data;
+        if (address == CPUCHECK_IRQ_PORT) cpu_irq(INT_IRQ);
+    }
+
+    return memory_RAM[address];
+}
+
+static void cpucheck_pair_load(const cpucheck_pair_t *t)
+{
+    memset(&memory_RAM[CPUCHECK_DATA], 0x00, CPUCHECK_STACK - CPUCHECK_DATA);
+    memcpy(&memory_RAM[CPUCHECK_ORG], t->code, sizeof(t->code));
+    if (t->mem_addr) memory_RAM[t->mem_addr] = t->mem_in;
+    memory_RAM[CPUCHECK_IRQ_PORT] = 0x00;
+
+    cpu.a = t->a;   cpu.b = t->b;
+    cpu.x = t->x;   cpu.y = t->y;
+    cpu.u = 0;      cpu.s = CPUCHECK_STACK;
+    cpu.dp = 0x20;
+    cpu.pc = CPUCHECK_ORG;
+    cpu.irq_asserted = 0;
+    cpu_set_cc(CC_NONE);
+}
+
+static void cpucheck_pair_result(cpucheck_result_t *res, u8 cycles)
+{
+    memset(res, 0x00, sizeof(cpucheck_result_t));
+    res->a  = cpu.a;    res->b  = cpu.b;
+    res->cc = cpu_get_cc();
+    res->dp = cpu.dp;
+    res->x  = cpu.x;    res->y  = cpu.y;
+    res->u  = cpu.u;    res->s  = cpu.s;
+    res->pc = cpu.pc;
+    res->state  = cpu.cpu_state;
+    res->irq    = cpu.irq_asserted;
+    res->port   = memory_RAM[CPUCHECK_IRQ_PORT];
+    res->cycles = cycles;
+    res->crc    = getCRC32(&memory_RAM[CPUCHECK_DATA], CPUCHECK_STACK - CPUCHECK_DATA);
+}
+
+static u8 cpucheck_pair(const cpucheck_pair_t *t)
+{
+    cpucheck_result_t unfused, fused;
+
+    cpucheck_pair_load(t);
+    u8 first  = cpucheck_step();
+    u8 second = cpucheck_step();
+    cpucheck_pair_result(&unfused, first + second);
+
+    cpucheck_pair_load(t);
+    int start = CPU_CYCLES_PER_LINE - 1 - first;
+    cycles_this_scanline = start;
+    cpu_run();
+    cpucheck_pair_result(&fused, cycles_this_scanline + CPU_CYCLES_PER_LINE - start);
+
+    cpu.irq_asserted = 0;
+
+    return (memcmp(&unfused, &fused, sizeof(cpucheck_result_t)) == 0);
+}
+
+// ---------------------------------------------------------------------------------------
+// The instruction mix: an outer loop that walks X through 16 bytes doing a load, add and
+// store each time around, then calls a subroutine with a multiply and a push/pull. U
+// counts the passes so we know how many instructions ran.
+// ---------------------------------------------------------------------------------------
+static const u8 cpucheck_mix[] =
+{
+    0x8E, 0x21, 0x00,       // 1000: LDX  #$2100
+    0x33, 0x41,             // 1003: LEAU 1,U
+    0xA6, 0x80,             // 1005: LDA  ,X+
+    0x8B, 0x05,             // 1007: ADDA #$05
+    0x97, 0x40,             // 1009: STA  <$40
+    0x31, 0x21,             // 100B: LEAY 1,Y
+    0x8C, 0x21, 0x10,       // 100D: CMPX #$2110
+    0x26, 0xF3,             // 1010: BNE  $1005
+    0xBD, 0x10, 0x20,       // 1012: JSR  $1020
+    0x20, 0xE9,             // 1015: BRA  $1000
+};
+
+static const u8 cpucheck_mix_sub[] =
+{
+    0x3D,                   // 1020: MUL
+    0x34, 0x06,             // 1021: PSHS A,B
+    0x35, 0x06,             // 1023: PULS A,B
+    0x39,                   // 1025: RTS
+};
+
+static void cpucheck_bench(void)
+{
+    u32 ticks = 0;
+
+    memcpy(&memory_RAM[CPUCHECK_ORG], cpucheck_mix, sizeof(cpucheck_mix));
+    memcpy(&memory_RAM[CPUCHECK_ORG+0x20], cpucheck_mix_sub, sizeof(cpucheck_mix_sub));
+
+    cpu.x = cpu.y = cpu.u = 0;
+    cpu.s  = CPUCHECK_STACK;
+    cpu.dp = 0x20;
+    cpu.pc = CPUCHECK_ORG;
+    cpu_set_cc(0x50);   // Interrupts masked
+    cycles_this_scanline = 0;
+
+    PerfTimerStart();
+    for (u16 line=0; line<CPUCHECK_BENCH_LINES; line += CPUCHECK_BENCH_CHUNK)
+    {
+        u16 start = PerfClock();
+        for (u8 i=0; i<CPUCHECK_BENCH_CHUNK; i++) cpu_run();
+        ticks += (u16)(PerfClock() - start);
+    }
+
+    u32 us = PerfTicksToUs(ticks);
+    if (!us) return;
+
+    cpucheck_kips  = (u32)(((u64)cpu.u * CPUCHECK_MIX_OPS * 1000) / us);
+    cpucheck_speed = (u32)(((u64)CPUCHECK_BENCH_LINES * CPU_CYCLES_PER_LINE * 10000000) / ((u64)us * 89489));
+}
+
+void cpu_selfcheck(void)
+{
+    // A clean all-RAM machine with nothing to interrupt us - the game is set up from scratch afterwards
+    mem_init();
+    sam_registers.mpu_rate = 0;
+    cpu.cpu_state      = CPU_EXEC;
+    cpu.irq_asserted   = 0;
+    cpu.firq_asserted  = 0;
+    cpu.nmi_latched    = 0;
+    cpu.halt_asserted  = 0;
+    cpu.reset_asserted = 0;
+
+    cpucheck_tables();
+
+    cpucheck_ops_total  = CPUCHECK_NUM_PAIRS;
+    cpucheck_ops_passed = 0;
+    cpucheck_first_fail = 0xFF;
+    cpucheck_deviations = 0;
+    for (u8 i=0; i<CPUCHECK_NUM_OPS; i++)
+    {
+        if (cpucheck_ops[i].known)
+        {
+            if (!cpucheck_one(&cpucheck_ops[i])) cpucheck_deviations++;
+            continue;
+        }
+
+        cpucheck_ops_total++;
+        if (cpucheck_one(&cpucheck_ops[i])) cpucheck_ops_passed++;
+        else if (cpucheck_first_fail == 0xFF) cpucheck_first_fail = i;
+    }
+
+    mem_define_io(CPUCHECK_IRQ_PORT, CPUCHECK_IRQ_PORT, cpucheck_io);
+    mem_define_io(CPUCHECK_VEC_IRQ, CPUCHECK_VEC_IRQ+1, cpucheck_io);
+    memory_RAM[CPUCHECK_VEC_IRQ]   = CPUCHECK_IRQ_VECTOR >> 8;
+    memory_RAM[CPUCHECK_VEC_IRQ+1] = CPUCHECK_IRQ_VECTOR & 0xFF;
+    memory_RAM[CPUCHECK_IRQ_VECTOR] = 0x12;     // NOP
+
+    for (u8 i=0; i<CPUCHECK_NUM_PAIRS; i++)
+    {
+        if (cpucheck_pair(&cpucheck_pairs[i])) cpucheck_ops_passed++;
+        else if (cpucheck_first_fail == 0xFF) cpucheck_first_fail = CPUCHECK_NUM_OPS + i;
+    }
+
+    mem_init();     // Unhook the test IO before the benchmark
+
+    cpucheck_bench();
+}
+
+// End of file
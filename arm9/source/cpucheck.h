@@ -0,0 +1,35 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#ifndef _CPUCHECK_H_
+#define _CPUCHECK_H_
+
+#include <nds.h>
+
+#define CPUCHECK_ORG            0x1000      // Test instructions are placed here...
+#define CPUCHECK_DATA           0x2000      // ...and their data around here (DP is $20)
+#define CPUCHECK_STACK          0x3000
+
+#define CPUCHECK_BENCH_LINES    20000       // Scanlines of the instruction mix to time (a bit over a second of 6809 time)
+#define CPUCHECK_BENCH_CHUNK    64          // Scanlines per timed chunk - well under the 125ms timer wrap
+#define CPUCHECK_MIX_OPS        104         // Instructions per pass through the mix
+
+extern u16 cpucheck_table_errors;           // Op-code table entries that disagree with the datasheet
+extern u8  cpucheck_ops_passed;             // Instruction and fused pair tests passed...
+extern u8  cpucheck_ops_total;              // ...out of this many
+extern u8  cpucheck_first_fail;             // Index of the first failing test (0xFF if none)
+extern u8  cpucheck_deviations;             // Known deviations from the datasheet still present (not in the pass count)
+extern u32 cpucheck_kips;                   // Thousands of 6809 instructions per second
+extern u32 cpucheck_speed;                  // Percent of a real 0.89MHz 6809
+
+extern void cpu_selfcheck(void);
+
+#endif // _CPUCHECK_H_
@@ -0,0 +1,274 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#include <nds.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "DracoDS.h"
+#include "DracoUtils.h"
+#include "CRC32.h"
+#include "printf.h"
+
+#include "dircache.h"
+
+// ---------------------------------------------------------------------------------------
+// Each directory we browse gets a small DracoDS.idx file holding what we've learned about
+// each game: size, modification time, CRC and media type (and for tapes whether it's BASIC
+// or machine code). The file is keyed by a CRC of the sorted listing - if nothing was added,
+// removed or renamed, record N belongs to gpFic[N] and only the header is read when the
+// directory is opened. The records themselves are read a page at a time as the browser
+// shows them. The per-file info is filled in as games are loaded and is checked against
+// the file's size and mtime each time a record is read and each time that game is loaded.
+// ---------------------------------------------------------------------------------------
+struct dircache_meta_t dircache_meta[MAX_FILES];
+
+static u8  dircache_loaded[MAX_FILES];      // Set once the record for gpFic[N] has been read
+static u8  dircache_ok = 0;                 // Set if the cache file matches the listing we're showing
+static u32 dircache_signature = 0;
+
+static struct dircache_record_t rec;
+static struct dircache_name_t   name;
+
+extern int Filescmp(const void *c1, const void *c2);
+
+static u8 dircache_open_header(FILE *fp, struct dircache_header_t *header)
+{
+    if (fread(header, sizeof(*header), 1, fp) != 1) return 0;
+    if ((header->magic != DIRCACHE_MAGIC) || (header->version != DIRCACHE_VERSION)) return 0;
+    if (header->count > MAX_FILES) return 0;
+    return 1;
+}
+
+static inline long dircache_record_pos(u16 idx)
+{
+    return sizeof(struct dircache_header_t) + (idx * sizeof(struct dircache_record_t));
+}
+
+static inline long dircache_name_pos(u16 count, u16 idx)
+{
+    return dircache_record_pos(count) + (idx * sizeof(struct dircache_name_t));
+}
+
+// A record is only trusted if the file still has the size and mtime it had when the CRC was
+// taken - the listing signature only catches files being added, removed or renamed.
+static u8 dircache_still_current(u16 idx, struct dircache_meta_t *meta)
+{
+    struct stat stbuf;
+
+    if (!meta->valid || (stat(gpFic[idx].szName, &stbuf) != 0)) return 0;
+    return (meta->size == (u32)stbuf.st_size) && (meta->mtime == (u32)stbuf.st_mtime);
+}
+
+// ---------------------------------------------------------------------------------------
+// The listing changed (or there was no cache). Carry over what we knew about any files
+// that are still here and write out a new cache.
+// ---------------------------------------------------------------------------------------
+static void dircache_rebuild(FILE *fp, struct dircache_header_t *header)
+{
+    FIDraco key;
+
+    if (fp && dircache_open_header(fp, header))
+    {
+        for (u16 i=0; i<header->count; i++)
+        {
+            fseek(fp, dircache_name_pos(header->count, i), SEEK_SET);
+            if (fread(&name, sizeof(name), 1, fp) != 1) break;
+
+            memset(&key, 0x00, sizeof(key));
+            memcpy(key.szName, name.szName, MAX_FILENAME_LEN);
+            key.uType = name.uType;
+
+            FIDraco *match = bsearch(&key, gpFic, fileCount, sizeof(FIDraco), Filescmp);
+            if (!match || (strcmp(match->szName, key.szName) != 0)) continue;
+
+            fseek(fp, dircache_record_pos(i), SEEK_SET);
+            if (fread(&rec, sizeof(rec), 1, fp) != 1) break;
+            if (!dircache_still_current(match - gpFic, &rec.meta)) continue;
+
+            match->uCrc = rec.uCrc;
+            dircache_meta[match - gpFic] = rec.meta;
+        }
+    }
+    if (fp) fclose(fp);
+
+    fp = fopen(DIRCACHE_FILE, "wb");
+    if (fp)
+    {
+        header->magic     = DIRCACHE_MAGIC;
+        header->version   = DIRCACHE_VERSION;
+        header->count     = fileCount;
+        header->signature = dircache_signature;
+        fwrite(header, sizeof(*header), 1, fp);
+
+        for (u16 i=0; i<fileCount; i++)
+        {
+            rec.uCrc = gpFic[i].uCrc;
+            rec.meta = dircache_meta[i];
+            fwrite(&rec, sizeof(rec), 1, fp);
+        }
+        for (u16 i=0; i<fileCount; i++)
+        {
+            memset(&name, 0x00, sizeof(name));
+            strcpy(name.szName, gpFic[i].szName);
+            name.uType = gpFic[i].uType;
+            fwrite(&name, sizeof(name), 1, fp);
+        }
+        dircache_ok = (fclose(fp) == 0);
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// Called with the sorted gpFic[] of a newly opened directory. If the cache was built from
+// this exact listing only its header is read - otherwise it is rebuilt.
+// ---------------------------------------------------------------------------------------
+void DirCacheOpen(u32 signature)
+{
+    struct dircache_header_t header;
+
+    memset(dircache_meta, 0x00, sizeof(dircache_meta));
+    memset(dircache_loaded, 0x00, sizeof(dircache_loaded));
+    for (u16 i=0; i<fileCount; i++) gpFic[i].uCrc = 0;
+    dircache_signature = signature;
+    dircache_ok = 0;
+
+    FILE *fp = fopen(DIRCACHE_FILE, "rb");
+    if (fp && dircache_open_header(fp, &header) && (header.count == fileCount) && (header.signature == signature))
+    {
+        fclose(fp);
+        dircache_ok = 1;
+        return;
+    }
+
+    if (fp) fseek(fp, 0, SEEK_SET);
+    dircache_rebuild(fp, &header);
+    memset(dircache_loaded, 0x01, sizeof(dircache_loaded));     // Everything we know is already in memory
+}
+
+// ---------------------------------------------------------------------------------------
+// A listing that isn't games (text files) - nothing to look up.
+// ---------------------------------------------------------------------------------------
+void DirCacheClear(void)
+{
+    memset(dircache_meta, 0x00, sizeof(dircache_meta));
+    memset(dircache_loaded, 0x01, sizeof(dircache_loaded));
+    dircache_ok = 0;
+}
+
+// ---------------------------------------------------------------------------------------
+// Make sure the records for the files about to be shown have been read - the records are
+// side by side in the cache so a whole page is one small read. A record whose file has
+// changed since is dropped so it gets refreshed the next time that game is loaded.
+// ---------------------------------------------------------------------------------------
+void DirCachePage(u16 first, u16 count)
+{
+    u16 i;
+
+    if (!dircache_ok || (first >= fileCount)) return;
+    if ((first + count) > fileCount) count = fileCount - first;
+
+    for (i=first; (i < (first + count)) && dircache_loaded[i]; i++);
+    if (i == (first + count)) return;
+
+    FILE *fp = fopen(DIRCACHE_FILE, "rb");
+    if (!fp) return;
+
+    fseek(fp, dircache_record_pos(first), SEEK_SET);
+    for (i=first; i < (first + count); i++)
+    {
+        if (fread(&rec, sizeof(rec), 1, fp) != 1) break;
+        if (!dircache_loaded[i])
+        {
+            if (dircache_still_current(i, &rec.meta))
+            {
+                gpFic[i].uCrc = rec.uCrc;
+                dircache_meta[i] = rec.meta;
+            }
+            dircache_loaded[i] = 1;
+        }
+    }
+    fclose(fp);
+}
+
+// ---------------------------------------------------------------------------------------
+// A game was just loaded - record its CRC and what type of program it is. Only the one
+// record is written back to the cache file.
+// ---------------------------------------------------------------------------------------
+void DirCacheUpdate(u16 idx, u32 crc)
+{
+    struct dircache_header_t header;
+    struct dircache_meta_t *meta = &dircache_meta[idx];
+    struct stat stbuf;
+
+    if ((idx >= fileCount) || (stat(gpFic[idx].szName, &stbuf) != 0)) return;
+
+    // Nothing to do if we already knew all about this file
+    if (meta->valid && (meta->size == (u32)stbuf.st_size) && (meta->mtime == (u32)stbuf.st_mtime) && (gpFic[idx].uCrc == crc)) return;
+
+    meta->media    = draco_mode;
+    meta->prog     = (draco_mode == MODE_CAS) ? detect_cas_file_type(TapeCartDiskBuffer, file_size) : TAPE_TYPE_MACHINE;
+    meta->valid    = 1;
+    meta->reserved = 0;
+    meta->size     = (u32)stbuf.st_size;
+    meta->mtime    = (u32)stbuf.st_mtime;
+    gpFic[idx].uCrc = crc;
+
+    dircache_loaded[idx] = 1;
+    if (!dircache_ok) return;
+
+    FILE *fp = fopen(DIRCACHE_FILE, "rb+");
+    if (fp)
+    {
+        // Only touch the record if the cache on disk is the one we're showing
+        if (dircache_open_header(fp, &header) && (header.count == fileCount) && (header.signature == dircache_signature))
+        {
+            rec.uCrc = gpFic[idx].uCrc;
+            rec.meta = *meta;
+            fseek(fp, dircache_record_pos(idx), SEEK_SET);
+            fwrite(&rec, sizeof(rec), 1, fp);
+        }
+        fclose(fp);
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// Show what we know about the highlighted file (before it's loaded) on the bottom line.
+// ---------------------------------------------------------------------------------------
+void DirCacheShowInfo(u16 idx)
+{
+    static const char *szMedia[] = {"", "CART", "CAS", "DSK"};
+    char szInfo[40];
+    struct dircache_meta_t *meta = &dircache_meta[idx];
+
+    DirCachePage(idx, 1);
+    if ((idx >= fileCount) || (gpFic[idx].uType == DIRECTORY) || !meta->valid || (meta->media > MODE_DSK))
+    {
+        DSPrint(1,23,0, "                              ");
+        return;
+    }
+
+    const char *szProg = "";
+    if (meta->media == MODE_CAS)
+    {
+        if      (meta->prog == TAPE_TYPE_BASIC)   szProg = "BASIC";
+        else if (meta->prog == TAPE_TYPE_MACHINE) szProg = "MC";
+        else if (meta->prog == TAPE_TYPE_DATA)    szProg = "DATA";
+        else                                      szProg = "?";
+    }
+
+    sprintf(szInfo, "%-4s %-5s %4ldK %08lX %-3s", szMedia[meta->media], szProg, meta->size/1024, gpFic[idx].uCrc, (FindConfigSlot(gpFic[idx].uCrc) >= 0) ? "CFG":"");
+    DSPrint(1,23,0, szInfo);
+}
+
+// End of file
@@ -0,0 +1,63 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#ifndef _DIRCACHE_H_
+#define _DIRCACHE_H_
+
+#include <nds.h>
+#include "DracoUtils.h"
+
+#define DIRCACHE_FILE       "DracoDS.idx"
+#define DIRCACHE_MAGIC      0x58494344      // 'DCIX'
+#define DIRCACHE_VERSION    0x0002
+
+// What we know about each file in the browser - only trusted if 'valid' is set
+struct __attribute__((__packed__)) dircache_meta_t
+{
+    u8  media;          // MODE_CART, MODE_CAS or MODE_DSK
+    s8  prog;           // For tapes: TAPE_TYPE_BASIC / TAPE_TYPE_MACHINE / etc. from detect_cas_file_type()
+    u8  valid;          // Set once the file has been loaded and the info below filled in
+    u8  reserved;
+    u32 size;           // File size and modification time when the CRC was taken...
+    u32 mtime;          // ...if either changes, the entry is refreshed on the next load
+};
+
+struct __attribute__((__packed__)) dircache_header_t
+{
+    u32 magic;
+    u16 version;
+    u16 count;          // Number of records that follow
+    u32 signature;      // CRC32 of the sorted directory listing this cache was built from
+};
+
+// The file is the header, 'count' records in listing order (so record N is gpFic[N] and
+// can be read on its own) and then 'count' names - only needed when the listing changes.
+struct __attribute__((__packed__)) dircache_record_t
+{
+    u32  uCrc;          // Same CRC that keys the game's configuration
+    struct dircache_meta_t meta;
+};
+
+struct __attribute__((__packed__)) dircache_name_t
+{
+    char szName[MAX_FILENAME_LEN+1];
+    u8   uType;         // DRACO_FILE or DIRECTORY
+};
+
+extern struct dircache_meta_t dircache_meta[MAX_FILES];
+
+extern void DirCacheOpen(u32 signature);
+extern void DirCacheClear(void);
+extern void DirCachePage(u16 first, u16 count);
+extern void DirCacheUpdate(u16 idx, u32 crc);
+extern void DirCacheShowInfo(u16 idx);
+
+#endif // _DIRCACHE_H_
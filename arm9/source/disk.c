@@ -71,6 +71,10 @@ void disk_init(void)
 
         fdc_reset(true);
 
+        fdc_timing = myConfig.diskTiming;       // Instant or cycle-accurate disk timing for this game
+        fdc_stat_commands = 0;
+        fdc_stat_busy_cycles = 0;
+
         fdc_init(WD2793, 1, 1, (last_file_size >= (180*1024) ? 40:35), 18, 256, 1, TapeCartDiskBuffer, NULL);
     }
 }
@@ -152,8 +156,9 @@ void disk_intrq(void)
  */
 char *disk_get_filename(void)
 {
-    // Look for printable ASCII character and a 'B' where BIN or BAS would be... 
-    if (isprint(TapeCartDiskBuffer[0x13400]) && (TapeCartDiskBuffer[0x13408] == 'B'))
+    // Look for printable ASCII character and a 'B' where BIN or BAS would be... but only if
+    // the image is big enough to have a directory (otherwise it's the last disk's leftovers)
+    if ((last_file_size > 0x13408) && isprint(TapeCartDiskBuffer[0x13400]) && (TapeCartDiskBuffer[0x13408] == 'B'))
     {
         return (char *)&TapeCartDiskBuffer[0x13400];
     }
@@ -26,6 +26,10 @@
 #include "vdg.h"
 #include "sam.h"
 #include "disk.h"
+#include "fdc.h"
+#include "runahead.h"
+#include "profile.h"
+#include "perf.h"
 #include "printf.h"
 
 #define     DRAGON_ROM_START        0x8000
@@ -103,15 +107,29 @@ void dragon_reset(void)
 // -----------------------------------------------------------------------------
 ITCM_CODE u32 dragon_run(void)
 {
+    u16 perf_t = PerfStart();
+
     // --------------------------------------
     // Process 1 scanline worth of DAC Audio
     // --------------------------------------
-    if (!tape_motor) processDirectAudio();
+    if (!tape_motor && !(runahead_mask & RUNAHEAD_NO_AUDIO)) processDirectAudio();
+    perf_t = PerfLap(PERF_AUDIO, perf_t);
 
     // ----------------------------------------
     // Execute one scanline of CPU (57 cycles)
     // ----------------------------------------
     cpu_run();
+    ProfileSample(cpu.pc);
+    perf_t = PerfLap(PERF_CPU, perf_t);
+
+    // ---------------------------------------------------------
+    // Keep the floppy spinning (drives the disk timing model)
+    // ---------------------------------------------------------
+    if (draco_mode >= MODE_DSK)
+    {
+        fdc_tick();
+        perf_t = PerfLap(PERF_FDC, perf_t);
+    }
 
     // -------------------------------------------------
     // Each scanline generates a Fast IRQ for the HSync
@@ -123,7 +141,12 @@ ITCM_CODE u32 dragon_run(void)
     // --------------------------------------------
     if (++draco_line == (myConfig.machine ? 262:312))
     {
-        vdg_render();       // Draw the frame
+        if (!(runahead_mask & RUNAHEAD_NO_VIDEO))   // Draw the frame (unless run-ahead is showing a later one)
+        {
+            perf_t = PerfStart();
+            vdg_render();
+            PerfLap(PERF_VDG, perf_t);
+        }
         pia_vsync_irq();    // Render the sync interrupt
         draco_line = 0;     // Back to the top
         cycles_this_scanline = 0;
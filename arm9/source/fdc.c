@@ -19,6 +19,9 @@
 
 #include "DracoDS.h"
 #include "fdc.h"
+#include "cpu.h"
+#include "sam.h"
+#include "disk.h"
 #include "CRC32.h"
 #include "printf.h"
 
@@ -38,6 +41,28 @@ extern void disk_intrq(void);
 u8 io_show_status = 0;
 u8 bFireDiskIRQ=0;
 
+// -----------------------------------------------------------------------------------------
+// Disk timing policy. The INSTANT policy lets every command complete as fast as the guest
+// polls the controller - this is what nearly every game wants. The ACCURATE policy drives
+// the controller from emulated CPU cycles (spindle rotation, step rate, head settle, motor
+// spin-up and the 250Kbps byte rate) for the handful of titles that time the disk itself.
+// The two stats below are shown in the debugger so the policies can be compared per game.
+// -----------------------------------------------------------------------------------------
+u8  fdc_timing           = FDC_TIMING_INSTANT;
+u32 fdc_stat_commands    = 0;   // Number of commands issued to the controller
+u32 fdc_stat_busy_cycles = 0;   // Emulated CPU cycles the controller has spent busy
+
+u8  fdc_sector_slot[32];        // Physical position of each logical sector around the track
+u8  fdc_id_rotor = 0;           // Instant timing: which ID field Read Address sees next
+
+// -----------------------------------------------------------------------------------------
+// The Type III commands (Read Address, Read Track and Write Track) work on the raw byte
+// stream as it passes under the head - gaps, sync bytes, address marks and CRCs included.
+// We synthesize (or collect) that stream here. Write Track data is gathered byte-by-byte
+// as the CPU hands it over and only parsed back into sectors, in bulk, once the track ends.
+// -----------------------------------------------------------------------------------------
+u8  fdc_raw_track[FDC_RAW_TRACK_LEN];
+
 void fdc_debug(u8 bWrite, u8 addr, u8 data)
 {
 #if 0 // Set to 1 to enable debug
@@ -57,17 +82,124 @@ void fdc_debug(u8 bWrite, u8 addr, u8 data)
 #endif
 }
 
+// -------------------------------------------------------------------------------------------------------------------------
+// The rotation clock is bumped once per scanline by fdc_tick() and we refine it here with the CPU cycles already run on
+// the current scanline. When the SAM has the CPU overclocked, twice as many CPU cycles fit into the same real time.
+// -------------------------------------------------------------------------------------------------------------------------
+static inline u32 fdc_now(void)
+{
+    return FDC.clock + (sam_registers.mpu_rate ? (cycles_this_scanline >> 1) : cycles_this_scanline);
+}
+
+static inline u8 fdc_event_due(void)
+{
+    return ((s32)(fdc_now() - FDC.event_clock) >= 0);
+}
+
+// -------------------------------------------------------------------------------------------------------------------------
+// Lay the sectors out around the track the same way DSKINI does with its default skip factor. Reading consecutive logical
+// sectors then costs roughly what it did on real hardware rather than a full revolution (or nothing at all) per sector.
+// -------------------------------------------------------------------------------------------------------------------------
+static void fdc_build_interleave(void)
+{
+    u8 used[32];
+    u8 slot = 0;
+
+    memset(used, 0x00, sizeof(used));
+    for (u8 i=0; (i < Geom.sectors) && (i < 32); i++)
+    {
+        while (used[slot]) slot = (slot+1) % Geom.sectors;     // Find the next free physical slot
+        used[slot] = 1;
+        fdc_sector_slot[i] = slot;
+        slot = (slot + FDC_SKIP_FACTOR + 1) % Geom.sectors;    // And skip ahead for the next logical sector
+    }
+}
+
+// -------------------------------------------------------------------------------------------------------------------------
+// Return the clock at which the data field of the given sector will next pass under the head, starting from 'start'.
+// -------------------------------------------------------------------------------------------------------------------------
+static u32 fdc_sector_arrival(u8 sector, u32 start)
+{
+    u8  idx = (u8)(sector - Geom.startSector);
+    u32 slot_pos = (idx < Geom.sectors) ? (fdc_sector_slot[idx] * (FDC_CYCLES_PER_REV / Geom.sectors)) : 0;
+    u32 pos = start % FDC_CYCLES_PER_REV;
+
+    return start + ((slot_pos + FDC_CYCLES_PER_REV - pos) % FDC_CYCLES_PER_REV) + (FDC_BYTES_ID_TO_DATA * FDC_CYCLES_PER_BYTE);
+}
+
+// -------------------------------------------------------------------------------------------------------------------------
+// A command can't find anything on the disk until the spindle motor is up to speed.
+// -------------------------------------------------------------------------------------------------------------------------
+static u32 fdc_command_start(void)
+{
+    u32 now = fdc_now();
+
+    if (FDC.motor && ((s32)(FDC.motor_ready_clock - now) > 0)) return FDC.motor_ready_clock;
+
+    return now;
+}
+
+// -------------------------------------------------------------------------------------------------------------------------
+// Return the clock at which the index hole next passes the sensor. Read Track and Write Track both start from here.
+// -------------------------------------------------------------------------------------------------------------------------
+static u32 fdc_next_index(u32 start)
+{
+    return start + ((FDC_CYCLES_PER_REV - (start % FDC_CYCLES_PER_REV)) % FDC_CYCLES_PER_REV);
+}
+
+// -------------------------------------------------------------------------------------------------------------------------
+// The CoCo disk interface holds the CPU HALT line low whenever the halt flag is set and the controller is busy without a
+// data request. Short waits (between bytes) are simply charged to the CPU. Longer waits (rotating to the sector) hold the
+// CPU until fdc_tick() sees the data request or the end of the command.
+// -------------------------------------------------------------------------------------------------------------------------
+static void fdc_check_halt(void)
+{
+    if (halt_flag && (FDC.commandType >= 2) && ((FDC.status & 0x03) == 0x01))
+    {
+        s32 wait = (s32)(FDC.event_clock - fdc_now());
+
+        if (wait <= 0) return;  // Already due - the next register access will see it
+
+        if (wait <= FDC_CYCLES_HALT_STALL)
+        {
+            cycles_this_scanline += (sam_registers.mpu_rate ? (wait << 1) : wait);
+        }
+        else
+        {
+            cpu_halt(1);
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------------------------------------------
+// The track and sector registers can be loaded with anything by the CPU (and a stepping head would happily walk off the
+// end of the disk) so make sure the head is somewhere we have a disk image for before we touch the image.
+// -------------------------------------------------------------------------------------------------------------------------
+static inline u8 fdc_track_ok(void)
+{
+    return (FDC.track < Geom.tracks) && (FDC.side < Geom.sides) && (FDC.drive < Geom.drives);
+}
+
+static inline u8 fdc_sector_ok(void)
+{
+    return fdc_track_ok() && (FDC.sector >= Geom.startSector) && ((FDC.sector - Geom.startSector) < Geom.sectors);
+}
+
 // -------------------------------------------------------------------------------------------------------------------------
 // Read one track worth of sectors in proper sector order (0..N) and buffer that in our track buffer for easy read/write.
 // -------------------------------------------------------------------------------------------------------------------------
 void fdc_buffer_track(void)
 {
     u16 track_len = Geom.sectorSize*Geom.sectors;
-    if (FDC.drive == 0)
-        memcpy(FDC.track_buffer, Geom.disk0 + (((Geom.sides * FDC.track) + FDC.side) * track_len), track_len+512); // Get the entire track into our buffer
+    if (!fdc_track_ok())                    // Off the end of the disk... nothing but unformatted media out here
+    {
+        memset(FDC.track_buffer, 0x00, track_len);
+    }
+    else if (FDC.drive == 0)
+        memcpy(FDC.track_buffer, Geom.disk0 + (((Geom.sides * FDC.track) + FDC.side) * track_len), track_len); // Get the entire track into our buffer
     else
     {
-        memcpy(FDC.track_buffer, Geom.disk1 + (((Geom.sides * FDC.track) + FDC.side) * track_len), track_len+512); // Get the entire track into our buffer
+        memcpy(FDC.track_buffer, Geom.disk1 + (((Geom.sides * FDC.track) + FDC.side) * track_len), track_len); // Get the entire track into our buffer
     }
     FDC.track_dirty = 0;
 }
@@ -77,7 +209,7 @@ void fdc_buffer_track(void)
 // ---------------------------------------------------------------------------------------------------
 void fdc_flush_track(void)
 {
-    if (FDC.track_dirty)
+    if (FDC.track_dirty && fdc_track_ok())
     {
         u16 track_len = Geom.sectorSize*Geom.sectors;
         if (FDC.drive == 0)
@@ -88,6 +220,128 @@ void fdc_flush_track(void)
     }
 }
 
+// ---------------------------------------------------------------------------------------------------
+// Standard CCITT CRC-16 as used on the ID and data fields of MFM disks. Only the Type III commands
+// need this so a simple bitwise version is plenty fast enough.
+// ---------------------------------------------------------------------------------------------------
+static u16 fdc_crc16(u16 crc, const u8 *buf, u16 len)
+{
+    while (len--)
+    {
+        crc ^= (u16)(*buf++) << 8;
+        for (u8 i=0; i<8; i++)
+        {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+// ---------------------------------------------------------------------------------------------------
+// Build the 6 byte ID field (track, side, sector, size code, CRC) for the given logical sector
+// index into buf. The CRC covers the three A1 sync bytes and the FE address mark as well.
+// ---------------------------------------------------------------------------------------------------
+static void fdc_build_id_field(u8 *buf, u8 sector_idx)
+{
+    static const u8 idam[4] = {0xA1, 0xA1, 0xA1, 0xFE};
+
+    buf[0] = FDC.track;
+    buf[1] = FDC.side;
+    buf[2] = sector_idx + Geom.startSector;
+    buf[3] = (Geom.sectorSize >= 1024) ? 3 : ((Geom.sectorSize >= 512) ? 2 : ((Geom.sectorSize >= 256) ? 1 : 0));
+
+    u16 crc = fdc_crc16(fdc_crc16(0xFFFF, idam, 4), buf, 4);
+    buf[4] = crc >> 8;
+    buf[5] = crc & 0xFF;
+}
+
+// ---------------------------------------------------------------------------------------------------
+// Synthesize the raw MFM byte stream for the current track (as Read Track would see it) starting
+// at the index hole. Sectors are laid out in the same interleave the timing model uses.
+// ---------------------------------------------------------------------------------------------------
+static void fdc_build_raw_track(void)
+{
+    static const u8 dam[4] = {0xA1, 0xA1, 0xA1, 0xFB};
+    u8  physical[32];
+    u16 idx = 0;
+
+    fdc_buffer_track();     // Sector contents come from the normal track buffer
+
+    for (u8 i=0; (i < Geom.sectors) && (i < 32); i++) physical[fdc_sector_slot[i]] = i;
+
+    memset(&fdc_raw_track[idx], 0x4E, 32); idx += 32;                              // Gap 1
+    for (u8 slot=0; (slot < Geom.sectors) && (slot < 32); slot++)
+    {
+        u8 sector_idx = physical[slot];
+        u8 *data = &FDC.track_buffer[sector_idx * Geom.sectorSize];
+
+        if ((idx + FDC_RAW_SECTOR_OVERHEAD + Geom.sectorSize) > FDC_RAW_TRACK_LEN) break;   // Track is full
+
+        memset(&fdc_raw_track[idx], 0x00, 8);  idx += 8;                            // Sync
+        memset(&fdc_raw_track[idx], 0xA1, 3);  idx += 3;                            // ID address mark
+        fdc_raw_track[idx++] = 0xFE;
+        fdc_build_id_field(&fdc_raw_track[idx], sector_idx); idx += 6;              // ID field plus CRC
+        memset(&fdc_raw_track[idx], 0x4E, 22); idx += 22;                           // Gap 2
+        memset(&fdc_raw_track[idx], 0x00, 12); idx += 12;                           // Sync
+        memcpy(&fdc_raw_track[idx], dam, 4);   idx += 4;                            // Data address mark
+        memcpy(&fdc_raw_track[idx], data, Geom.sectorSize);                         // Sector data
+        idx += Geom.sectorSize;
+        u16 crc = fdc_crc16(fdc_crc16(0xFFFF, dam, 4), data, Geom.sectorSize);
+        fdc_raw_track[idx++] = crc >> 8;
+        fdc_raw_track[idx++] = crc & 0xFF;
+        memset(&fdc_raw_track[idx], 0x4E, 24); idx += 24;                           // Gap 3
+    }
+    if (idx < FDC_RAW_TRACK_LEN) memset(&fdc_raw_track[idx], 0x4E, FDC_RAW_TRACK_LEN - idx);   // Gap 4 runs up to the index hole
+}
+
+// ---------------------------------------------------------------------------------------------------
+// Parse a Write Track (format) byte stream back into sectors. In the stream written by the CPU an
+// F5 is an A1 sync byte with a missing clock, F6 is C2 and F7 emits two CRC bytes. We look for the
+// F5-prefixed FE (ID) and FB/F8 (data) address marks and drop each sector found into our track
+// buffer. Sectors that don't match our disk geometry are simply ignored.
+// ---------------------------------------------------------------------------------------------------
+static void fdc_parse_raw_track(u16 len)
+{
+    u16 i = 1;
+
+    if (FDC.track >= Geom.tracks) return;   // Nowhere to put it on our disk image
+
+    fdc_buffer_track();                     // Anything we don't find keeps its old contents
+
+    while (i < len)
+    {
+        u8 *p = memchr(&fdc_raw_track[i], 0xFE, len - i);       // Bulk scan for the next ID address mark
+        if (p == NULL) break;
+        i = (u16)(p - fdc_raw_track) + 1;
+        if (p[-1] != 0xF5) continue;                            // Not preceded by sync... just a data byte
+        if ((i + 4) > len) break;
+
+        u8  sector = fdc_raw_track[i+2];
+        u16 size   = 128 << (fdc_raw_track[i+3] & 0x03);
+        i += 4;
+
+        // The data address mark must show up within Gap 2 (allow plenty of slack)
+        u16 end = ((i + 64) < len) ? (i + 64) : len;
+        for ( ; i < end; i++)
+        {
+            if (((fdc_raw_track[i] == 0xFB) || (fdc_raw_track[i] == 0xF8)) && (fdc_raw_track[i-1] == 0xF5)) break;
+        }
+        if ((i >= end) || ((i + 1 + size) > len)) continue;
+        i++;
+
+        if ((size == Geom.sectorSize) && (sector >= Geom.startSector) && ((sector - Geom.startSector) < Geom.sectors))
+        {
+            memcpy(&FDC.track_buffer[(sector - Geom.startSector) * Geom.sectorSize], &fdc_raw_track[i], size);
+        }
+        i += size;
+    }
+
+    FDC.track_dirty = 1;
+    if (FDC.track < sizeof(FDC.write_tracks)) FDC.write_tracks[FDC.track] = 1;
+    FDC.disk_write = 1;
+    fdc_flush_track();
+}
+
 
 // Status Register for WD2793
 //   Bit |      Type I      |    Type II    |   Type III    |
@@ -106,11 +360,17 @@ void fdc_state_machine(void)
     {
         if ((Geom.fdc_type == WD2793) && !(FDC.status & 0x80))     // Is drive ready on WD2793
         {
-           if (++FDC.indexPulseCounter & 0xF0) FDC.status |= 0x02; else FDC.status &= ~0x02; // Produce some fake index pulses
+            if (fdc_timing)
+            {
+                // The index hole comes around once per revolution - but only once the motor is up to speed
+                u32 now = fdc_now();
+                if (FDC.motor && ((s32)(now - FDC.motor_ready_clock) >= 0) && ((now % FDC_CYCLES_PER_REV) < FDC_CYCLES_INDEX_PULSE)) FDC.status |= 0x02; else FDC.status &= ~0x02;
+            }
+            else if (++FDC.indexPulseCounter & 0xF0) FDC.status |= 0x02; else FDC.status &= ~0x02; // Produce some fake index pulses
         }
     }
     
-    if (bFireDiskIRQ)
+    if (bFireDiskIRQ && (!fdc_timing || fdc_event_due()))
     {
         bFireDiskIRQ=0;
         FDC.status &= ~0x03;                // Done. No longer busy. No data ready.
@@ -122,6 +382,8 @@ void fdc_state_machine(void)
     // If we are processing a command...
     if (FDC.status & 0x01)
     {
+        if (fdc_timing && (FDC.commandType == 1) && !fdc_event_due()) return;  // Head is still stepping or settling
+
         switch(FDC.command & 0xF0)
         {
             case 0x00: // Restore - same as Seek Track except track=0
@@ -148,7 +410,7 @@ void fdc_state_machine(void)
                     }
                     else // Inwards
                     {
-                        FDC.track++;
+                        if (FDC.track < FDC_MAX_TRACK) FDC.track++;
                     }
                     FDC.status |= (FDC.track ? 0x24 : 0x20);    // Motor Spun Up / Heads Engaged... Check if Track zero
                     FDC.status &= ~0x01;                        // Not busy
@@ -161,7 +423,7 @@ void fdc_state_machine(void)
                 if (FDC.status & 0x01)
                 {
                     FDC.stepDirection = 0; // Step inwards
-                    FDC.track++;
+                    if (FDC.track < FDC_MAX_TRACK) FDC.track++;
                     FDC.status |= (FDC.track ? 0x24 : 0x20);    // Motor Spun Up / Heads Engaged... Check if Track zero
                     FDC.status &= ~0x01;                        // Not busy
                     disk_intrq();                               // Let CPU know we're done with command
@@ -185,21 +447,24 @@ void fdc_state_machine(void)
 
             case 0x80: // Read Sector (single)
             case 0x90: // Read Sector (multiple)
-                if (FDC.wait_for_read == 0) // Is the FDC.data register ready for new data?
+                if ((FDC.wait_for_read == 0) && (!fdc_timing || fdc_event_due())) // Is the FDC.data register ready for new data?
                 {
                     FDC.status |= 0x03;                                  // Data Ready and no errors... still busy
                     FDC.data = FDC.track_buffer[FDC.track_buffer_idx++]; // Read data from our track buffer
                     FDC.wait_for_read = 1;                               // Wait for the CPU to fetch the data before re-filling the FDC.data buffer
+                    FDC.event_clock += FDC_CYCLES_PER_BYTE;              // Next byte comes around one byte-time later
 
                     if (++FDC.sector_byte_counter >= Geom.sectorSize)    // Did we cross a sector boundary?
                     {
                         if (FDC.command & 0x10) FDC.sector++;       // Bump the sector number only if multiple sector command
                         FDC.sector_byte_counter = 0;                // And reset our counter
+                        if (fdc_timing) FDC.event_clock = fdc_sector_arrival(FDC.sector, FDC.event_clock + (2 * FDC_CYCLES_PER_BYTE));
                     }
 
                     if (FDC.track_buffer_idx >= FDC.track_buffer_end) // Is there any more data to put out?
                     {
-                        FDC.status &= ~0x02;
+                        if (fdc_timing) FDC.event_clock = fdc_now() + (2 * FDC_CYCLES_PER_BYTE);   // Leave the last byte readable while the CRC goes by
+                        else FDC.status &= ~0x02;
                         bFireDiskIRQ = 1;
                     }
                 }
@@ -208,15 +473,31 @@ void fdc_state_machine(void)
 
             case 0xA0: // Write Sector (single)
             case 0xB0: // Write Sector (multiple)
+                if (FDC.drq_pending && fdc_event_due())         // Accurate timing: has the next byte slot come around?
+                {
+                    FDC.drq_pending = 0;
+                    FDC.status |= 0x02;
+                }
+
                 if (FDC.wait_for_write == 0)
                 {
                     FDC.track_dirty = 1;
-                    FDC.write_tracks[FDC.track] = 1;
+                    if (FDC.track < sizeof(FDC.write_tracks)) FDC.write_tracks[FDC.track] = 1;
                     FDC.disk_write = 1;
                     FDC.track_buffer[FDC.track_buffer_idx++] = FDC.data; // Store CPU byte into our FDC buffer
 
                     if (FDC.track_buffer_idx >= FDC.track_buffer_end)
                     {
+                        if (fdc_timing)
+                        {
+                            FDC.status &= ~0x02;            // No more data wanted... still busy while the CRC is written
+                            FDC.wait_for_write=2;           // Don't write more FDC data
+                            FDC.sector_byte_counter = 0;    // And reset our counter
+                            fdc_flush_track();              // Write the buffer back out
+                            FDC.event_clock = fdc_now() + (2 * FDC_CYCLES_PER_BYTE);
+                            bFireDiskIRQ = 1;               // Interrupt once the CRC has gone by
+                            break;
+                        }
                         FDC.status &= ~0x01;            // Done. No longer busy.
                         FDC.wait_for_write=2;           // Don't write more FDC data
                         FDC.sector_byte_counter = 0;    // And reset our counter
@@ -225,20 +506,41 @@ void fdc_state_machine(void)
                     }
                     else
                     {
-                        FDC.status |= 0x03;                     // Data Ready and no errors... still busy
+                        if (fdc_timing)
+                        {
+                            FDC.status = (FDC.status | 0x01) & ~0x02;   // Still busy - data request comes with the next byte slot
+                            FDC.drq_pending = 1;
+                            FDC.event_clock = fdc_now() + FDC_CYCLES_PER_BYTE;
+                        }
+                        else FDC.status |= 0x03;                // Data Ready and no errors... still busy
                         FDC.wait_for_write = 1;                 // Wait for the CPU to give us more data
                         if (++FDC.sector_byte_counter >= Geom.sectorSize)   // Did we cross a sector boundary?
                         {
                             if (FDC.command & 0x10) FDC.sector++;   // Bump the sector number only if multiple sector command
                             FDC.sector_byte_counter = 0;            // And reset our counter
+                            if (fdc_timing) FDC.event_clock = fdc_sector_arrival(FDC.sector, FDC.event_clock + (2 * FDC_CYCLES_PER_BYTE));
                         }
                     }
                 }
                 break;
 
             case 0xC0: // Read Address
-                FDC.status &= ~0x01;                        // Not handled yet... just clear busy
-                disk_intrq();                               // Let CPU know we're done with command
+            case 0xE0: // Read Track
+                if ((FDC.wait_for_read == 0) && (!fdc_timing || fdc_event_due())) // Is the FDC.data register ready for new data?
+                {
+                    FDC.status |= 0x03;                                  // Data Ready and no errors... still busy
+                    FDC.data = fdc_raw_track[FDC.track_buffer_idx++];    // Read data from our raw track stream
+                    FDC.wait_for_read = 1;                               // Wait for the CPU to fetch the data
+                    FDC.event_clock += FDC_CYCLES_PER_BYTE;              // Next byte comes around one byte-time later
+
+                    if (FDC.track_buffer_idx >= FDC.track_buffer_end)    // Is there any more data to put out?
+                    {
+                        if ((FDC.command & 0xF0) == 0xC0) FDC.sector = fdc_raw_track[0]; // Read Address leaves the ID track number in the sector register
+                        if (fdc_timing) FDC.event_clock = fdc_now() + FDC_CYCLES_PER_BYTE;
+                        else FDC.status &= ~0x02;
+                        bFireDiskIRQ = 1;
+                    }
+                }
                 break;
 
             case 0xD0: // Force Interrupt
@@ -246,11 +548,44 @@ void fdc_state_machine(void)
                 disk_intrq();                               // Let CPU know we're done with command
                 break;
 
-            case 0xE0: // Read Track
-                FDC.status &= ~0x01;                        // Not handled yet... just clear busy
-                break;
             case 0xF0: // Write Track
-                FDC.status &= ~0x01;                        // Not handled yet... just clear busy
+                if (FDC.drq_pending && fdc_event_due())         // Accurate timing: has the next byte slot come around?
+                {
+                    FDC.drq_pending = 0;
+                    FDC.status |= 0x02;
+                }
+
+                if (FDC.wait_for_write == 0)
+                {
+                    fdc_raw_track[FDC.write_track_byte_counter++] = FDC.data; // Just collect the stream - it gets parsed once the track is done
+
+                    if (FDC.write_track_byte_counter >= FDC_RAW_TRACK_LEN)  // Back around to the index hole?
+                    {
+                        fdc_parse_raw_track(FDC.write_track_byte_counter);  // Turn the stream back into sectors
+                        FDC.write_track_byte_counter = 0;
+                        FDC.wait_for_write=2;                               // Don't write more FDC data
+                        if (fdc_timing)
+                        {
+                            FDC.status &= ~0x02;
+                            FDC.event_clock = fdc_now();
+                            bFireDiskIRQ = 1;
+                            break;
+                        }
+                        FDC.status &= ~0x01;                                // Done. No longer busy.
+                        disk_intrq();                                       // Let CPU know we're done with command
+                    }
+                    else
+                    {
+                        if (fdc_timing)
+                        {
+                            FDC.status = (FDC.status | 0x01) & ~0x02;       // Still busy - data request comes with the next byte slot
+                            FDC.drq_pending = 1;
+                            FDC.event_clock += FDC_CYCLES_PER_BYTE;
+                        }
+                        else FDC.status |= 0x03;                            // Data Ready and no errors... still busy
+                        FDC.wait_for_write = 1;                             // Wait for the CPU to give us more data
+                    }
+                }
                 break;
             default: break;
         }
@@ -279,6 +614,7 @@ u8 fdc_read(u8 addr)
         case 3:
             FDC.status &= ~0x02;     // Clear Data Available flag
             FDC.wait_for_read = 0;   // Clock in next byte (or end sequence if we're read all there is)
+            if (fdc_timing) fdc_check_halt();
             return FDC.data;         // Return previous data to caller
     }
 
@@ -322,6 +658,8 @@ void fdc_write(u8 addr, u8 data)
 
     if (FDC.drive >= Geom.drives) return; // Make sure this is a valid drive before we process anything below...
 
+    if (fdc_timing && (addr == 3)) fdc_check_halt(); // Accurate timing: CPU may have to wait for the next byte slot
+
     // ---------------------------------------------------------
     // If command.... we must set the right bits in the status
     // register based on what kind of controller we have.
@@ -335,13 +673,28 @@ void fdc_write(u8 addr, u8 data)
             {
                 return;                    // We were given a command while busy - ignore it.
             }
-            else FDC.command = data;       // Otherwise the last command was a Force Interrupt
         }
 
+        // Latch the command here - the state machine above may have just finished the last one (so the
+        // register write came in while busy and was skipped) and it must not carry on with the old command
+        FDC.command = data;
+
         if ((data & 0x80) == 0) // Is this a Type-I command?
         {
             FDC.commandType = 1;                            // Type-I command
             FDC.status = (data & 0x08) ? 0x21:0x01;         // We are now busy with a command - all type 1 commands check if engage the head
+            fdc_stat_commands++;
+
+            if (fdc_timing)                                 // Work out how long the head takes to step and settle
+            {
+                static const u8 step_rate_ms[4] = {6, 12, 20, 30};  // r1r0 step rates for the WD2793 at 1MHz
+                u8 steps = 1;
+
+                if ((data&0xF0) == 0x00)      steps = FDC.track;
+                else if ((data&0xF0) == 0x10) steps = (FDC.data > FDC.track) ? (FDC.data - FDC.track) : (FDC.track - FDC.data);
+
+                FDC.event_clock = fdc_now() + (steps * step_rate_ms[data & 0x03] * FDC_CYCLES_PER_MS) + ((data & 0x04) ? FDC_CYCLES_SETTLE : 0);
+            }
 
             if ((data&0xF0) == 0x00)                        // Restore (Seek Track 0)
             {
@@ -360,6 +713,8 @@ void fdc_write(u8 addr, u8 data)
         {
             FDC.commandType = (data & 0x40) ? 3:2;          // Type-II or Type-III
             FDC.status = 0x01;                              // All Type-II or III set busy and we assume drive is ready
+            FDC.drq_pending = 0;                            // No data request scheduled yet
+            fdc_stat_commands++;
 
             if ((data & 0xF0) == 0xD0)     // Force Interrupt... ensure we are back to Type-I status...
             {
@@ -369,6 +724,13 @@ void fdc_write(u8 addr, u8 data)
                 FDC.wait_for_write = 2;                       // Not writing any data
                 FDC.commandType = 1;                          // Allthough Force Interrupt is a Type-IV command, we are back to Type-I status
             }
+            else if ((((data&0xF0) >= 0x80) && ((data&0xF0) <= 0xB0)) && !fdc_sector_ok()) // Read/Write Sector with no such sector on our disk
+            {
+                FDC.status = 0x10;                                                          // Record Not Found and no longer busy
+                FDC.wait_for_read = 2;                                                      // Not feteching any data
+                FDC.wait_for_write = 2;                                                     // Not writing any data
+                disk_intrq();                                                               // Let CPU know we're done with command
+            }
             else if (((data&0xF0) == 0x80) || ((data&0xF0) == 0x90)) // Read Sector... either single or multiple
             {
                 fdc_buffer_track();                                                         // Get track into our buffer
@@ -377,7 +739,12 @@ void fdc_write(u8 addr, u8 data)
                 FDC.wait_for_read = 0;                                                      // Start fetching data
                 FDC.sector_byte_counter = 0;                                                // Reset our fetch counter
                 if (io_show_status == 0) io_show_status = 4;                                // And let the world know we are reading...
-                FDC.status |= 0x03;                                                         // Data Ready and no errors... still busy
+                if (fdc_timing)                                                             // First byte shows up once the sector comes around
+                {
+                    FDC.event_clock = fdc_sector_arrival(FDC.sector, fdc_command_start() + ((data & 0x04) ? FDC_CYCLES_SETTLE : 0));
+                    fdc_check_halt();
+                }
+                else FDC.status |= 0x03;                                                    // Data Ready and no errors... still busy
             }
             else if (((data&0xF0) == 0xA0) || ((data&0xF0) == 0xB0)) // Write Sector... either single or multiple
             {
@@ -387,15 +754,51 @@ void fdc_write(u8 addr, u8 data)
                 FDC.sector_byte_counter = 0;                                                // Reset our sector byte counter
                 FDC.wait_for_write = 1;                                                     // Start the Write Process... we allow data immediately
                 io_show_status = 5;                                                         // And let the world know we are writing...
-                FDC.status |= 0x03;                                                         // Data Ready and no errors... still busy
+                if (fdc_timing)                                                             // First data request once the sector comes around
+                {
+                    FDC.event_clock = fdc_sector_arrival(FDC.sector, fdc_command_start() + ((data & 0x04) ? FDC_CYCLES_SETTLE : 0));
+                    FDC.drq_pending = 1;
+                    fdc_check_halt();
+                }
+                else FDC.status |= 0x03;                                                    // Data Ready and no errors... still busy
+            }
+            else if ((data&0xF0) == 0xC0) // Read Address
+            {
+                u8 sector_idx = fdc_id_rotor++ % Geom.sectors;                              // Instant timing: just take the next ID around the track
+                if (fdc_timing)                                                             // Otherwise find the next ID field to reach the head
+                {
+                    u32 start = fdc_command_start() + ((data & 0x04) ? FDC_CYCLES_SETTLE : 0);
+                    u8  slot = ((start % FDC_CYCLES_PER_REV) / (FDC_CYCLES_PER_REV / Geom.sectors) + 1) % Geom.sectors;
+                    for (u8 i=0; (i < Geom.sectors) && (i < 32); i++) if (fdc_sector_slot[i] == slot) sector_idx = i;
+                    FDC.event_clock = fdc_sector_arrival(sector_idx + Geom.startSector, start) - (FDC_BYTES_ID_TO_DATA * FDC_CYCLES_PER_BYTE);
+                }
+                fdc_build_id_field(fdc_raw_track, sector_idx);                              // Six bytes: track, side, sector, size and CRC
+                FDC.track_buffer_idx = 0;
+                FDC.track_buffer_end = 6;
+                FDC.wait_for_read = 0;                                                      // Start fetching data
+                if (fdc_timing) fdc_check_halt(); else FDC.status |= 0x03;                  // Data Ready and no errors... still busy
             }
             else if ((data&0xF0) == 0xE0) // Read Track
             {
-                // Not implemented yet...
+                fdc_build_raw_track();                                                      // Synthesize the whole track as it would come off the disk
+                FDC.track_buffer_idx = 0;
+                FDC.track_buffer_end = FDC_RAW_TRACK_LEN;
+                FDC.wait_for_read = 0;                                                      // Start fetching data
+                if (io_show_status == 0) io_show_status = 4;                                // And let the world know we are reading...
+                if (fdc_timing)                                                             // Read Track always starts at the index hole
+                {
+                    FDC.event_clock = fdc_next_index(fdc_command_start() + ((data & 0x04) ? FDC_CYCLES_SETTLE : 0));
+                    fdc_check_halt();
+                }
+                else FDC.status |= 0x03;                                                    // Data Ready and no errors... still busy
             }
             else if ((data&0xF0) == 0xF0) // Write Track (format)
             {
-                // Not implemented yet...
+                FDC.write_track_byte_counter = 0;                                           // Collect a fresh track worth of raw bytes
+                FDC.wait_for_write = 1;                                                     // Data request goes out immediately
+                io_show_status = 5;                                                         // And let the world know we are writing...
+                FDC.status |= 0x03;                                                         // First byte must be loaded before the index hole
+                if (fdc_timing) FDC.event_clock = fdc_next_index(fdc_command_start() + ((data & 0x04) ? FDC_CYCLES_SETTLE : 0));
             }
         }
     }
@@ -413,9 +816,35 @@ void fdc_setSide(u8 side)
 
 void fdc_setMotor(u8 onOff)
 {
+    if (onOff && !FDC.motor)                // Motor just switched on... it takes a moment to come up to speed
+    {
+        FDC.motor_ready_clock = fdc_now() + FDC_CYCLES_SPINUP;
+    }
     FDC.motor = onOff;                      // Record motor on/off
 }
 
+// ---------------------------------------------------------------------------------------------
+// Called once per scanline when a disk system is present. This keeps the rotation clock moving
+// and, under the accurate timing policy, lets scheduled events happen even while the CPU is
+// sitting on the HALT line and not touching the controller at all.
+// ---------------------------------------------------------------------------------------------
+ITCM_CODE void fdc_tick(void)
+{
+    FDC.clock += FDC_CYCLES_PER_LINE;
+
+    if (FDC.status & 0x01)
+    {
+        fdc_stat_busy_cycles += FDC_CYCLES_PER_LINE;
+
+        if (fdc_timing && ((s32)(FDC.clock - FDC.event_clock) >= 0))
+        {
+            fdc_state_machine();
+            if (cpu.halt_asserted && ((FDC.status & 0x03) != 0x01)) cpu_halt(0);  // Data request or command done - release the CPU
+        }
+    }
+    else if (cpu.halt_asserted) cpu_halt(0);    // Never leave the CPU held once the controller is idle
+}
+
 void fdc_reset(u8 full_reset)
 {
     if (full_reset)
@@ -427,6 +856,8 @@ void fdc_reset(u8 full_reset)
     FDC.commandType = 1;                                 // We are back to Type I
     FDC.wait_for_read = 2;                               // Not feteching any data
     FDC.wait_for_write = 2;                              // Not storing any data
+    FDC.drq_pending = 0;                                 // No data request scheduled
+    bFireDiskIRQ = 0;                                    // No interrupt pending
 }
 
 void fdc_init(u8 fdc_type, u8 drives, u8 sides, u8 tracks, u8 sectors, u16 sectorSize, u8 startSector, u8 *diskBuffer0, u8 *diskBuffer1)
@@ -440,6 +871,12 @@ void fdc_init(u8 fdc_type, u8 drives, u8 sides, u8 tracks, u8 sectors, u16 secto
     Geom.disk0      = diskBuffer0;                      // Pointer to the first raw sector dump drive
     Geom.disk1      = diskBuffer1;                      // Pointer to the second raw sector dump drive
     Geom.startSector= startSector;                      // Starting sector (some systems like CoCo will start sector numbering at 1)
+
+    // Our track buffer and interleave table are fixed in size - never describe a track bigger than they can hold
+    if (Geom.sectors > 32) Geom.sectors = 32;
+    if ((Geom.sectors * Geom.sectorSize) > sizeof(FDC.track_buffer)) Geom.sectors = sizeof(FDC.track_buffer) / Geom.sectorSize;
+
+    fdc_build_interleave();                             // Sector layout for the accurate timing model
 }
 
 // End of file
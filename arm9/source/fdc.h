@@ -15,6 +15,25 @@
 #define WD1770  0
 #define WD2793  1
 
+// Disk timing policy - selected on a per-game basis
+#define FDC_TIMING_INSTANT      0   // Commands complete as fast as the guest can poll (default)
+#define FDC_TIMING_ACCURATE     1   // Rotation, step rate, spin-up and byte rate driven by emulated CPU cycles
+
+// Timing constants - all expressed in 0.894886MHz CPU cycles (the FDC is clocked at 1MHz on the CoCo)
+#define FDC_CYCLES_PER_LINE     57                          // Same as one scanline of CPU
+#define FDC_CYCLES_PER_MS       895                         // Near enough to 1 millisecond
+#define FDC_CYCLES_PER_REV      178977                      // 300 RPM is one revolution every 200ms
+#define FDC_CYCLES_INDEX_PULSE  (2 * FDC_CYCLES_PER_MS)     // Index hole is under the sensor for about 2ms
+#define FDC_CYCLES_SPINUP       FDC_CYCLES_PER_REV          // Give the motor one full revolution to come up to speed
+#define FDC_CYCLES_SETTLE       (30 * FDC_CYCLES_PER_MS)    // Head settle time for the 'v' and 'e' flags at 1MHz
+#define FDC_CYCLES_PER_BYTE     29                          // 250Kbps MFM is 32us per byte
+#define FDC_BYTES_ID_TO_DATA    43                          // ID field + CRC + Gap 2 + sync + data address mark
+#define FDC_CYCLES_HALT_STALL   FDC_CYCLES_PER_LINE         // Waits shorter than this just stall the CPU inline
+#define FDC_SKIP_FACTOR         4                           // Standard Disk BASIC DSKINI interleave
+#define FDC_RAW_TRACK_LEN       6250                        // Unformatted bytes on one double density track at 300 RPM
+#define FDC_RAW_SECTOR_OVERHEAD 82                          // Sync, ID mark + field + CRC, Gap 2, sync, DAM, data CRC and Gap 3 per sector
+#define FDC_MAX_TRACK           80                          // The head can't be stepped in any further than this
+
 // The Tandy CoCo FDC controller - we only allow for single sided 40 track max
 struct FDC_t
 {
@@ -31,7 +50,7 @@ struct FDC_t
     u8  commandType;
     u8  write_track_allowed;
     u8  stepDirection;
-    u8  spare;
+    u8  drq_pending;         // Accurate timing: data request will be raised once event_clock is reached
     u8  track_dirty;         // True if the track must be written back to the main buffer
     u8  disk_write;          // True if the disk has been written and not saved
     u8  write_tracks[40];    // Up to 40 tracks can be marked as needing writing
@@ -41,6 +60,9 @@ struct FDC_t
     u16 indexPulseCounter;
     u16 sector_byte_counter;
     u16 write_track_byte_counter;
+    u32 clock;               // Free-running rotation clock in CPU cycles (wraps harmlessly)
+    u32 event_clock;         // Accurate timing: when the next step of the current command is due
+    u32 motor_ready_clock;   // Accurate timing: when the spindle motor is up to speed
 };
 
 struct FDC_GEOMETRY_t
@@ -60,6 +82,9 @@ extern struct FDC_t             FDC;
 extern struct FDC_GEOMETRY_t    Geom;
 
 extern u8 io_show_status;
+extern u8 fdc_timing;
+extern u32 fdc_stat_commands;
+extern u32 fdc_stat_busy_cycles;
 
 extern u8   fdc_read(u8 addr);
 extern void fdc_write(u8 addr, u8 data);
@@ -67,6 +92,7 @@ extern void fdc_setSide(u8 side);
 extern void fdc_setDrive(u8 drive);
 extern void fdc_setMotor(u8 onOff);
 extern void fdc_reset(u8 full_reset);
+extern void fdc_tick(void);
 extern void fdc_init(u8 fdc_type, u8 drives, u8 sides, u8 tracks, u8 sectors, u16 sectorSize, u8 startSector, u8 *diskBuffer0, u8 *diskBuffer1);
 
 #endif //_FDC_H
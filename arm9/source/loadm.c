@@ -0,0 +1,227 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#include <nds.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "DracoDS.h"
+#include "DracoUtils.h"
+#include "cpu.h"
+#include "mem.h"
+#include "pia.h"
+#include "saveload.h"
+
+#include "loadm.h"
+
+// ---------------------------------------------------------------------------------------
+// Rather than typing CLOADM or LOADM and waiting on the tape or disk, we pull a machine
+// language program straight out of the .CAS or .DSK image, drop it into RAM and jump to
+// it - exactly as BASIC would have after an EXEC. Everything is checked before a single
+// byte of RAM is touched so if anything looks unusual we return 0 and the caller falls
+// back to typing the command. The tape/disk stays mounted so a game that goes on to load
+// more from either finds it right where BASIC would have left it.
+// ---------------------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------------------
+// Only safe with BASIC sitting at the OK prompt. During the cold start BASIC may still
+// clear the RAM we inject into, and with CC.I set we're inside an interrupt handler
+// (START can land on the VSYNC IRQ) and the program would return into the middle of it.
+// ---------------------------------------------------------------------------------------
+static u8 loadm_allowed(void)
+{
+    return (boot_at_ok_prompt() && !(cpu_get_cc() & LOADM_CC_IRQ_MASK));
+}
+
+// Hand control to the program as if BASIC had called it - an RTS goes back to where BASIC was waiting
+static void loadm_exec(u16 exec)
+{
+    memory_RAM[LOADM_EXECJP+0] = exec >> 8;
+    memory_RAM[LOADM_EXECJP+1] = exec & 0xFF;
+
+    memory_RAM[--cpu.s] = cpu.pc & 0xFF;
+    memory_RAM[--cpu.s] = cpu.pc >> 8;
+    cpu.pc = exec;
+}
+
+// ---------------------------------------------------------------------------------------
+// Find the next block on the tape at or after 'pos'. Returns the position just past the
+// block or 0 if there isn't a complete block with a good checksum.
+// ---------------------------------------------------------------------------------------
+static u32 tape_block(u32 pos, u8 *type, u8 *len, u32 *data)
+{
+    for (; (pos + 4) < last_file_size; pos++)
+    {
+        if ((TapeCartDiskBuffer[pos] != 0x55) || (TapeCartDiskBuffer[pos+1] != 0x3C)) continue;
+
+        *type = TapeCartDiskBuffer[pos+2];
+        *len  = TapeCartDiskBuffer[pos+3];
+        *data = pos + 4;
+        if ((*data + *len) >= last_file_size) return 0;
+
+        u8 sum = *type + *len;
+        for (u16 i=0; i<*len; i++) sum += TapeCartDiskBuffer[*data + i];
+        if (sum != TapeCartDiskBuffer[*data + *len]) return 0;
+
+        return *data + *len + 1;
+    }
+    return 0;
+}
+
+// Walk the file from the current tape position. Only writes to RAM if 'inject' is set.
+static u32 tape_loadm(u8 inject, u16 *exec)
+{
+    u8 type, len;
+    u32 data;
+    u32 pos = tape_block(tape_pos, &type, &len, &data);
+
+    // Namefile: name[8], file type, ASCII flag, gap flag, exec address, load address
+    if (!pos || (type != CAS_BLOCK_NAMEFILE) || (len < 15)) return 0;
+    if ((TapeCartDiskBuffer[data+8] != CAS_FILE_TYPE_MACHINE) || TapeCartDiskBuffer[data+9]) return 0;
+
+    *exec    = (TapeCartDiskBuffer[data+11] << 8) | TapeCartDiskBuffer[data+12];
+    u32 addr = (TapeCartDiskBuffer[data+13] << 8) | TapeCartDiskBuffer[data+14];
+
+    while ((pos = tape_block(pos, &type, &len, &data)))
+    {
+        if (type == CAS_BLOCK_EOF) return pos;
+        if (type != CAS_BLOCK_DATA) return 0;
+        if ((addr + len) > LOADM_RAM_TOP) return 0;
+
+        if (inject) memcpy(&memory_RAM[addr], &TapeCartDiskBuffer[data], len);
+        addr += len;
+    }
+    return 0;
+}
+
+u8 LoadmFromTape(void)
+{
+    u16 exec;
+
+    if (!loadm_allowed() || !tape_loadm(0, &exec)) return 0;
+
+    tape_pos = tape_loadm(1, &exec);     // Leave the tape just past this file
+    cas_eof  = 0;
+    loadm_exec(exec);
+
+    return 1;
+}
+
+// ---------------------------------------------------------------------------------------
+// Disk: find the file in the directory, follow its granules through the FAT gathering it
+// into CompressBuffer and then walk the DECB segments - $00 len addr data... and finally
+// $FF $0000 exec.
+// ---------------------------------------------------------------------------------------
+static u32 disk_granule_offset(u8 granule)
+{
+    u8 track = granule / 2;
+    if (track >= DECB_DIR_TRACK) track++;   // The directory track is never part of a file
+    return ((track * DECB_SECTORS) + ((granule & 1) * DECB_GRANULE_SECTORS)) * DECB_SECTOR_SIZE;
+}
+
+// Does this directory entry match the name (up to the '.' or ']') from the game's filename?
+static u8 disk_name_match(const u8 *entry, const char *name)
+{
+    for (u8 i=0; i<8; i++)
+    {
+        char ch = (name[i] && (name[i] != '.') && (name[i] != ']')) ? toupper((int)name[i]) : ' ';
+        if (entry[i] != ch) return 0;
+        if (ch == ' ') break;
+    }
+    return 1;
+}
+
+static u32 disk_read_file(const u8 *entry)
+{
+    const u8 *fat = &TapeCartDiskBuffer[DECB_FAT_OFFSET];
+    u16 last_bytes = (entry[14] << 8) | entry[15];
+    u8  granule    = entry[13];
+    u32 len        = 0;
+
+    if (last_bytes > DECB_SECTOR_SIZE) return 0;
+
+    for (u8 n=0; n<DECB_GRANULES; n++)
+    {
+        if (granule >= DECB_GRANULES) return 0;
+
+        u32 offset  = disk_granule_offset(granule);
+        u8  next    = fat[granule];
+        u8  sectors = (next >= 0xC0) ? (next & 0x0F) : DECB_GRANULE_SECTORS;
+        u32 bytes   = sectors * DECB_SECTOR_SIZE;
+
+        if (sectors > DECB_GRANULE_SECTORS) return 0;
+        if ((next >= 0xC0) && sectors) bytes -= (DECB_SECTOR_SIZE - last_bytes);
+        if (((offset + bytes) > last_file_size) || ((len + bytes) > sizeof(CompressBuffer))) return 0;
+
+        memcpy(&CompressBuffer[len], &TapeCartDiskBuffer[offset], bytes);
+        len += bytes;
+
+        if (next >= 0xC0) return len;
+        granule = next;
+    }
+    return 0;   // Granules chained in a loop
+}
+
+static u8 disk_loadm(u32 len, u8 inject, u16 *exec)
+{
+    u32 pos = 0;
+
+    while ((pos + 5) <= len)
+    {
+        u16 seg_len  = (CompressBuffer[pos+1] << 8) | CompressBuffer[pos+2];
+        u16 seg_addr = (CompressBuffer[pos+3] << 8) | CompressBuffer[pos+4];
+
+        if (CompressBuffer[pos] == 0xFF)
+        {
+            *exec = seg_addr;
+            return 1;
+        }
+        if (CompressBuffer[pos] != 0x00) return 0;
+        if (((pos + 5 + seg_len) > len) || ((seg_addr + seg_len) > LOADM_RAM_TOP)) return 0;
+
+        if (inject) memcpy(&memory_RAM[seg_addr], &CompressBuffer[pos+5], seg_len);
+        pos += 5 + seg_len;
+    }
+    return 0;
+}
+
+u8 LoadmFromDisk(const char *name)
+{
+    const u8 *entry = &TapeCartDiskBuffer[DECB_DIR_OFFSET];
+    u16 exec;
+    u8 i;
+
+    if (!loadm_allowed()) return 0;
+    if (last_file_size < (DECB_DIR_OFFSET + (DECB_DIR_ENTRIES * DECB_DIR_ENTRY_SIZE))) return 0;
+
+    // With no name we take the first file - same as the START key does when typing
+    for (i=0; i<DECB_DIR_ENTRIES; i++, entry += DECB_DIR_ENTRY_SIZE)
+    {
+        if (entry[0] == 0xFF) return 0;     // End of the directory
+        if (entry[0] == 0x00) continue;     // Deleted
+        if (!name || disk_name_match(entry, name)) break;
+    }
+    if (i == DECB_DIR_ENTRIES) return 0;
+
+    if ((entry[11] != DECB_FILE_TYPE_MACHINE) || entry[12]) return 0;
+
+    u32 len = disk_read_file(entry);
+    if (!len || !disk_loadm(len, 0, &exec)) return 0;
+
+    disk_loadm(len, 1, &exec);
+    loadm_exec(exec);
+
+    return 1;
+}
+
+// End of file
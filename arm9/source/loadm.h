@@ -0,0 +1,51 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#ifndef _LOADM_H_
+#define _LOADM_H_
+
+#include <nds.h>
+
+#define LOADM_EXECJP            0x009D      // BASIC's EXEC address - same place on the CoCo and the Dragon
+#define LOADM_RAM_TOP           0x8000      // We only inject into the RAM that is visible with the ROMs mapped
+#define LOADM_CC_IRQ_MASK       0x10        // CC.I - set while BASIC is servicing an interrupt
+
+// ---------------------------------------------------------------------------------------
+// Cassette blocks: a leader of $55 bytes, a $3C sync byte, then type, length, data and a
+// checksum of everything after the sync. The namefile block gives the load/exec address.
+// ---------------------------------------------------------------------------------------
+#define CAS_BLOCK_NAMEFILE      0x00
+#define CAS_BLOCK_DATA          0x01
+#define CAS_BLOCK_EOF           0xFF
+
+#define CAS_FILE_TYPE_MACHINE   0x02
+
+// ---------------------------------------------------------------------------------------
+// Disk Extended Color BASIC disks: 35 tracks of 18 x 256 byte sectors. Track 17 holds
+// the FAT (sector 2) and directory (sectors 3-11). Files are chained in granules of
+// half a track - the FAT entry is the next granule or $C0 + sectors used in the last.
+// ---------------------------------------------------------------------------------------
+#define DECB_SECTOR_SIZE        256
+#define DECB_SECTORS            18
+#define DECB_DIR_TRACK          17
+#define DECB_FAT_OFFSET         (((DECB_DIR_TRACK * DECB_SECTORS) + 1) * DECB_SECTOR_SIZE)
+#define DECB_DIR_OFFSET         (((DECB_DIR_TRACK * DECB_SECTORS) + 2) * DECB_SECTOR_SIZE)
+#define DECB_DIR_ENTRIES        72
+#define DECB_DIR_ENTRY_SIZE     32
+#define DECB_GRANULES           68
+#define DECB_GRANULE_SECTORS    9
+
+#define DECB_FILE_TYPE_MACHINE  0x02
+
+extern u8 LoadmFromTape(void);
+extern u8 LoadmFromDisk(const char *name);
+
+#endif // _LOADM_H_
@@ -321,8 +321,10 @@ machine_code_t machine_code[] __attribute__((section(".dtcm"))) =
     {ADDR_EXTENDED  , 6}  // 0xff - stu
 };
 
-/* Double byte 0x10 op-codes */
-machine_code_t machine_code_10[] __attribute__((section(".dtcm"))) = 
+/* Double byte 0x10 op-codes - these and the 0x11 op-codes below are
+ * rare enough to live in main RAM and leave the DTCM to the ALU flag table.
+ */
+machine_code_t machine_code_10[] = 
 {
     {ILLEGAL_OP     , 0}, // 0x00
     {ILLEGAL_OP     , 0}, // 0x01
@@ -598,7 +600,7 @@ machine_code_t machine_code_10[] __attribute__((section(".dtcm"))) =
 };
 
 /* Double byte 0x11 op-codes */
-machine_code_t machine_code_11[] __attribute__((section(".dtcm"))) = 
+machine_code_t machine_code_11[] = 
 {
     {ILLEGAL_OP     , 0}, // 0x00
     {ILLEGAL_OP     , 0}, // 0x01
@@ -873,4 +875,308 @@ machine_code_t machine_code_11[] __attribute__((section(".dtcm"))) =
     {ILLEGAL_OP     , 0}  // 0xff
 };
 
+/* Indexed addressing post-byte decode.
+ * One entry per post-byte giving how the effective address is formed,
+ * which index register it uses, whether it is indirect and the extra
+ * cycles on top of the op-code's base count (indirection included).
+ * The 5-bit offset itself is taken from the post-byte.
+ */
+#define     INDX_OFF5               0x00        // EA = 5-bit,R
+#define     INDX_INC1               0x01        // EA = ,R+
+#define     INDX_INC2               0x02        // EA = ,R++
+#define     INDX_DEC1               0x03        // EA = ,-R
+#define     INDX_DEC2               0x04        // EA = ,--R
+#define     INDX_ZERO               0x05        // EA = ,R
+#define     INDX_ACCB               0x06        // EA = B,R
+#define     INDX_ACCA               0x07        // EA = A,R
+#define     INDX_OFF8               0x08        // EA = 8-bit,R     (one more operand byte)
+#define     INDX_OFF16              0x09        // EA = 16-bit,R    (two more operand bytes)
+#define     INDX_ACCD               0x0a        // EA = D,R
+#define     INDX_PC8                0x0b        // EA = 8-bit,PC    (one more operand byte)
+#define     INDX_PC16               0x0c        // EA = 16-bit,PC   (two more operand bytes)
+#define     INDX_EXT                0x0d        // EA = 16-bit      (two more operand bytes)
+#define     INDX_ILLEGAL            0x0e
+#define     INDX_KIND               0x0f
+
+#define     INDX_REG_X              0x00
+#define     INDX_REG_Y              0x10
+#define     INDX_REG_U              0x20
+#define     INDX_REG_S              0x30
+#define     INDX_REG_SHIFT          4
+
+#define     INDX_INDIRECT           0x80
+
+typedef struct
+{
+    uint8_t  mode;          // INDX_xxx kind, INDX_REG_x and INDX_INDIRECT
+    uint8_t  cycles;
+} indexed_mode_t;
+
+indexed_mode_t indexed_mode[] __attribute__((section(".dtcm"))) = 
+{
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x00 - 0,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x01 - 1,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x02 - 2,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x03 - 3,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x04 - 4,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x05 - 5,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x06 - 6,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x07 - 7,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x08 - 8,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x09 - 9,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x0a - 10,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x0b - 11,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x0c - 12,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x0d - 13,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x0e - 14,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x0f - 15,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x10 - -16,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x11 - -15,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x12 - -14,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x13 - -13,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x14 - -12,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x15 - -11,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x16 - -10,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x17 - -9,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x18 - -8,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x19 - -7,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x1a - -6,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x1b - -5,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x1c - -4,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x1d - -3,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x1e - -2,X
+    {INDX_OFF5   | INDX_REG_X                  , 1}, // 0x1f - -1,X
+
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x20 - 0,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x21 - 1,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x22 - 2,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x23 - 3,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x24 - 4,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x25 - 5,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x26 - 6,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x27 - 7,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x28 - 8,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x29 - 9,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x2a - 10,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x2b - 11,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x2c - 12,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x2d - 13,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x2e - 14,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x2f - 15,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x30 - -16,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x31 - -15,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x32 - -14,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x33 - -13,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x34 - -12,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x35 - -11,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x36 - -10,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x37 - -9,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x38 - -8,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x39 - -7,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x3a - -6,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x3b - -5,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x3c - -4,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x3d - -3,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x3e - -2,Y
+    {INDX_OFF5   | INDX_REG_Y                  , 1}, // 0x3f - -1,Y
+
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x40 - 0,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x41 - 1,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x42 - 2,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x43 - 3,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x44 - 4,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x45 - 5,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x46 - 6,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x47 - 7,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x48 - 8,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x49 - 9,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x4a - 10,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x4b - 11,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x4c - 12,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x4d - 13,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x4e - 14,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x4f - 15,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x50 - -16,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x51 - -15,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x52 - -14,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x53 - -13,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x54 - -12,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x55 - -11,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x56 - -10,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x57 - -9,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x58 - -8,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x59 - -7,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x5a - -6,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x5b - -5,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x5c - -4,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x5d - -3,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x5e - -2,U
+    {INDX_OFF5   | INDX_REG_U                  , 1}, // 0x5f - -1,U
+
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x60 - 0,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x61 - 1,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x62 - 2,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x63 - 3,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x64 - 4,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x65 - 5,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x66 - 6,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x67 - 7,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x68 - 8,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x69 - 9,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x6a - 10,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x6b - 11,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x6c - 12,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x6d - 13,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x6e - 14,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x6f - 15,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x70 - -16,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x71 - -15,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x72 - -14,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x73 - -13,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x74 - -12,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x75 - -11,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x76 - -10,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x77 - -9,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x78 - -8,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x79 - -7,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x7a - -6,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x7b - -5,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x7c - -4,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x7d - -3,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x7e - -2,S
+    {INDX_OFF5   | INDX_REG_S                  , 1}, // 0x7f - -1,S
+
+    {INDX_INC1   | INDX_REG_X                  , 2}, // 0x80 - ,X+
+    {INDX_INC2   | INDX_REG_X                  , 3}, // 0x81 - ,X++
+    {INDX_DEC1   | INDX_REG_X                  , 2}, // 0x82 - ,-X
+    {INDX_DEC2   | INDX_REG_X                  , 3}, // 0x83 - ,--X
+    {INDX_ZERO   | INDX_REG_X                  , 0}, // 0x84 - ,X
+    {INDX_ACCB   | INDX_REG_X                  , 1}, // 0x85 - B,X
+    {INDX_ACCA   | INDX_REG_X                  , 1}, // 0x86 - A,X
+    {INDX_ILLEGAL| INDX_REG_X                  , 0}, // 0x87 - illegal
+    {INDX_OFF8   | INDX_REG_X                  , 1}, // 0x88 - n8,X
+    {INDX_OFF16  | INDX_REG_X                  , 4}, // 0x89 - n16,X
+    {INDX_ILLEGAL| INDX_REG_X                  , 0}, // 0x8a - illegal
+    {INDX_ACCD   | INDX_REG_X                  , 4}, // 0x8b - D,X
+    {INDX_PC8    | INDX_REG_X                  , 1}, // 0x8c - n8,PC
+    {INDX_PC16   | INDX_REG_X                  , 5}, // 0x8d - n16,PC
+    {INDX_ILLEGAL| INDX_REG_X                  , 0}, // 0x8e - illegal
+    {INDX_EXT    | INDX_REG_X                  , 5}, // 0x8f - n16
+    {INDX_INC1   | INDX_REG_X | INDX_INDIRECT  , 2}, // 0x90 - [,X+]
+    {INDX_INC2   | INDX_REG_X | INDX_INDIRECT  , 6}, // 0x91 - [,X++]
+    {INDX_DEC1   | INDX_REG_X | INDX_INDIRECT  , 2}, // 0x92 - [,-X]
+    {INDX_DEC2   | INDX_REG_X | INDX_INDIRECT  , 6}, // 0x93 - [,--X]
+    {INDX_ZERO   | INDX_REG_X | INDX_INDIRECT  , 3}, // 0x94 - [,X]
+    {INDX_ACCB   | INDX_REG_X | INDX_INDIRECT  , 4}, // 0x95 - [B,X]
+    {INDX_ACCA   | INDX_REG_X | INDX_INDIRECT  , 4}, // 0x96 - [A,X]
+    {INDX_ILLEGAL| INDX_REG_X | INDX_INDIRECT  , 0}, // 0x97 - illegal [indirect]
+    {INDX_OFF8   | INDX_REG_X | INDX_INDIRECT  , 4}, // 0x98 - [n8,X]
+    {INDX_OFF16  | INDX_REG_X | INDX_INDIRECT  , 7}, // 0x99 - [n16,X]
+    {INDX_ILLEGAL| INDX_REG_X | INDX_INDIRECT  , 0}, // 0x9a - illegal [indirect]
+    {INDX_ACCD   | INDX_REG_X | INDX_INDIRECT  , 7}, // 0x9b - [D,X]
+    {INDX_PC8    | INDX_REG_X | INDX_INDIRECT  , 4}, // 0x9c - [n8,PC]
+    {INDX_PC16   | INDX_REG_X | INDX_INDIRECT  , 8}, // 0x9d - [n16,PC]
+    {INDX_ILLEGAL| INDX_REG_X | INDX_INDIRECT  , 0}, // 0x9e - illegal [indirect]
+    {INDX_EXT    | INDX_REG_X | INDX_INDIRECT  , 5}, // 0x9f - [n16]
+
+    {INDX_INC1   | INDX_REG_Y                  , 2}, // 0xa0 - ,Y+
+    {INDX_INC2   | INDX_REG_Y                  , 3}, // 0xa1 - ,Y++
+    {INDX_DEC1   | INDX_REG_Y                  , 2}, // 0xa2 - ,-Y
+    {INDX_DEC2   | INDX_REG_Y                  , 3}, // 0xa3 - ,--Y
+    {INDX_ZERO   | INDX_REG_Y                  , 0}, // 0xa4 - ,Y
+    {INDX_ACCB   | INDX_REG_Y                  , 1}, // 0xa5 - B,Y
+    {INDX_ACCA   | INDX_REG_Y                  , 1}, // 0xa6 - A,Y
+    {INDX_ILLEGAL| INDX_REG_Y                  , 0}, // 0xa7 - illegal
+    {INDX_OFF8   | INDX_REG_Y                  , 1}, // 0xa8 - n8,Y
+    {INDX_OFF16  | INDX_REG_Y                  , 4}, // 0xa9 - n16,Y
+    {INDX_ILLEGAL| INDX_REG_Y                  , 0}, // 0xaa - illegal
+    {INDX_ACCD   | INDX_REG_Y                  , 4}, // 0xab - D,Y
+    {INDX_PC8    | INDX_REG_Y                  , 1}, // 0xac - n8,PC
+    {INDX_PC16   | INDX_REG_Y                  , 5}, // 0xad - n16,PC
+    {INDX_ILLEGAL| INDX_REG_Y                  , 0}, // 0xae - illegal
+    {INDX_EXT    | INDX_REG_Y                  , 5}, // 0xaf - n16
+    {INDX_INC1   | INDX_REG_Y | INDX_INDIRECT  , 2}, // 0xb0 - [,Y+]
+    {INDX_INC2   | INDX_REG_Y | INDX_INDIRECT  , 6}, // 0xb1 - [,Y++]
+    {INDX_DEC1   | INDX_REG_Y | INDX_INDIRECT  , 2}, // 0xb2 - [,-Y]
+    {INDX_DEC2   | INDX_REG_Y | INDX_INDIRECT  , 6}, // 0xb3 - [,--Y]
+    {INDX_ZERO   | INDX_REG_Y | INDX_INDIRECT  , 3}, // 0xb4 - [,Y]
+    {INDX_ACCB   | INDX_REG_Y | INDX_INDIRECT  , 4}, // 0xb5 - [B,Y]
+    {INDX_ACCA   | INDX_REG_Y | INDX_INDIRECT  , 4}, // 0xb6 - [A,Y]
+    {INDX_ILLEGAL| INDX_REG_Y | INDX_INDIRECT  , 0}, // 0xb7 - illegal [indirect]
+    {INDX_OFF8   | INDX_REG_Y | INDX_INDIRECT  , 4}, // 0xb8 - [n8,Y]
+    {INDX_OFF16  | INDX_REG_Y | INDX_INDIRECT  , 7}, // 0xb9 - [n16,Y]
+    {INDX_ILLEGAL| INDX_REG_Y | INDX_INDIRECT  , 0}, // 0xba - illegal [indirect]
+    {INDX_ACCD   | INDX_REG_Y | INDX_INDIRECT  , 7}, // 0xbb - [D,Y]
+    {INDX_PC8    | INDX_REG_Y | INDX_INDIRECT  , 4}, // 0xbc - [n8,PC]
+    {INDX_PC16   | INDX_REG_Y | INDX_INDIRECT  , 8}, // 0xbd - [n16,PC]
+    {INDX_ILLEGAL| INDX_REG_Y | INDX_INDIRECT  , 0}, // 0xbe - illegal [indirect]
+    {INDX_EXT    | INDX_REG_Y | INDX_INDIRECT  , 5}, // 0xbf - [n16]
+
+    {INDX_INC1   | INDX_REG_U                  , 2}, // 0xc0 - ,U+
+    {INDX_INC2   | INDX_REG_U                  , 3}, // 0xc1 - ,U++
+    {INDX_DEC1   | INDX_REG_U                  , 2}, // 0xc2 - ,-U
+    {INDX_DEC2   | INDX_REG_U                  , 3}, // 0xc3 - ,--U
+    {INDX_ZERO   | INDX_REG_U                  , 0}, // 0xc4 - ,U
+    {INDX_ACCB   | INDX_REG_U                  , 1}, // 0xc5 - B,U
+    {INDX_ACCA   | INDX_REG_U                  , 1}, // 0xc6 - A,U
+    {INDX_ILLEGAL| INDX_REG_U                  , 0}, // 0xc7 - illegal
+    {INDX_OFF8   | INDX_REG_U                  , 1}, // 0xc8 - n8,U
+    {INDX_OFF16  | INDX_REG_U                  , 4}, // 0xc9 - n16,U
+    {INDX_ILLEGAL| INDX_REG_U                  , 0}, // 0xca - illegal
+    {INDX_ACCD   | INDX_REG_U                  , 4}, // 0xcb - D,U
+    {INDX_PC8    | INDX_REG_U                  , 1}, // 0xcc - n8,PC
+    {INDX_PC16   | INDX_REG_U                  , 5}, // 0xcd - n16,PC
+    {INDX_ILLEGAL| INDX_REG_U                  , 0}, // 0xce - illegal
+    {INDX_EXT    | INDX_REG_U                  , 5}, // 0xcf - n16
+    {INDX_INC1   | INDX_REG_U | INDX_INDIRECT  , 2}, // 0xd0 - [,U+]
+    {INDX_INC2   | INDX_REG_U | INDX_INDIRECT  , 6}, // 0xd1 - [,U++]
+    {INDX_DEC1   | INDX_REG_U | INDX_INDIRECT  , 2}, // 0xd2 - [,-U]
+    {INDX_DEC2   | INDX_REG_U | INDX_INDIRECT  , 6}, // 0xd3 - [,--U]
+    {INDX_ZERO   | INDX_REG_U | INDX_INDIRECT  , 3}, // 0xd4 - [,U]
+    {INDX_ACCB   | INDX_REG_U | INDX_INDIRECT  , 4}, // 0xd5 - [B,U]
+    {INDX_ACCA   | INDX_REG_U | INDX_INDIRECT  , 4}, // 0xd6 - [A,U]
+    {INDX_ILLEGAL| INDX_REG_U | INDX_INDIRECT  , 0}, // 0xd7 - illegal [indirect]
+    {INDX_OFF8   | INDX_REG_U | INDX_INDIRECT  , 4}, // 0xd8 - [n8,U]
+    {INDX_OFF16  | INDX_REG_U | INDX_INDIRECT  , 7}, // 0xd9 - [n16,U]
+    {INDX_ILLEGAL| INDX_REG_U | INDX_INDIRECT  , 0}, // 0xda - illegal [indirect]
+    {INDX_ACCD   | INDX_REG_U | INDX_INDIRECT  , 7}, // 0xdb - [D,U]
+    {INDX_PC8    | INDX_REG_U | INDX_INDIRECT  , 4}, // 0xdc - [n8,PC]
+    {INDX_PC16   | INDX_REG_U | INDX_INDIRECT  , 8}, // 0xdd - [n16,PC]
+    {INDX_ILLEGAL| INDX_REG_U | INDX_INDIRECT  , 0}, // 0xde - illegal [indirect]
+    {INDX_EXT    | INDX_REG_U | INDX_INDIRECT  , 5}, // 0xdf - [n16]
+
+    {INDX_INC1   | INDX_REG_S                  , 2}, // 0xe0 - ,S+
+    {INDX_INC2   | INDX_REG_S                  , 3}, // 0xe1 - ,S++
+    {INDX_DEC1   | INDX_REG_S                  , 2}, // 0xe2 - ,-S
+    {INDX_DEC2   | INDX_REG_S                  , 3}, // 0xe3 - ,--S
+    {INDX_ZERO   | INDX_REG_S                  , 0}, // 0xe4 - ,S
+    {INDX_ACCB   | INDX_REG_S                  , 1}, // 0xe5 - B,S
+    {INDX_ACCA   | INDX_REG_S                  , 1}, // 0xe6 - A,S
+    {INDX_ILLEGAL| INDX_REG_S                  , 0}, // 0xe7 - illegal
+    {INDX_OFF8   | INDX_REG_S                  , 1}, // 0xe8 - n8,S
+    {INDX_OFF16  | INDX_REG_S                  , 4}, // 0xe9 - n16,S
+    {INDX_ILLEGAL| INDX_REG_S                  , 0}, // 0xea - illegal
+    {INDX_ACCD   | INDX_REG_S                  , 4}, // 0xeb - D,S
+    {INDX_PC8    | INDX_REG_S                  , 1}, // 0xec - n8,PC
+    {INDX_PC16   | INDX_REG_S                  , 5}, // 0xed - n16,PC
+    {INDX_ILLEGAL| INDX_REG_S                  , 0}, // 0xee - illegal
+    {INDX_EXT    | INDX_REG_S                  , 5}, // 0xef - n16
+    {INDX_INC1   | INDX_REG_S | INDX_INDIRECT  , 2}, // 0xf0 - [,S+]
+    {INDX_INC2   | INDX_REG_S | INDX_INDIRECT  , 6}, // 0xf1 - [,S++]
+    {INDX_DEC1   | INDX_REG_S | INDX_INDIRECT  , 2}, // 0xf2 - [,-S]
+    {INDX_DEC2   | INDX_REG_S | INDX_INDIRECT  , 6}, // 0xf3 - [,--S]
+    {INDX_ZERO   | INDX_REG_S | INDX_INDIRECT  , 3}, // 0xf4 - [,S]
+    {INDX_ACCB   | INDX_REG_S | INDX_INDIRECT  , 4}, // 0xf5 - [B,S]
+    {INDX_ACCA   | INDX_REG_S | INDX_INDIRECT  , 4}, // 0xf6 - [A,S]
+    {INDX_ILLEGAL| INDX_REG_S | INDX_INDIRECT  , 0}, // 0xf7 - illegal [indirect]
+    {INDX_OFF8   | INDX_REG_S | INDX_INDIRECT  , 4}, // 0xf8 - [n8,S]
+    {INDX_OFF16  | INDX_REG_S | INDX_INDIRECT  , 7}, // 0xf9 - [n16,S]
+    {INDX_ILLEGAL| INDX_REG_S | INDX_INDIRECT  , 0}, // 0xfa - illegal [indirect]
+    {INDX_ACCD   | INDX_REG_S | INDX_INDIRECT  , 7}, // 0xfb - [D,S]
+    {INDX_PC8    | INDX_REG_S | INDX_INDIRECT  , 4}, // 0xfc - [n8,PC]
+    {INDX_PC16   | INDX_REG_S | INDX_INDIRECT  , 8}, // 0xfd - [n16,PC]
+    {INDX_ILLEGAL| INDX_REG_S | INDX_INDIRECT  , 0}, // 0xfe - illegal [indirect]
+    {INDX_EXT    | INDX_REG_S | INDX_INDIRECT  , 5}  // 0xff - [n16]
+};
+
 #endif  /* __MC6809E_H__ */
@@ -116,8 +116,10 @@ __attribute__((noinline)) uint16_t io_read16(uint16_t address)
     /* An attempt to read an IO address will trigger
      * the callback that may return an alternative value.
      */
+    STATS_IO_READ(address);
     u8 hi = callback_io[address]((uint16_t) address, memory_RAM[address], MEM_READ);
     address++;
+    STATS_IO_READ(address);
     u8 lo = callback_io[address]((uint16_t) address, memory_RAM[address], MEM_READ);
     return (hi << 8) | lo;
 }
@@ -23,6 +23,7 @@
 
 #include    <stdint.h>
 #include    "sam.h"
+#include    "stats.h"
 
 #define     MEMORY_SIZE    65536       // 64K Byte for the full M6809 memory map
 
@@ -67,6 +68,7 @@ inline __attribute__((always_inline)) uint8_t mem_read(int address)
         /* An attempt to read an IO address will trigger
          * the callback that may return an alternative value.
          */
+        STATS_IO_READ(address);
         return callback_io[address]((uint16_t) address, memory_RAM[address], MEM_READ);
     }
     else if (sam_registers.memory_map_type & address)
@@ -111,6 +113,7 @@ inline __attribute__((always_inline)) void mem_write(int address, int data)
 {
     if (!(~address & 0xFF00))
     {
+        STATS_IO_WRITE(address);
         callback_io[address]((uint16_t) address, (uint8_t)data, MEM_WRITE);
     }
     else
@@ -0,0 +1,350 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#include <nds.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#include "DracoDS.h"
+#include "DracoUtils.h"
+#include "CRC32.h"
+#include "mem.h"
+#include "saveload.h"
+#include "rewind.h"
+#include "runahead.h"
+#include "perf.h"
+#include "trace.h"
+#include "printf.h"
+
+#include "movie.h"
+
+// ---------------------------------------------------------------------------------------
+// Movies let us replay a session exactly. Recording saves the full machine state and
+// then, once per frame, whatever input the emulated machine is about to see - the keys
+// held and the joystick. Playback restores the state and feeds the same input back in
+// the same place in the frame so the machine follows the exact same path.
+//
+// In benchmark mode the movie is played with no frame pacing, no video and no audio and
+// the time spent emulating each frame is measured along with a CRC of RAM at the end of
+// each frame. The results go to sav/<game>.hsh so two builds can be compared for both
+// speed and correctness on the same gameplay.
+//
+// Anything that changes the machine behind the input's back (loading a state, rewind,
+// pasting text, swapping media, reset) ends the movie.
+// ---------------------------------------------------------------------------------------
+u8 movie_mode = MOVIE_OFF;
+
+typedef struct
+{
+    u8 joy_x;
+    u8 joy_y;
+    u8 joy_state;
+    u8 nkeys;
+    u8 keys[MOVIE_MAX_KEYS];
+} movie_input_t;
+
+#define MOVIE_INPUT_FIXED   4   // Bytes of movie_input_t ahead of the keys
+
+static FILE *movie_fp = NULL;
+static struct movie_header_t movie_header;
+
+static u8  movie_buf[MOVIE_IO_CHUNK];
+static u32 movie_buf_pos  = 0;          // Recording: bytes buffered. Playback: next byte to use
+static u32 movie_buf_len  = 0;          // Playback: bytes in the buffer
+
+static movie_input_t movie_cur;         // Input for the run of frames in progress
+static u8  movie_repeat   = 0;          // Recording: frames in the run so far. Playback: frames left in the run
+static u32 movie_frame    = 0;          // Frames recorded or played so far
+
+static u32 *movie_hash    = NULL;       // Benchmark: CRC of RAM after each frame...
+static u32 *movie_time    = NULL;       // ...and the microseconds it took to emulate
+static u32  movie_total_us = 0;
+static u16  movie_clock    = 0;         // When emulation of the current frame started
+
+static void movie_message(const char *msg)
+{
+    DSPrint(12,0,0,msg);
+    WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;
+    DSPrint(12,0,0,"             ");
+}
+
+// ---------------------------------------------------------------------------------------
+// Recording - runs of identical frames are buffered and written out a chunk at a time.
+// ---------------------------------------------------------------------------------------
+static void movie_put(const u8 *src, u32 len)
+{
+    for (u32 i=0; i<len; i++)
+    {
+        if (movie_buf_pos == MOVIE_IO_CHUNK)
+        {
+            fwrite(movie_buf, MOVIE_IO_CHUNK, 1, movie_fp);
+            movie_buf_pos = 0;
+        }
+        movie_buf[movie_buf_pos++] = src[i];
+    }
+}
+
+static void movie_put_run(void)
+{
+    if (!movie_repeat) return;
+
+    movie_put(&movie_repeat, 1);
+    movie_put((u8 *)&movie_cur, MOVIE_INPUT_FIXED + movie_cur.nkeys);
+    movie_repeat = 0;
+}
+
+static void movie_capture(movie_input_t *in)
+{
+    memset(in, 0x00, sizeof(*in));
+    in->joy_x     = joy_x;
+    in->joy_y     = joy_y;
+    in->joy_state = JoyState & 0xFF;
+    in->nkeys     = (kbd_keys_pressed < MOVIE_MAX_KEYS) ? kbd_keys_pressed : MOVIE_MAX_KEYS;
+    memcpy(in->keys, kbd_keys, in->nkeys);
+}
+
+// ---------------------------------------------------------------------------------------
+// Playback - read the next run of frames. Returns 0 at the end of the file or if the
+// data makes no sense.
+// ---------------------------------------------------------------------------------------
+static u8 movie_get(u8 *dst, u32 len)
+{
+    while (len--)
+    {
+        if (movie_buf_pos == movie_buf_len)
+        {
+            movie_buf_len = fread(movie_buf, 1, MOVIE_IO_CHUNK, movie_fp);
+            movie_buf_pos = 0;
+            if (movie_buf_len == 0) return 0;
+        }
+        *dst++ = movie_buf[movie_buf_pos++];
+    }
+    return 1;
+}
+
+static u8 movie_get_run(void)
+{
+    memset(&movie_cur, 0x00, sizeof(movie_cur));
+
+    if (!movie_get(&movie_repeat, 1) || !movie_repeat) return 0;
+    if (!movie_get((u8 *)&movie_cur, MOVIE_INPUT_FIXED)) return 0;
+    if (movie_cur.nkeys > MOVIE_MAX_KEYS) return 0;
+
+    return movie_get(movie_cur.keys, movie_cur.nkeys);
+}
+
+static void movie_apply(const movie_input_t *in)
+{
+    joy_x            = in->joy_x;
+    joy_y            = in->joy_y;
+    JoyState         = in->joy_state;
+    kbd_keys_pressed = in->nkeys;
+    memcpy(kbd_keys, in->keys, in->nkeys);
+}
+
+// ---------------------------------------------------------------------------------------
+// Benchmark results: a short summary and then one line per frame - frame, RAM CRC, PC
+// and microseconds. Diff two of these to find where two builds part ways.
+// ---------------------------------------------------------------------------------------
+static void movie_bench_report(void)
+{
+    char szFile[MAX_FILENAME_LEN+8];
+    char szLine[64];
+
+    u32 total_ms = movie_total_us / 1000;
+    u32 fps = total_ms ? ((movie_frame * 1000) / total_ms) : 0;
+
+    DracoSavFilename(szFile, "hsh");
+    FILE *fp = fopen(szFile, "wb");
+    if (fp)
+    {
+        sprintf(szLine, "FRAMES %ld\nTIME %ld MS\nFPS %ld\n\n", movie_frame, total_ms, fps);
+        fputs(szLine, fp);
+        for (u32 i=0; i<movie_frame; i++)
+        {
+            sprintf(szLine, "%6ld %08lX %ld\n", i, movie_hash[i], movie_time[i]);
+            fputs(szLine, fp);
+        }
+        fclose(fp);
+    }
+
+    sprintf(szLine, "BENCH %ld FPS", fps);
+    movie_message(szLine);
+}
+
+void MovieStop(void)
+{
+    if (movie_mode == MOVIE_OFF) return;
+
+    if (movie_mode == MOVIE_RECORD)
+    {
+        movie_put_run();
+        if (movie_buf_pos) fwrite(movie_buf, movie_buf_pos, 1, movie_fp);
+
+        movie_header.frames = movie_frame;
+        fseek(movie_fp, offsetof(struct movie_header_t, frames), SEEK_SET);
+        fwrite(&movie_header.frames, sizeof(movie_header.frames), 1, movie_fp);
+    }
+
+    fclose(movie_fp);
+    movie_fp = NULL;
+
+    if (movie_mode == MOVIE_BENCH)
+    {
+        runahead_mask = 0;      // Back to drawing and hearing every frame
+        movie_mode = MOVIE_OFF;
+        movie_bench_report();
+    }
+    else
+    {
+        movie_message((movie_mode == MOVIE_RECORD) ? "MOVIE SAVED" : "MOVIE END");
+    }
+
+    free(movie_hash); movie_hash = NULL;
+    free(movie_time); movie_time = NULL;
+
+    movie_mode = MOVIE_OFF;
+}
+
+void MovieRecord(void)
+{
+    char szFile[MAX_FILENAME_LEN+8];
+
+    MovieStop();
+
+    u32 len = DracoStateSerialize(CompressBuffer, sizeof(CompressBuffer), 0);
+
+    DracoSavFilename(szFile, "dmv");
+    movie_fp = len ? fopen(szFile, "wb") : NULL;
+    if (!movie_fp)
+    {
+        movie_message("MOVIE ERR");
+        return;
+    }
+
+    movie_header.magic     = MOVIE_MAGIC;
+    movie_header.version   = MOVIE_VERSION;
+    movie_header.machine   = myConfig.machine;
+    movie_header.reserved  = 0;
+    movie_header.game_crc  = file_crc;
+    movie_header.state_len = len;
+    movie_header.frames    = 0;
+    fwrite(&movie_header, sizeof(movie_header), 1, movie_fp);
+    fwrite(CompressBuffer, len, 1, movie_fp);
+
+    movie_buf_pos = 0;
+    movie_repeat  = 0;
+    movie_frame   = 0;
+    movie_mode    = MOVIE_RECORD;
+
+    movie_message("RECORDING");
+}
+
+void MoviePlay(void)
+{
+    char szFile[MAX_FILENAME_LEN+8];
+
+    MovieStop();
+
+    DracoSavFilename(szFile, "dmv");
+    movie_fp = fopen(szFile, "rb");
+    if (!movie_fp)
+    {
+        movie_message("NO MOVIE");
+        return;
+    }
+
+    u8 bOK = (fread(&movie_header, sizeof(movie_header), 1, movie_fp) == 1);
+    bOK = bOK && (movie_header.magic == MOVIE_MAGIC) && (movie_header.version == MOVIE_VERSION);
+    bOK = bOK && (movie_header.machine == myConfig.machine) && (movie_header.game_crc == file_crc);
+    bOK = bOK && (movie_header.frames > 0) && (movie_header.state_len <= sizeof(CompressBuffer));
+    bOK = bOK && (fread(CompressBuffer, 1, movie_header.state_len, movie_fp) == movie_header.state_len);
+    bOK = bOK && DracoStateDeserialize(CompressBuffer, movie_header.state_len, STATE_FLAG_RELOAD_MEDIA | STATE_FLAG_VERIFY_CRC);
+
+    if (bOK && myGlobalConfig.movieBench)
+    {
+        movie_hash = malloc(movie_header.frames * sizeof(u32));
+        movie_time = malloc(movie_header.frames * sizeof(u32));
+        bOK = (movie_hash && movie_time);
+    }
+
+    if (!bOK)
+    {
+        free(movie_hash); movie_hash = NULL;
+        free(movie_time); movie_time = NULL;
+        fclose(movie_fp);
+        movie_fp = NULL;
+        movie_message("MOVIE ERR");
+        return;
+    }
+
+    RewindReset();      // The rewind history is from a different timeline now
+
+    movie_buf_pos  = 0;
+    movie_buf_len  = 0;
+    movie_repeat   = 0;
+    movie_frame    = 0;
+    movie_total_us = 0;
+    movie_mode     = myGlobalConfig.movieBench ? MOVIE_BENCH : MOVIE_PLAY;
+
+    if (movie_mode == MOVIE_PLAY) movie_message("PLAYING");
+
+    TraceStart();       // Same input every time makes for traces worth comparing
+}
+
+// ---------------------------------------------------------------------------------------
+// Called once per frame at the point the input for the next frame has been decided.
+// ---------------------------------------------------------------------------------------
+void MovieFrame(void)
+{
+    if (movie_mode == MOVIE_OFF) return;
+
+    if (movie_mode == MOVIE_RECORD)
+    {
+        movie_input_t in;
+        movie_capture(&in);
+
+        if (movie_repeat && ((movie_repeat == 255) || memcmp(&in, &movie_cur, sizeof(in)))) movie_put_run();
+        if (!movie_repeat) movie_cur = in;
+        movie_repeat++;
+        movie_frame++;
+        return;
+    }
+
+    if ((movie_mode == MOVIE_BENCH) && movie_frame)    // Time and fingerprint the frame just emulated
+    {
+        u32 us = PerfTicksToUs((u16)(PerfClock() - movie_clock));
+        movie_time[movie_frame-1] = us;
+        movie_total_us += us;
+        movie_hash[movie_frame-1] = getCRC32(memory_RAM, 0x10000);
+    }
+
+    if (!movie_repeat && ((movie_frame == movie_header.frames) || !movie_get_run()))
+    {
+        MovieStop();
+        return;
+    }
+
+    movie_apply(&movie_cur);
+    movie_repeat--;
+    movie_frame++;
+
+    if (movie_mode == MOVIE_BENCH)
+    {
+        runahead_mask = RUNAHEAD_NO_VIDEO | RUNAHEAD_NO_AUDIO;
+        movie_clock = PerfClock();
+    }
+}
+
+// End of file
@@ -0,0 +1,50 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#ifndef _MOVIE_H_
+#define _MOVIE_H_
+
+#include <nds.h>
+
+// ---------------------------------------------------------------------------------------
+// A movie file is a header, the full machine state we started from and then the input
+// for every frame as runs of identical frames: repeat count, joy_x, joy_y, joystick
+// buttons, number of keys held and the keys themselves.
+// ---------------------------------------------------------------------------------------
+#define MOVIE_MAGIC             0x564F4D44      // 'DMOV'
+#define MOVIE_VERSION           1
+#define MOVIE_IO_CHUNK          4096            // Frames are read/written to the SD card this many bytes at a time
+#define MOVIE_MAX_KEYS          12              // Same as kbd_keys[]
+
+#define MOVIE_OFF               0
+#define MOVIE_RECORD            1
+#define MOVIE_PLAY              2
+#define MOVIE_BENCH             3               // Play back as fast as possible with no video/audio and log frame hashes
+
+struct __attribute__((__packed__)) movie_header_t
+{
+    u32 magic;
+    u16 version;
+    u8  machine;        // myConfig.machine the movie was recorded with
+    u8  reserved;
+    u32 game_crc;       // file_crc of the game
+    u32 state_len;      // Bytes of machine state that follow this header
+    u32 frames;         // Frames of input that follow the state
+};
+
+extern u8 movie_mode;
+
+extern void MovieRecord(void);
+extern void MoviePlay(void);
+extern void MovieStop(void);
+extern void MovieFrame(void);
+
+#endif // _MOVIE_H_
@@ -0,0 +1,179 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#include <nds.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "DracoDS.h"
+#include "DracoUtils.h"
+#include "pia.h"
+
+#include "paste.h"
+
+// ---------------------------------------------------------------------------------------
+// Text paste - rather than holding each key for a fixed time like BufferKey() does, we
+// watch the ROM scan the keyboard. A key is held until its column has been strobed often
+// enough for KEYIN to find and debounce it, then released until the ROM has seen it come
+// back up. That's as fast as BASIC can take them and it adapts on its own to slow spots
+// like BASIC crunching a line after ENTER. The same logical keys drive both the Dragon
+// and CoCo matrix (kbd_scan_dragon / kbd_scan_coco) so one character map covers both.
+// ---------------------------------------------------------------------------------------
+u8 paste_active __attribute__((section(".dtcm"))) = 0;
+
+static char *paste_buf    = NULL;
+static u32   paste_len    = 0;
+static u32   paste_pos    = 0;
+static u8    paste_down   = 0;      // Key is currently held (vs. released waiting for the next)
+static u8    paste_col    = 0;      // Column strobe bit for the current key
+static u8    paste_scans  = 0;      // Scans of that column seen in this phase
+static u8    paste_frames = 0;      // Frames spent in this phase
+
+// Map an ASCII character to the keyboard. Returns 0 for anything the keyboard can't type.
+static u8 paste_map(char ch)
+{
+    if ((ch >= 'a') && (ch <= 'z')) ch -= 0x20;     // BASIC wants upper case
+
+    if ((ch >= 'A') && (ch <= 'Z')) return 5 + (ch - 'A');
+    if (ch == '0')                  return 40;
+    if ((ch >= '1') && (ch <= '9')) return 31 + (ch - '1');
+    if ((ch >= '!') && (ch <= ')')) return PASTE_SHIFT | (31 + (ch - '!')); // Shifted 1-9
+
+    switch (ch)
+    {
+        case '\n':  return 48;                      // ENTER
+        case ' ':   return 49;
+        case '\t':  return 49;
+        case '-':   return 41;
+        case ',':   return 42;
+        case '.':   return 43;
+        case ':':   return 44;
+        case ';':   return 45;
+        case '/':   return 46;
+        case '@':   return 47;
+        case '^':   return 50;                      // Up arrow
+        case '=':   return PASTE_SHIFT | 41;
+        case '<':   return PASTE_SHIFT | 42;
+        case '>':   return PASTE_SHIFT | 43;
+        case '*':   return PASTE_SHIFT | 44;
+        case '+':   return PASTE_SHIFT | 45;
+        case '?':   return PASTE_SHIFT | 46;
+        case '_':   return PASTE_SHIFT | 50;        // Shifted arrows
+        case '[':   return PASTE_SHIFT | 53;
+        case ']':   return PASTE_SHIFT | 52;
+        case '\\':  return PASTE_SHIFT | 54;        // Shift CLEAR
+    }
+    return 0;
+}
+
+// Press the next character we can type or finish up
+static void paste_next_key(void)
+{
+    u8 key = 0;
+
+    while (!key && (paste_pos < paste_len)) key = paste_map(paste_buf[paste_pos++]);
+
+    if (!key)
+    {
+        PasteStop();
+        return;
+    }
+
+    kbd_keys_pressed = 0;
+    if (key & PASTE_SHIFT) kbd_keys[kbd_keys_pressed++] = 55;
+    key &= ~PASTE_SHIFT;
+    kbd_keys[kbd_keys_pressed++] = key;
+    kbd_key = key;
+
+    paste_col  = ~(myConfig.machine ? kbd_scan_coco[key][0] : kbd_scan_dragon[key][0]);
+    paste_down = 1;
+}
+
+static void paste_next_phase(void)
+{
+    if (paste_down)
+    {
+        paste_down = 0;
+        kbd_keys_pressed = 0;
+        kbd_key = 0;
+    }
+    else paste_next_key();
+
+    paste_scans = 0;
+    paste_frames = 0;
+}
+
+u8 PasteFile(const char *filename)
+{
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) return 0;
+
+    if (!paste_buf) paste_buf = malloc(PASTE_MAX_LEN);
+    u32 len = paste_buf ? fread(paste_buf, 1, PASTE_MAX_LEN, fp) : 0;
+    fclose(fp);
+
+    if (len) PasteText(paste_buf, len);
+    return (len > 0);
+}
+
+void PasteText(const char *text, u32 len)
+{
+    if (!paste_buf) paste_buf = malloc(PASTE_MAX_LEN);
+    if (!paste_buf) return;
+
+    if (len > PASTE_MAX_LEN) len = PASTE_MAX_LEN;
+    if (text != paste_buf) memcpy(paste_buf, text, len);
+
+    paste_len = len;
+    paste_pos = 0;
+    paste_down = 0;
+    paste_active = 1;
+    paste_next_phase();     // Starts out 'released' so this presses the first key
+}
+
+void PasteStop(void)
+{
+    paste_active = 0;
+    paste_down = 0;
+    kbd_keys_pressed = 0;
+    kbd_key = 0;
+}
+
+// ---------------------------------------------------------------------------------------
+// Called by the PIA each time the keyboard rows are read with the column strobe that was
+// written. Counts the scans that actually looked at our key's column.
+// ---------------------------------------------------------------------------------------
+void PasteScan(u8 strobe)
+{
+    if (strobe == 0x00) return;         // The 'is any key down?' probe - not a real scan
+    if (strobe & paste_col) return;     // Not looking at our column
+
+    if (++paste_scans >= (paste_down ? PASTE_SCANS_DOWN : PASTE_SCANS_UP)) paste_next_phase();
+}
+
+// ---------------------------------------------------------------------------------------
+// Called once per frame in place of the normal key handling. Touching the screen stops
+// the paste. If the keyboard isn't being scanned at all we fall back to a fixed delay.
+// ---------------------------------------------------------------------------------------
+void PasteFrame(u16 keys)
+{
+    if (keys & KEY_TOUCH)
+    {
+        PasteStop();
+        return;
+    }
+
+    if (++paste_frames >= PASTE_TIMEOUT_FRAMES) paste_next_phase();
+}
+
+// End of file
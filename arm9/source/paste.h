@@ -0,0 +1,31 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#ifndef _PASTE_H_
+#define _PASTE_H_
+
+#include <nds.h>
+
+#define PASTE_MAX_LEN           (32*1024)   // Plenty for any BASIC listing that fits in memory
+#define PASTE_SCANS_DOWN        3           // Column scans with the key held (found + debounced) before we let go...
+#define PASTE_SCANS_UP          2           // ...and with it released so the ROM's rollover table clears
+#define PASTE_TIMEOUT_FRAMES    10          // For programs that don't scan the keyboard the way BASIC does
+#define PASTE_SHIFT             0x80        // Flag in the character map - hold SHIFT along with the key
+
+extern u8   paste_active;
+
+extern u8   PasteFile(const char *filename);
+extern void PasteText(const char *text, u32 len);
+extern void PasteStop(void);
+extern void PasteFrame(u16 keys);
+extern void PasteScan(u8 strobe);
+
+#endif // _PASTE_H_
@@ -0,0 +1,152 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#include <nds.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "DracoDS.h"
+#include "DracoUtils.h"
+#include "printf.h"
+
+#include "perf.h"
+
+// ---------------------------------------------------------------------------------------
+// Where does the DS spend each frame? The CPU, VDG render, DAC audio and floppy tick are
+// timed around their calls in dragon_run() and the input handling and frame wait around
+// theirs in the main loop. Totals are kept per frame. Once a second the average share
+// of the frame budget for each is shown on the bottom screen, and the last few hundred
+// frames can be exported as Chrome trace-event JSON (chrome://tracing or Perfetto).
+//
+// The floppy state machine is also clocked by the CPU touching the controller registers -
+// that time lands in the CPU scope.
+// ---------------------------------------------------------------------------------------
+u8  perf_enabled                __attribute__((section(".dtcm"))) = 0;
+u32 perf_frame[PERF_SCOPES]     __attribute__((section(".dtcm"))) = {0};
+
+static u32 perf_second[PERF_SCOPES];            // Totals for the frames since the overlay was last shown
+static u16 perf_second_frames = 0;
+
+static u16 perf_trace[PERF_TRACE_FRAMES][PERF_SCOPES];  // Ticks per scope for the most recent frames
+static u16 perf_trace_head = 0;
+static u16 perf_trace_num  = 0;
+
+static const char *perf_names[PERF_SCOPES] = {"CPU", "VDG", "AUDIO", "FDC", "INPUT", "WAIT"};
+
+// ---------------------------------------------------------------------------------------
+// Timer 3 is also used to time file loads (outside of the emulation) so we make sure it's
+// back to free-running at our rate each frame.
+// ---------------------------------------------------------------------------------------
+void PerfTimerStart(void)
+{
+    if (TIMER3_CR != PERF_TIMER_CR)
+    {
+        TIMER3_CR = 0;
+        TIMER3_DATA = 0;
+        TIMER3_CR = PERF_TIMER_CR;
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// Called once per frame - close out the frame's totals.
+// ---------------------------------------------------------------------------------------
+void PerfFrame(void)
+{
+    PerfTimerStart();
+
+    if (perf_enabled != myGlobalConfig.perfOverlay)     // Turned on or off in the options
+    {
+        perf_enabled = myGlobalConfig.perfOverlay;
+        memset(perf_second, 0x00, sizeof(perf_second));
+        perf_second_frames = 0;
+        perf_trace_num = 0;
+        if (!perf_enabled) DSPrint(0,1,0,"                                ");
+    }
+
+    if (!perf_enabled) return;
+
+    for (u8 i=0; i<PERF_SCOPES; i++)
+    {
+        perf_second[i] += perf_frame[i];
+        perf_trace[perf_trace_head][i] = (perf_frame[i] < 0xFFFF) ? perf_frame[i] : 0xFFFF;
+        perf_frame[i] = 0;
+    }
+    perf_second_frames++;
+
+    perf_trace_head = (perf_trace_head + 1) % PERF_TRACE_FRAMES;
+    if (perf_trace_num < PERF_TRACE_FRAMES) perf_trace_num++;
+}
+
+// ---------------------------------------------------------------------------------------
+// Called once a second - average percentage of the frame budget spent in each scope.
+// ---------------------------------------------------------------------------------------
+void PerfShowOverlay(void)
+{
+    char szLine[40];
+    u32 pct[PERF_SCOPES];
+
+    if (!perf_enabled || !perf_second_frames) return;
+
+    u32 budget_us = (myConfig.machine ? 16683 : 20000) * perf_second_frames;
+    for (u8 i=0; i<PERF_SCOPES; i++)
+    {
+        pct[i] = (PerfTicksToUs(perf_second[i]) * 100) / budget_us;
+        perf_second[i] = 0;
+    }
+    perf_second_frames = 0;
+
+    sprintf(szLine, "C%02ld V%02ld A%02ld F%02ld I%02ld W%02ld %%   ", pct[PERF_CPU], pct[PERF_VDG], pct[PERF_AUDIO], pct[PERF_FDC], pct[PERF_INPUT], pct[PERF_WAIT]);
+    if (!myGlobalConfig.debugger) DSPrint(0,1,0,szLine);
+}
+
+// ---------------------------------------------------------------------------------------
+// Write the recent frames to sav/<game>.trc as Chrome trace events - each frame is the
+// scopes laid end to end, one complete ("X") event each.
+// ---------------------------------------------------------------------------------------
+void PerfExport(void)
+{
+    char szFile[MAX_FILENAME_LEN+8];
+    char szLine[128];
+    u32  ts = 0;
+
+    if (!perf_enabled || !perf_trace_num) return;
+
+    DracoSavFilename(szFile, "trc");
+
+    FILE *fp = fopen(szFile, "w");
+    if (!fp) return;
+
+    fputs("{\"traceEvents\":[\n", fp);
+
+    u16 idx = (perf_trace_head + PERF_TRACE_FRAMES - perf_trace_num) % PERF_TRACE_FRAMES;
+    for (u16 n=0; n<perf_trace_num; n++)
+    {
+        sprintf(szLine, "{\"name\":\"FRAME\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":1,\"ts\":%ld},\n", ts);
+        fputs(szLine, fp);
+
+        for (u8 i=0; i<PERF_SCOPES; i++)
+        {
+            u32 dur = PerfTicksToUs(perf_trace[idx][i]);
+            if (!dur) continue;
+            sprintf(szLine, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%ld,\"dur\":%ld},\n", perf_names[i], ts, dur);
+            fputs(szLine, fp);
+            ts += dur;
+        }
+        idx = (idx + 1) % PERF_TRACE_FRAMES;
+    }
+
+    sprintf(szLine, "{\"name\":\"END\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":1,\"ts\":%ld}\n],\"displayTimeUnit\":\"ms\"}\n", ts);
+    fputs(szLine, fp);
+    fclose(fp);
+}
+
+// End of file
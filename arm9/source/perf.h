@@ -0,0 +1,67 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#ifndef _PERF_H_
+#define _PERF_H_
+
+#include <nds.h>
+
+// ---------------------------------------------------------------------------------------
+// TIMER3 free-runs at 33.514MHz / 64 (a bit under 2us per tick) during emulation and is
+// the time base for everything we measure. It wraps every 125ms so only differences
+// between two readings are meaningful - anything we time must be shorter than that.
+// ---------------------------------------------------------------------------------------
+#define PERF_TIMER_CR           (TIMER_ENABLE | TIMER_DIV_64)
+
+#define PERF_CPU                0
+#define PERF_VDG                1
+#define PERF_AUDIO              2
+#define PERF_FDC                3
+#define PERF_INPUT              4
+#define PERF_WAIT               5
+#define PERF_SCOPES             6
+
+#define PERF_TRACE_FRAMES       600             // Last 10-12 seconds of frames are kept for the trace export
+
+extern u8  perf_enabled;
+extern u32 perf_frame[PERF_SCOPES];
+
+static inline __attribute__((always_inline)) u16 PerfClock(void)
+{
+    return TIMER3_DATA;
+}
+
+static inline __attribute__((always_inline)) u32 PerfTicksToUs(u32 ticks)
+{
+    return (u32)(((u64)ticks * 64000) / 33514);
+}
+
+// Scoped timing - free when the overlay is off. PerfLap() charges the time since 'start'
+// to the scope and returns the current time so laps can be chained.
+static inline __attribute__((always_inline)) u16 PerfStart(void)
+{
+    return perf_enabled ? TIMER3_DATA : 0;
+}
+
+static inline __attribute__((always_inline)) u16 PerfLap(u8 scope, u16 start)
+{
+    if (!perf_enabled) return 0;
+    u16 now = TIMER3_DATA;
+    perf_frame[scope] += (u16)(now - start);
+    return now;
+}
+
+extern void PerfTimerStart(void);
+extern void PerfFrame(void);
+extern void PerfShowOverlay(void);
+extern void PerfExport(void);
+
+#endif // _PERF_H_
@@ -26,6 +26,7 @@
 #include    "vdg.h"
 #include    "pia.h"
 #include    "DracoUtils.h"
+#include    "paste.h"
 
 /* -----------------------------------------
    Local definitions
@@ -480,6 +481,8 @@ ITCM_CODE static uint8_t io_handler_pia0_pa(uint16_t address, uint8_t data, mem_
             row_switch_bits = get_keyboard_row_scan(pia0_b_output_latch);
             mem_write(PIA0_PA, (int) row_switch_bits);
 
+            if (paste_active) PasteScan(pia0_b_output_latch);   // Let the paste engine see what the ROM is scanning
+
             data = row_switch_bits;
 
             uint16_t input = 31+myConfig.analogCenter;
@@ -768,7 +771,7 @@ ITCM_CODE static uint8_t io_handler_pia0_crb(uint16_t address, uint8_t data, mem
 
 inline uint8_t loader_tape_fread(void)
 {
-    if (tape_pos > last_file_size)
+    if (tape_pos >= last_file_size)
     {
         cas_eof = 1;
         return 0x00;
@@ -34,6 +34,8 @@ extern uint8_t   cas_eof;
 extern uint32_t  tape_pos;
 extern uint16_t  tape_motor;
 extern uint8_t   keyboard_rows[KBD_ROWS];
+extern uint8_t   kbd_scan_dragon[60][2];
+extern uint8_t   kbd_scan_coco[60][2];
 extern uint8_t   pia0_ddr_a;
 extern uint8_t   pia0_ddr_b;
 extern uint8_t   pia1_ddr_a;
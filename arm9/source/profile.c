@@ -0,0 +1,279 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#include <nds.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "DracoDS.h"
+#include "DracoUtils.h"
+#include "CRC32.h"
+#include "cpu.h"
+#include "mem.h"
+#include "printf.h"
+
+#include "profile.h"
+
+// ---------------------------------------------------------------------------------------
+// A very simple sampling profiler for the guest. At the end of every scanline (57 CPU
+// cycles) we bump a counter for wherever the PC is - that's over 15,000 samples a second
+// for the cost of an increment. When exported, the 64K histogram is rolled up into the
+// named routines from a symbol map (anything not covered is lumped into 256 byte pages)
+// and written out both as a sorted report and as folded stacks for flamegraph.pl.
+//
+// The symbol map comes from two places: the hardware vectors and the BASIC/Disk ROM
+// indirect jump tables (read right out of the ROMs so they're correct for any version)
+// plus an optional /data/syms/<crc>.sym for each ROM with one "ADDR NAME" per line.
+// ---------------------------------------------------------------------------------------
+u32 *profile_hits       __attribute__((section(".dtcm"))) = NULL;   // Hits per PC - only allocated while profiling
+u32  profile_samples    __attribute__((section(".dtcm"))) = 0;
+
+typedef struct
+{
+    u16  addr;
+    char name[PROFILE_NAME_LEN+1];
+} profile_sym_t;
+
+typedef struct
+{
+    u32 hits;
+    u16 idx;            // Symbol index... or the page number for unnamed code
+    u8  named;
+} profile_entry_t;
+
+static profile_sym_t *profile_syms = NULL;
+static u16            profile_num_syms = 0;
+
+typedef struct
+{
+    u16         vector;
+    const char *name;
+} profile_vector_t;
+
+static const profile_vector_t hw_vectors[] =
+{
+    {0xFFF2, "SWI3"}, {0xFFF4, "SWI2"}, {0xFFF6, "FIRQ"}, {0xFFF8, "IRQ"},
+    {0xFFFA, "SWI"},  {0xFFFC, "NMI"},  {0xFFFE, "RESET"},
+};
+
+// Color BASIC's indirect jump table at the start of the ROM
+static const profile_vector_t coco_vectors[] =
+{
+    {0xA000, "POLCAT"}, {0xA002, "CHROUT"}, {0xA004, "CSRDON"}, {0xA006, "BLKIN"},
+    {0xA008, "BLKOUT"}, {0xA00A, "JOYIN"},  {0xA00C, "WRTLDR"},
+};
+
+// Disk BASIC points to its sector read/write routine here
+static const profile_vector_t disk_vectors[] =
+{
+    {0xC004, "DSKCON"},
+};
+
+// ---------------------------------------------------------------------------------------
+// Grab the memory for the histogram if the profiler is enabled (or let it go if not) and
+// start counting from zero. Called whenever the machine is reset.
+// ---------------------------------------------------------------------------------------
+void ProfileReset(void)
+{
+    if (!myGlobalConfig.profiler)
+    {
+        free(profile_hits);
+        profile_hits = NULL;
+        return;
+    }
+
+    if (!profile_hits) profile_hits = malloc(0x10000 * sizeof(u32));
+    if (profile_hits) memset(profile_hits, 0x00, 0x10000 * sizeof(u32));
+    profile_samples = 0;
+}
+
+static void profile_add_sym(u16 addr, const char *name)
+{
+    if (profile_num_syms >= PROFILE_MAX_SYMBOLS) return;
+
+    profile_syms[profile_num_syms].addr = addr;
+    strncpy(profile_syms[profile_num_syms].name, name, PROFILE_NAME_LEN);
+    profile_syms[profile_num_syms].name[PROFILE_NAME_LEN] = 0;
+    profile_num_syms++;
+}
+
+// The CoCo RAM vectors are a JMP to the real handler in ROM - follow it
+static void profile_add_vectors(const profile_vector_t *vec, u8 count)
+{
+    for (u8 i=0; i<count; i++)
+    {
+        u16 addr = (mem_read(vec[i].vector) << 8) | mem_read(vec[i].vector+1);
+        if (mem_read(addr) == 0x7E) addr = (mem_read(addr+1) << 8) | mem_read(addr+2);
+        if (addr >= 0x8000) profile_add_sym(addr, vec[i].name);
+    }
+}
+
+static void profile_load_syms(const u8 *rom, u32 size)
+{
+    char szLine[80];
+
+    sprintf(szLine, "%s/%08lX.sym", PROFILE_SYM_DIR, getCRC32((u8 *)rom, size));
+    FILE *fp = fopen(szLine, "r");
+    if (!fp) return;
+
+    while (fgets(szLine, sizeof(szLine), fp))
+    {
+        char *p = szLine;
+        while (isspace((int)*p)) p++;
+        if ((*p == ';') || (*p == '*') || (*p == '#') || (*p == 0)) continue;
+        if (*p == '$') p++;
+
+        char *end;
+        u32 addr = strtoul(p, &end, 16);
+        if ((end == p) || (addr > 0xFFFF)) continue;
+
+        p = end;
+        while (isspace((int)*p)) p++;
+        end = p;
+        while (*end && !isspace((int)*end)) end++;
+        *end = 0;
+
+        if (*p) profile_add_sym(addr, p);
+    }
+    fclose(fp);
+}
+
+static int profile_sym_cmp(const void *a, const void *b)
+{
+    return (int)((const profile_sym_t *)a)->addr - (int)((const profile_sym_t *)b)->addr;
+}
+
+static int profile_entry_cmp(const void *a, const void *b)
+{
+    u32 ha = ((const profile_entry_t *)a)->hits;
+    u32 hb = ((const profile_entry_t *)b)->hits;
+    return (ha < hb) ? 1 : ((ha > hb) ? -1 : 0);
+}
+
+// Nearest symbol at or below the PC in the same 16K of the memory map... or -1
+static s16 profile_find_sym(u16 pc)
+{
+    s16 lo = 0, hi = profile_num_syms - 1, best = -1;
+
+    while (lo <= hi)
+    {
+        s16 mid = (lo + hi) / 2;
+        if (profile_syms[mid].addr <= pc) {best = mid; lo = mid + 1;}
+        else hi = mid - 1;
+    }
+
+    if ((best >= 0) && ((profile_syms[best].addr >> 14) != (pc >> 14))) best = -1;
+    return best;
+}
+
+static void profile_label(const profile_entry_t *e, char *label)
+{
+    if (e->named) strcpy(label, profile_syms[e->idx].name);
+    else sprintf(label, "%s_$%02X00", ((e->idx < 0x80) ? "RAM":"ROM"), e->idx);
+}
+
+// ---------------------------------------------------------------------------------------
+// Roll up the histogram and write sav/<game>.prf (sorted report) and sav/<game>.fld
+// (folded stacks). The histogram starts over so the next export covers just what ran
+// in between.
+// ---------------------------------------------------------------------------------------
+void ProfileExport(void)
+{
+    char szFile[MAX_FILENAME_LEN+8];
+    char szLabel[PROFILE_NAME_LEN+8];
+    char szLine[80];
+    u32  page_hits[256];
+
+    if (!profile_hits || !profile_samples) return;
+
+    profile_syms = malloc(PROFILE_MAX_SYMBOLS * sizeof(profile_sym_t));
+    u32 *sym_hits = calloc(PROFILE_MAX_SYMBOLS, sizeof(u32));
+    profile_entry_t *entries = malloc((PROFILE_MAX_SYMBOLS + 256) * sizeof(profile_entry_t));
+
+    if (profile_syms && sym_hits && entries)
+    {
+        // Build the symbol map - ROM tables first, then anything from the symbol files
+        profile_num_syms = 0;
+        profile_add_vectors(hw_vectors, sizeof(hw_vectors)/sizeof(hw_vectors[0]));
+        if (myConfig.machine) profile_add_vectors(coco_vectors, sizeof(coco_vectors)/sizeof(coco_vectors[0]));
+        if (draco_mode >= MODE_DSK) profile_add_vectors(disk_vectors, sizeof(disk_vectors)/sizeof(disk_vectors[0]));
+
+        profile_load_syms(myConfig.machine ? CoCoBASIC : DragonBASIC, 0x4000);
+        if (draco_mode >= MODE_DSK) profile_load_syms(DiskROM, 0x2000);
+
+        qsort(profile_syms, profile_num_syms, sizeof(profile_sym_t), profile_sym_cmp);
+
+        // Roll the PCs up into routines (or pages)
+        memset(page_hits, 0x00, sizeof(page_hits));
+        for (u32 pc=0; pc<0x10000; pc++)
+        {
+            if (!profile_hits[pc]) continue;
+            s16 idx = profile_find_sym(pc);
+            if (idx >= 0) sym_hits[idx] += profile_hits[pc];
+            else page_hits[pc >> 8] += profile_hits[pc];
+        }
+
+        u16 num = 0;
+        for (u16 i=0; i<profile_num_syms; i++)
+        {
+            if (sym_hits[i]) {entries[num].hits = sym_hits[i]; entries[num].idx = i; entries[num].named = 1; num++;}
+        }
+        for (u16 i=0; i<256; i++)
+        {
+            if (page_hits[i]) {entries[num].hits = page_hits[i]; entries[num].idx = i; entries[num].named = 0; num++;}
+        }
+        qsort(entries, num, sizeof(profile_entry_t), profile_entry_cmp);
+
+        DracoSavFilename(szFile, "prf");
+        FILE *fp = fopen(szFile, "w");
+        if (fp)
+        {
+            sprintf(szLine, "SAMPLES %ld (ONE PER SCANLINE)\n\n      HITS    PCT  ADDR  ROUTINE\n", profile_samples);
+            fputs(szLine, fp);
+            for (u16 i=0; i<num; i++)
+            {
+                u32 pct10 = (u32)(((u64)entries[i].hits * 1000) / profile_samples);
+                u16 addr  = entries[i].named ? profile_syms[entries[i].idx].addr : (entries[i].idx << 8);
+                profile_label(&entries[i], szLabel);
+                sprintf(szLine, "%10ld %4ld.%ld%% $%04X %s\n", entries[i].hits, pct10/10, pct10%10, addr, szLabel);
+                fputs(szLine, fp);
+            }
+            fclose(fp);
+        }
+
+        DracoSavFilename(szFile, "fld");
+        fp = fopen(szFile, "w");
+        if (fp)
+        {
+            for (u16 i=0; i<num; i++)
+            {
+                u16 addr = entries[i].named ? profile_syms[entries[i].idx].addr : (entries[i].idx << 8);
+                profile_label(&entries[i], szLabel);
+                sprintf(szLine, "%s;%s %ld\n", ((addr < 0x8000) ? "RAM":"ROM"), szLabel, entries[i].hits);
+                fputs(szLine, fp);
+            }
+            fclose(fp);
+        }
+
+        memset(profile_hits, 0x00, 0x10000 * sizeof(u32));
+        profile_samples = 0;
+    }
+
+    free(entries);
+    free(sym_hits);
+    free(profile_syms);
+    profile_syms = NULL;
+}
+
+// End of file
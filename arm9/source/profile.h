@@ -0,0 +1,37 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#ifndef _PROFILE_H_
+#define _PROFILE_H_
+
+#include <nds.h>
+
+#define PROFILE_MAX_SYMBOLS     1024
+#define PROFILE_NAME_LEN        23
+#define PROFILE_SYM_DIR         "/data/syms"    // Symbol maps are <rom crc>.sym in here - one "ADDR NAME" per line
+
+extern u32 *profile_hits;
+extern u32  profile_samples;
+
+// Called once per scanline from dragon_run() - one sample of where the CPU is
+static inline __attribute__((always_inline)) void ProfileSample(u16 pc)
+{
+    if (profile_hits)
+    {
+        profile_hits[pc]++;
+        profile_samples++;
+    }
+}
+
+extern void ProfileReset(void);
+extern void ProfileExport(void);
+
+#endif // _PROFILE_H_
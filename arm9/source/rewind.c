@@ -0,0 +1,359 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#include <nds.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "DracoDS.h"
+#include "DracoUtils.h"
+#include "saveload.h"
+#include "printf.h"
+
+#include "lzav.h"
+
+#include "rewind.h"
+#include "movie.h"
+#include "perf.h"
+
+// ---------------------------------------------------------------------------------------
+// The rewind history is a ring of snapshot deltas. We keep the most recent full machine
+// state (raw, uncompressed) and every REWIND_INTERVAL frames we take a new one. What goes
+// into the ring is the XOR of the new state against the previous one - most of the 64K
+// of RAM doesn't change from one snapshot to the next so the delta is almost all zeros
+// and compresses to next to nothing with the fast lzav compressor.
+//
+// To keep the per-frame cost small, the delta is worked out in REWIND_BLOCK_SIZE blocks
+// with only REWIND_BLOCKS_PER_FRAME blocks processed each frame. Each block is compressed
+// on its own and is preceded by a 2 byte header: 0 means the block didn't change at all,
+// REWIND_BLOCK_RAW means the block is stored as-is, otherwise it's the compressed length.
+//
+// Stepping back is the reverse: decompress the newest delta and XOR it into the full
+// state we're holding which gives us the snapshot before it. The delta is then dropped.
+// ---------------------------------------------------------------------------------------
+#define REWIND_BLOCK_RAW    0xFFFF
+
+u32 rewind_snap_us  = 0;        // Most recent snapshot time in microseconds (shown in the debugger)
+u32 rewind_delta_us = 0;        // Most recent frame's delta compression time in microseconds
+
+typedef struct
+{
+    u32 offset;                 // Where this delta starts in the ring
+    u32 length;                 // How many bytes of the ring it uses
+} rewind_entry_t;
+
+static u8  *rewind_ring      = NULL;    // The ring buffer of compressed deltas
+static u32  rewind_budget    = 0;       // Size of the ring buffer in bytes
+static u8  *rewind_latest    = NULL;    // Most recent full machine state
+static u8  *rewind_work      = NULL;    // The state being captured (becomes the latest when done)
+static u32  rewind_state_len = 0;       // Length of a machine state - 0 until we have the first one
+static u8   rewind_no_memory = 0;       // Set if we couldn't get memory for the ring - don't keep trying
+
+static rewind_entry_t rewind_entries[REWIND_MAX_ENTRIES];
+static u16  rewind_tail      = 0;       // Index of the oldest delta
+static u16  rewind_num       = 0;       // Number of deltas in the ring
+static u32  rewind_head      = 0;       // Where in the ring the next delta goes
+
+static u8   rewind_frames    = 0;       // Frames since the last capture
+static u8   rewind_block     = 0;       // Next block of the capture in progress to process
+static u8   rewind_blocks    = 0;       // Total blocks in the capture in progress (0 = idle)
+static u32  rewind_entry_pos = 0;       // Where the delta being captured starts in the ring
+static u32  rewind_entry_len = 0;       // How much of the delta has been written so far
+
+static u8   rewind_held        = 0;     // Set each frame the rewind keys are held
+static u8   rewind_at_latest   = 0;     // Set once the machine has been put back to rewind_latest
+static u8   rewind_hold_frames = 0;     // Pacing for stepping back while the keys are held
+
+static u32  rewind_scratch[REWIND_BLOCK_SIZE/4];    // One block of delta - word aligned for the XOR
+static u32  rewind_hash[4096];                      // 16K hash table for lzav so it doesn't malloc each block
+
+#define REWIND_BLOCK_WORST  (2 + lzav_compress_bound(REWIND_BLOCK_SIZE))
+
+// ---------------------------------------------------------------------------------------
+// Memory for the ring is only grabbed if rewind is enabled - and it's grabbed once.
+// ---------------------------------------------------------------------------------------
+static u8 rewind_alloc(void)
+{
+    if (rewind_ring) return 1;
+    if (rewind_no_memory) return 0;
+
+    rewind_budget = isDSiMode() ? REWIND_BUDGET_DSI : REWIND_BUDGET_DS;
+    rewind_latest = malloc(REWIND_STATE_SIZE);
+    rewind_work   = malloc(REWIND_STATE_SIZE);
+    rewind_ring   = malloc(rewind_budget);
+
+    if (!rewind_latest || !rewind_work || !rewind_ring)
+    {
+        free(rewind_latest); rewind_latest = NULL;
+        free(rewind_work);   rewind_work   = NULL;
+        free(rewind_ring);   rewind_ring   = NULL;
+        rewind_no_memory = 1;
+        return 0;
+    }
+
+    return 1;
+}
+
+static inline u32 rewind_block_len(u32 offset)
+{
+    return ((rewind_state_len - offset) < REWIND_BLOCK_SIZE) ? (rewind_state_len - offset) : REWIND_BLOCK_SIZE;
+}
+
+static void rewind_clear_history(void)
+{
+    rewind_tail   = 0;
+    rewind_num    = 0;
+    rewind_head   = 0;
+    rewind_blocks = 0;
+    rewind_block  = 0;
+}
+
+static void rewind_drop_oldest(void)
+{
+    rewind_tail = (rewind_tail + 1) % REWIND_MAX_ENTRIES;
+    rewind_num--;
+}
+
+static u8 rewind_overlaps(u32 start, u32 len)
+{
+    for (u16 i=0; i<rewind_num; i++)
+    {
+        rewind_entry_t *e = &rewind_entries[(rewind_tail + i) % REWIND_MAX_ENTRIES];
+        if ((e->offset < (start + len)) && ((e->offset + e->length) > start)) return 1;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------------------
+// Make room in the ring for a worst-case delta, throwing out the oldest history as needed.
+// Deltas are always contiguous so if we don't fit at the end we wrap back to the start.
+// ---------------------------------------------------------------------------------------
+static u8 rewind_reserve(u32 need)
+{
+    if (need > rewind_budget) return 0;
+    if ((rewind_head + need) > rewind_budget) rewind_head = 0;
+
+    if (rewind_num == REWIND_MAX_ENTRIES) rewind_drop_oldest();
+    while (rewind_num && rewind_overlaps(rewind_head, need))
+    {
+        rewind_drop_oldest();
+    }
+
+    rewind_entry_pos = rewind_head;
+    rewind_entry_len = 0;
+    return 1;
+}
+
+// ---------------------------------------------------------------------------------------
+// XOR one block of the new state against the latest and compress it into the ring.
+// ---------------------------------------------------------------------------------------
+static void rewind_capture_block(void)
+{
+    u32 offset = rewind_block * REWIND_BLOCK_SIZE;
+    u32 len    = rewind_block_len(offset);
+    u32 *cur   = (u32 *)(rewind_work + offset);
+    u32 *prev  = (u32 *)(rewind_latest + offset);
+    u32 diff   = 0;
+    u16 hdr    = 0;
+    u8 *dst    = rewind_ring + rewind_entry_pos + rewind_entry_len;
+
+    for (u32 i=0; i<len/4; i++)
+    {
+        rewind_scratch[i] = cur[i] ^ prev[i];
+        diff |= rewind_scratch[i];
+    }
+
+    if (diff)
+    {
+        int comp_len = lzav_compress(rewind_scratch, dst + 2, len, REWIND_BLOCK_WORST - 2, rewind_hash, sizeof(rewind_hash));
+
+        if ((comp_len > 0) && ((u32)comp_len < len))
+        {
+            hdr = comp_len;
+        }
+        else
+        {
+            hdr = REWIND_BLOCK_RAW;
+            memcpy(dst + 2, rewind_scratch, len);
+        }
+    }
+
+    dst[0] = hdr & 0xFF;
+    dst[1] = hdr >> 8;
+    rewind_entry_len += 2 + ((hdr == REWIND_BLOCK_RAW) ? len : hdr);
+
+    rewind_block++;
+}
+
+// ---------------------------------------------------------------------------------------
+// Undo the newest delta - this turns rewind_latest into the snapshot taken before it.
+// ---------------------------------------------------------------------------------------
+static u8 rewind_pop(void)
+{
+    rewind_entry_t *e = &rewind_entries[(rewind_tail + rewind_num - 1) % REWIND_MAX_ENTRIES];
+    const u8 *src = rewind_ring + e->offset;
+
+    for (u32 offset = 0; offset < rewind_state_len; offset += REWIND_BLOCK_SIZE)
+    {
+        u32 len = rewind_block_len(offset);
+        u16 hdr = src[0] | (src[1] << 8);
+        src += 2;
+
+        if (hdr == 0) continue;     // Nothing changed in this block
+
+        if (hdr == REWIND_BLOCK_RAW)
+        {
+            memcpy(rewind_scratch, src, len);
+            src += len;
+        }
+        else
+        {
+            if (lzav_decompress(src, rewind_scratch, hdr, len) != (int)len)
+            {
+                RewindReset();              // Should never happen... but don't restore garbage
+                return 0;
+            }
+            src += hdr;
+        }
+
+        u32 *dst = (u32 *)(rewind_latest + offset);
+        for (u32 i=0; i<len/4; i++)
+        {
+            dst[i] ^= rewind_scratch[i];
+        }
+    }
+
+    rewind_head = e->offset;    // Reclaim the space
+    rewind_num--;
+    return 1;
+}
+
+// ---------------------------------------------------------------------------------------
+// Throw away all history - called when a game is started, reset or a state is loaded.
+// ---------------------------------------------------------------------------------------
+void RewindReset(void)
+{
+    rewind_clear_history();
+    rewind_state_len   = 0;
+    rewind_frames      = 0;
+    rewind_held        = 0;
+    rewind_at_latest   = 0;
+    rewind_hold_frames = 0;
+}
+
+// ---------------------------------------------------------------------------------------
+// Disk games don't get a rewind history - sectors written since a snapshot stay written
+// in the disk image, so stepping back would leave the FDC and the disk out of step (the
+// same reason run-ahead is off for disks).
+// ---------------------------------------------------------------------------------------
+static u8 rewind_allowed(void)
+{
+    return (myGlobalConfig.rewind && (draco_mode < MODE_DSK));
+}
+
+// ---------------------------------------------------------------------------------------
+// Called once per emulated frame. Takes a new snapshot every REWIND_INTERVAL frames and
+// spreads the work of delta-compressing it over the frames that follow.
+// ---------------------------------------------------------------------------------------
+void RewindFrame(void)
+{
+    if (!rewind_allowed()) return;
+
+    if (rewind_held)        // Rewinding - don't capture anything this frame
+    {
+        rewind_held = 0;
+        return;
+    }
+
+    if (rewind_at_latest)   // Rewind keys just let go - carry on from here
+    {
+        rewind_at_latest   = 0;
+        rewind_hold_frames = 0;
+        DSPrint(12,0,0,"      ");
+    }
+
+    rewind_frames++;
+
+    if (rewind_blocks == 0)
+    {
+        if (rewind_frames < REWIND_INTERVAL) return;
+        rewind_frames = 0;
+
+        if (!rewind_alloc()) return;
+
+        u16 start = PerfClock();
+        u32 len = DracoStateSerialize(rewind_work, REWIND_STATE_SIZE, STATE_FLAG_RAM_RAW | STATE_FLAG_NO_CRC);
+        rewind_snap_us = PerfTicksToUs((u16)(PerfClock() - start));
+        if (len == 0) return;
+
+        if (len != rewind_state_len)    // First snapshot (or the state changed shape) - it becomes the reference
+        {
+            u8 *tmp = rewind_latest; rewind_latest = rewind_work; rewind_work = tmp;
+            rewind_state_len = len;
+            rewind_clear_history();
+            return;
+        }
+
+        if (!rewind_reserve(((len + REWIND_BLOCK_SIZE - 1) / REWIND_BLOCK_SIZE) * REWIND_BLOCK_WORST)) return;
+
+        rewind_blocks = (len + REWIND_BLOCK_SIZE - 1) / REWIND_BLOCK_SIZE;
+        rewind_block  = 0;
+    }
+
+    u16 start = PerfClock();
+    for (u8 i=0; (i < REWIND_BLOCKS_PER_FRAME) && (rewind_block < rewind_blocks); i++)
+    {
+        rewind_capture_block();
+    }
+    rewind_delta_us = PerfTicksToUs((u16)(PerfClock() - start));
+
+    if (rewind_block == rewind_blocks)  // Delta is complete - add it to the ring
+    {
+        rewind_entry_t *e = &rewind_entries[(rewind_tail + rewind_num) % REWIND_MAX_ENTRIES];
+        e->offset = rewind_entry_pos;
+        e->length = rewind_entry_len;
+        rewind_num++;
+        rewind_head = rewind_entry_pos + rewind_entry_len;
+
+        u8 *tmp = rewind_latest; rewind_latest = rewind_work; rewind_work = tmp;
+        rewind_blocks = 0;
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// Called every frame the rewind keys are held. The first call puts the machine back to the
+// most recent snapshot and every REWIND_STEP_FRAMES after that we step back one more.
+// ---------------------------------------------------------------------------------------
+void RewindStep(void)
+{
+    if (!rewind_allowed() || !rewind_state_len) return;
+
+    MovieStop();    // A movie can't follow the machine back in time
+
+    rewind_held   = 1;
+    rewind_blocks = 0;      // Abandon any capture in progress
+    rewind_frames = 0;
+
+    if (rewind_at_latest && (++rewind_hold_frames >= REWIND_STEP_FRAMES))
+    {
+        rewind_hold_frames = 0;
+        if (rewind_num && !rewind_pop()) return;
+    }
+
+    DracoStateDeserialize(rewind_latest, rewind_state_len, 0);
+    rewind_at_latest = 1;
+
+    DSPrint(12,0,0,"REWIND");
+}
+
+// End of file
@@ -0,0 +1,42 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#ifndef _REWIND_H_
+#define _REWIND_H_
+
+#include <nds.h>
+
+// ---------------------------------------------------------------------------------------
+// The rewind ring is a fixed memory budget allocated once. The DSi has plenty of memory
+// to spare so it gets a longer history. Either can be overridden at build time.
+// ---------------------------------------------------------------------------------------
+#ifndef REWIND_BUDGET_DS
+#define REWIND_BUDGET_DS        (1024*1024)     // About a minute or two of history for most games
+#endif
+#ifndef REWIND_BUDGET_DSI
+#define REWIND_BUDGET_DSI       (4*1024*1024)
+#endif
+
+#define REWIND_INTERVAL         10              // Capture a snapshot every this many frames
+#define REWIND_STEP_FRAMES      4               // While rewinding, step back one snapshot every this many frames
+#define REWIND_BLOCK_SIZE       8192            // Deltas are compressed in blocks of this size...
+#define REWIND_BLOCKS_PER_FRAME 2               // ...and only this many blocks are processed each frame
+#define REWIND_STATE_SIZE       (96*1024)       // Plenty for a raw (uncompressed RAM) machine state
+#define REWIND_MAX_ENTRIES      1024
+
+extern u32 rewind_snap_us;
+extern u32 rewind_delta_us;
+
+extern void RewindReset(void);
+extern void RewindFrame(void);
+extern void RewindStep(void);
+
+#endif // _REWIND_H_
@@ -0,0 +1,121 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#include <nds.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "DracoDS.h"
+#include "DracoUtils.h"
+#include "saveload.h"
+#include "fdc.h"
+#include "paste.h"
+#include "movie.h"
+#include "perf.h"
+#include "trace.h"
+#include "profile.h"
+#include "stats.h"
+#include "printf.h"
+
+#include "runahead.h"
+
+// ---------------------------------------------------------------------------------------
+// Most games poll the keyboard/joystick once per VSync IRQ so whatever we feed in at the
+// end of a frame doesn't show up on screen until a frame or two later. With run-ahead we
+// snapshot the machine right after the new input is applied, silently run one or two
+// frames into the future, show the last of those and then put the machine back. The real
+// frames still run (and still drive the audio) - they just never get drawn. This leans
+// entirely on the raw in-memory state being cheap so the save/restore is timed and
+// shown on the debugger screen.
+//
+// Disk games are left alone - a sector written during a speculative frame goes straight
+// into the disk image and can't be taken back. Same for the tape (which runs full speed
+// anyway) and a text paste in progress (the paste engine is driven by keyboard scans).
+// ---------------------------------------------------------------------------------------
+u8  runahead_mask       __attribute__((section(".dtcm"))) = 0;
+
+u32 runahead_save_us    = 0;    // Most recent snapshot time in microseconds
+u32 runahead_load_us    = 0;    // Most recent restore time in microseconds
+
+static u8 *runahead_state    = NULL;
+static u8  runahead_no_memory = 0;
+
+static u8 runahead_alloc(void)
+{
+    if (runahead_state) return 1;
+    if (runahead_no_memory) return 0;
+
+    runahead_state = malloc(RUNAHEAD_STATE_SIZE);
+    if (!runahead_state) runahead_no_memory = 1;
+
+    return (runahead_state != NULL);
+}
+
+static u8 runahead_allowed(void)
+{
+    if (!myGlobalConfig.runAhead) return 0;
+    if (draco_mode >= MODE_DSK) return 0;
+    if (tape_motor || paste_active) return 0;
+    if (myGlobalConfig.debugger) return 0;      // The debugger wants to see the real machine
+    if (movie_mode != MOVIE_OFF) return 0;      // Movies are timed and hashed on the real frames
+    if (TRACE_ACTIVE) return 0;                 // Only the real frames go into the trace
+    if (profile_hits) return 0;                 // Nor the profile - each hot spot would be counted once per frame run
+    if (DRACO_STATS) return 0;                  // Same for the opcode/IO counts (averaged over the real frames)
+
+    return runahead_alloc();
+}
+
+// ---------------------------------------------------------------------------------------
+// Called when a game is started or reset - the next frame is drawn normally.
+// ---------------------------------------------------------------------------------------
+void RunAheadReset(void)
+{
+    runahead_mask = 0;
+}
+
+// ---------------------------------------------------------------------------------------
+// Called once per frame after the input for the next frame has been applied.
+// ---------------------------------------------------------------------------------------
+void RunAheadFrame(void)
+{
+    if (!runahead_allowed())
+    {
+        runahead_mask = 0;      // Next real frame is the one we show
+        return;
+    }
+
+    u16 start = PerfClock();
+    u32 len = DracoStateSerialize(runahead_state, RUNAHEAD_STATE_SIZE, STATE_FLAG_RAM_RAW | STATE_FLAG_NO_CRC | STATE_FLAG_NO_MEDIA);
+    runahead_save_us = PerfTicksToUs((u16)(PerfClock() - start));
+
+    if (len == 0)
+    {
+        runahead_mask = 0;
+        return;
+    }
+
+    // Silently run ahead... only the last frame is drawn
+    for (u8 frame = 0; frame < myGlobalConfig.runAhead; frame++)
+    {
+        runahead_mask = RUNAHEAD_NO_AUDIO | ((frame == (myGlobalConfig.runAhead - 1)) ? 0 : RUNAHEAD_NO_VIDEO);
+        while (!dragon_run()) ;
+    }
+
+    start = PerfClock();
+    DracoStateDeserialize(runahead_state, len, 0);
+    runahead_load_us = PerfTicksToUs((u16)(PerfClock() - start));
+
+    runahead_mask = RUNAHEAD_NO_VIDEO;  // The real frame is heard but not seen
+}
+
+// End of file
@@ -0,0 +1,29 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#ifndef _RUNAHEAD_H_
+#define _RUNAHEAD_H_
+
+#include <nds.h>
+
+#define RUNAHEAD_STATE_SIZE     (96*1024)       // Plenty for a raw (uncompressed RAM) machine state
+
+#define RUNAHEAD_NO_VIDEO       0x01            // dragon_run() skips drawing the frame at VSync
+#define RUNAHEAD_NO_AUDIO       0x02            // dragon_run() skips the DAC audio for each scanline
+
+extern u8  runahead_mask;
+extern u32 runahead_save_us;
+extern u32 runahead_load_us;
+
+extern void RunAheadReset(void);
+extern void RunAheadFrame(void);
+
+#endif // _RUNAHEAD_H_
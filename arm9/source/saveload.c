@@ -31,32 +31,474 @@
 
 #include "lzav.h"
 
-#define DRACO_SAVE_VER   0x0006       // Change this if the basic format of the .SAV file changes. Invalidates older .sav files.
+#include "saveload.h"
+#include "movie.h"
+#include "rewind.h"
 
-u8 CompressBuffer[128*1024];
+#define DRACO_SAVE_VER   0x0008       // Change this if the basic format of the .SAV file changes. Invalidates older .sav files.
+
+u8 CompressBuffer[STATE_BUFFER_SIZE];
 
 char szLoadFile[MAX_FILENAME_LEN+1];
 char tmpStr[34];
 
-uint8_t spare[16] = {0};
+extern u8  bFireDiskIRQ;
+extern s16 last_sample;
+extern s16 beeper_vol;
+
+// ---------------------------------------------------------------------------------------
+// Each subsystem registers a chunk in the table below. Most chunks are just a list of
+// variables copied in order - new variables can be added to the end of a list without
+// invalidating older saves (a shorter chunk simply leaves the newer variables alone).
+// Chunks that need more than that (compressed RAM, re-loading the media) provide their
+// own save/load handlers instead of a variable list. Structs are always listed field by
+// field - a raw struct would move every field after one that gets added to it.
+//
+// If a chunk layout ever has to change in a way that isn't an append, bump its version
+// and move 'oldest' up to match - older saves are then rejected rather than misread.
+// ---------------------------------------------------------------------------------------
+typedef struct
+{
+    void *ptr;
+    u32   size;
+} state_item_t;
 
-void DracoSaveState()
+#define STATE_ITEM(x)   {(void *)&(x), sizeof(x)}
+#define STATE_ITEM_END  {NULL, 0}
+
+typedef struct
+{
+    u32                 tag;
+    u16                 version;
+    u16                 oldest;                                             // Oldest chunk version we can still read
+    const state_item_t *items;                                              // Simple chunks: list of variables
+    void                (*pre_save)(void);                                  // Optional: called before the items are gathered
+    void                (*post_load)(void);                                 // Optional: called after the items are restored
+    u32                 (*save)(u8 *dst, u32 room, u16 flags);              // Custom chunks: returns bytes written (0 = error)
+    u8                  (*load)(const u8 *src, u32 len, u16 version, u16 flags); // Custom chunks: returns 0 on error
+    u8                  (*check)(const u8 *src, u32 len, u16 version);      // Custom chunks: returns 0 if load() would fail
+} state_handler_t;
+
+// ---------------------------------------------------------------------------------------
+// File chunk - the tape/disk/cart we were running. On a full restore from the SD card we
+// re-read the media so that the tape position and disk contents line up with the state.
+// ---------------------------------------------------------------------------------------
+static u32 state_save_file(u8 *dst, u32 room, u16 flags)
+{
+    if (room < (sizeof(last_path) + sizeof(last_file))) return 0;
+    memcpy(dst, last_path, sizeof(last_path));
+    memcpy(dst + sizeof(last_path), last_file, sizeof(last_file));
+    return sizeof(last_path) + sizeof(last_file);
+}
+
+static u8 state_check_file(const u8 *src, u32 len, u16 version)
 {
-  size_t retVal;
+    return (len >= (sizeof(last_path) + sizeof(last_file)));
+}
 
-  // Return to the original path
-  chdir(initial_path);
+static u8 state_load_file(const u8 *src, u32 len, u16 version, u16 flags)
+{
+    if (!state_check_file(src, len, version)) return 0;
+    memcpy(last_path, src, sizeof(last_path));
+    memcpy(last_file, src + sizeof(last_path), sizeof(last_file));
+
+    // ---------------------------------------------------------------
+    // If we saved a last path/file, we load it back up if possible....
+    // ---------------------------------------------------------------
+    if ((flags & STATE_FLAG_RELOAD_MEDIA) && (strlen(last_path) > 1))
+    {
+        chdir(last_path);
 
-  // Init filename = romname and SAV in place of ROM
-  DIR* dir = opendir("sav");
-  if (dir) closedir(dir);    // Directory exists... close it out and move on.
-  else mkdir("sav", 0777);   // Otherwise create the directory...
-  sprintf(szLoadFile,"sav/%s", initial_file);
+        if (strlen(last_file) > 1)
+        {
+            ReadFileCarefully(last_file, TapeCartDiskBuffer, sizeof(TapeCartDiskBuffer), 0);
+        }
+    }
+    return 1;
+}
+
+// ---------------------------------------------------------------------------------------
+// RAM chunk - a 4 byte preamble (method) followed by the 64K of RAM either raw or lzav
+// compressed. The 'high' compression ratio is still quite fast for such a small memory
+// buffer and gets a typical game under 32K on the SD card.
+// ---------------------------------------------------------------------------------------
+#define STATE_RAM_RAW   0
+#define STATE_RAM_LZAV  1
+
+static u32 state_save_ram(u8 *dst, u32 room, u16 flags)
+{
+    int comp_len;
+
+    if (room < 4) return 0;
+    memset(dst, 0x00, 4);
+
+    if (flags & STATE_FLAG_RAM_RAW)
+    {
+        if (room < (4 + 0x10000)) return 0;
+        dst[0] = STATE_RAM_RAW;
+        memcpy(dst + 4, memory_RAM, 0x10000);
+        return 4 + 0x10000;
+    }
+
+    if (flags & STATE_FLAG_RAM_FAST)
+        comp_len = lzav_compress_default(memory_RAM, dst + 4, 0x10000, room - 4);
+    else
+        comp_len = lzav_compress_hi(memory_RAM, dst + 4, 0x10000, room - 4);
+
+    if (comp_len <= 0) return 0;
+    dst[0] = STATE_RAM_LZAV;
+
+    return 4 + comp_len;
+}
+
+// The lzav stream itself can only be checked by decompressing it - the CRC over the
+// whole state covers that (and raw RAM is what the un-CRC'd quick slots use).
+static u8 state_check_ram(const u8 *src, u32 len, u16 version)
+{
+    if (len < 4) return 0;
+    if (src[0] == STATE_RAM_RAW) return (len >= (4 + 0x10000));
+    return (src[0] == STATE_RAM_LZAV);
+}
+
+static u8 state_load_ram(const u8 *src, u32 len, u16 version, u16 flags)
+{
+    if (!state_check_ram(src, len, version)) return 0;
+
+    if (src[0] == STATE_RAM_RAW)
+    {
+        memcpy(memory_RAM, src + 4, 0x10000);
+        return 1;
+    }
+
+    return (lzav_decompress(src + 4, memory_RAM, len - 4, 0x10000) == 0x10000);
+}
+
+// ---------------------------------------------------------------------------------------
+// CPU chunk - the CC flags are kept unpacked in the core so we fold them into cpu.cc
+// ---------------------------------------------------------------------------------------
+static void state_pre_save_cpu(void)
+{
+    cpu.cc = cpu_get_cc();
+}
+
+static void state_post_load_cpu(void)
+{
+    cpu_set_cc(cpu.cc);
+}
+
+// ---------------------------------------------------------------------------------------
+// FDC chunk - the disk buffer pointers are never saved... they always point to our
+// own buffers and the memory layout can move between builds.
+// ---------------------------------------------------------------------------------------
+static void state_post_load_fdc(void)
+{
+    Geom.disk0 = TapeCartDiskBuffer;
+}
+
+static const state_item_t state_items_cpu[] =
+{
+    STATE_ITEM(cpu.cpu_state),
+    STATE_ITEM(cpu.x),
+    STATE_ITEM(cpu.y),
+    STATE_ITEM(cpu.u),
+    STATE_ITEM(cpu.s),
+    STATE_ITEM(cpu.pc),
+    STATE_ITEM(cpu.a),
+    STATE_ITEM(cpu.b),
+    STATE_ITEM(cpu.dp),
+    STATE_ITEM(cpu.cc),
+    STATE_ITEM(cpu.int_latch),
+    STATE_ITEM(cpu.nmi_armed),
+    STATE_ITEM(cpu.nmi_latched),
+    STATE_ITEM(cpu.halt_asserted),
+    STATE_ITEM(cpu.reset_asserted),
+    STATE_ITEM(cpu.irq_asserted),
+    STATE_ITEM(cpu.firq_asserted),
+    STATE_ITEM(cpu.exception_line_num),
+    STATE_ITEM(cycles_this_scanline),
+    STATE_ITEM_END
+};
+
+static const state_item_t state_items_sam[] =
+{
+    STATE_ITEM(sam_registers.vdg_mode),
+    STATE_ITEM(sam_registers.vdg_display_offset),
+    STATE_ITEM(sam_registers.page),
+    STATE_ITEM(sam_registers.mpu_rate),
+    STATE_ITEM(sam_registers.memory_size),
+    STATE_ITEM(sam_registers.reserved),              // Unused - kept so existing states still line up
+    STATE_ITEM(sam_registers.memory_map_type),
+    STATE_ITEM(sam_registers.map_upper_to_lower),
+    STATE_ITEM(sam_64k_mode_counter),
+    STATE_ITEM_END
+};
+
+static const state_item_t state_items_pia[] =
+{
+    STATE_ITEM(pia0_ca1_int_enabled),
+    STATE_ITEM(pia0_cb1_int_enabled),
+    STATE_ITEM(pia1_cb1_int_enabled),
+    STATE_ITEM(mux_select),
+    STATE_ITEM(cas_eof),
+    STATE_ITEM(tape_pos),
+    STATE_ITEM(tape_motor),
+    STATE_ITEM(keyboard_rows),
+    STATE_ITEM(pia0_ddr_a),
+    STATE_ITEM(pia0_ddr_b),
+    STATE_ITEM(pia1_ddr_a),
+    STATE_ITEM(pia1_ddr_b),
+    STATE_ITEM(pia0_ddr_a_mask),
+    STATE_ITEM(pia0_ddr_b_mask),
+    STATE_ITEM(pia1_ddr_a_mask),
+    STATE_ITEM(pia1_ddr_b_mask),
+    STATE_ITEM(pia0_a_output_latch),
+    STATE_ITEM(pia0_b_output_latch),
+    STATE_ITEM(pia1_a_output_latch),
+    STATE_ITEM(pia1_b_output_latch),
+    STATE_ITEM_END
+};
+
+static const state_item_t state_items_vdg[] =
+{
+    STATE_ITEM(video_ram_offset),
+    STATE_ITEM(sam_video_mode),
+    STATE_ITEM(sam_2x_rez),
+    STATE_ITEM(pia_video_mode),
+    STATE_ITEM(current_mode),
+    STATE_ITEM_END
+};
+
+static const state_item_t state_items_fdc[] =
+{
+    STATE_ITEM(nmi_enable),
+    STATE_ITEM(halt_flag),
+    STATE_ITEM(FDC.status),
+    STATE_ITEM(FDC.command),
+    STATE_ITEM(FDC.track),
+    STATE_ITEM(FDC.sector),
+    STATE_ITEM(FDC.data),
+    STATE_ITEM(FDC.drive),
+    STATE_ITEM(FDC.side),
+    STATE_ITEM(FDC.motor),
+    STATE_ITEM(FDC.wait_for_read),
+    STATE_ITEM(FDC.wait_for_write),
+    STATE_ITEM(FDC.commandType),
+    STATE_ITEM(FDC.write_track_allowed),
+    STATE_ITEM(FDC.stepDirection),
+    STATE_ITEM(FDC.drq_pending),
+    STATE_ITEM(FDC.track_dirty),
+    STATE_ITEM(FDC.disk_write),
+    STATE_ITEM(FDC.write_tracks),
+    STATE_ITEM(FDC.track_buffer),
+    STATE_ITEM(FDC.track_buffer_idx),
+    STATE_ITEM(FDC.track_buffer_end),
+    STATE_ITEM(FDC.indexPulseCounter),
+    STATE_ITEM(FDC.sector_byte_counter),
+    STATE_ITEM(FDC.write_track_byte_counter),
+    STATE_ITEM(FDC.clock),
+    STATE_ITEM(FDC.event_clock),
+    STATE_ITEM(FDC.motor_ready_clock),
+    STATE_ITEM(Geom.fdc_type),
+    STATE_ITEM(Geom.drives),
+    STATE_ITEM(Geom.sides),
+    STATE_ITEM(Geom.tracks),
+    STATE_ITEM(Geom.sectors),
+    STATE_ITEM(Geom.sectorSize),
+    STATE_ITEM(Geom.startSector),
+    STATE_ITEM(io_show_status),
+    STATE_ITEM(bFireDiskIRQ),
+    STATE_ITEM_END
+};
+
+static const state_item_t state_items_audio[] =
+{
+    STATE_ITEM(dac_output),
+    STATE_ITEM(sound_enable),
+    STATE_ITEM(last_sample),
+    STATE_ITEM(beeper_vol),
+    STATE_ITEM_END
+};
+
+static const state_item_t state_items_draco[] =
+{
+    STATE_ITEM(draco_line),
+    STATE_ITEM(draco_special_key),
+    STATE_ITEM(last_file_size),
+    STATE_ITEM(tape_play_skip_frame),
+    STATE_ITEM(draco_scanline_counter),
+    STATE_ITEM(joy_x),
+    STATE_ITEM(joy_y),
+    STATE_ITEM(emuFps),
+    STATE_ITEM(emuActFrames),
+    STATE_ITEM(timingFrames),
+    STATE_ITEM_END
+};
+
+// The media chunk must come first so the disk/tape is back in memory before anything points into it.
+// CPU and FDC went to version 2 when their structs stopped being saved raw (no padding now).
+static const state_handler_t state_handlers[] =
+{
+    {STATE_TAG('F','I','L','E'), 1, 1, NULL,               NULL,               NULL,                state_save_file, state_load_file, state_check_file},
+    {STATE_TAG('C','P','U',' '), 2, 2, state_items_cpu,    state_pre_save_cpu, state_post_load_cpu, NULL,            NULL,            NULL},
+    {STATE_TAG('S','A','M',' '), 1, 1, state_items_sam,    NULL,               NULL,                NULL,            NULL,            NULL},
+    {STATE_TAG('P','I','A',' '), 1, 1, state_items_pia,    NULL,               NULL,                NULL,            NULL,            NULL},
+    {STATE_TAG('V','D','G',' '), 1, 1, state_items_vdg,    NULL,               NULL,                NULL,            NULL,            NULL},
+    {STATE_TAG('F','D','C',' '), 2, 2, state_items_fdc,    NULL,               state_post_load_fdc, NULL,            NULL,            NULL},
+    {STATE_TAG('A','U','D',' '), 1, 1, state_items_audio,  NULL,               NULL,                NULL,            NULL,            NULL},
+    {STATE_TAG('D','R','C','O'), 1, 1, state_items_draco,  NULL,               NULL,                NULL,            NULL,            NULL},
+    {STATE_TAG('R','A','M',' '), 1, 1, NULL,               NULL,               NULL,                state_save_ram,  state_load_ram,  state_check_ram},
+};
+
+#define STATE_NUM_HANDLERS  (sizeof(state_handlers) / sizeof(state_handlers[0]))
+#define STATE_ALIGN(x)      (((x) + 3) & ~3)
+
+// ---------------------------------------------------------------------------------------
+// Assemble the entire machine state into one memory buffer. Returns the number of bytes
+// used or 0 if the buffer was too small. The result can be written out with a single
+// fwrite() or simply kept in memory.
+// ---------------------------------------------------------------------------------------
+u32 DracoStateSerialize(u8 *buf, u32 buf_size, u16 flags)
+{
+    struct state_header_t header;
+    struct state_chunk_t  chunk;
+    u32 pos = sizeof(header);
 
-  int len = strlen(szLoadFile);
-  szLoadFile[len-3] = 's';
-  szLoadFile[len-2] = 'a';
-  szLoadFile[len-1] = 'v';
+    for (u8 i=0; i <= STATE_NUM_HANDLERS; i++)
+    {
+        if ((pos + sizeof(chunk)) > buf_size) return 0;
+
+        u8  *data = buf + pos + sizeof(chunk);
+        u32 room  = buf_size - pos - sizeof(chunk);
+        u32 len   = 0;
+
+        if (i == STATE_NUM_HANDLERS)    // All done - close out the list
+        {
+            chunk.tag     = STATE_TAG_END;
+            chunk.version = 1;
+        }
+        else
+        {
+            const state_handler_t *h = &state_handlers[i];
+
+            if ((flags & STATE_FLAG_NO_MEDIA) && !h->items && (h->save == state_save_file)) continue;
+
+            chunk.tag     = h->tag;
+            chunk.version = h->version;
+
+            if (h->items)
+            {
+                if (h->pre_save) h->pre_save();
+                for (const state_item_t *item = h->items; item->ptr; item++)
+                {
+                    if ((len + item->size) > room) return 0;
+                    memcpy(data + len, item->ptr, item->size);
+                    len += item->size;
+                }
+            }
+            else
+            {
+                len = h->save(data, room, flags);
+                if (len == 0) return 0;
+            }
+        }
+
+        if (STATE_ALIGN(len) > room) return 0;
+        memset(data + len, 0x00, STATE_ALIGN(len) - len);   // Keep every chunk header word aligned
+
+        chunk.reserved = 0;
+        chunk.length   = len;
+        memcpy(buf + pos, &chunk, sizeof(chunk));
+        pos += sizeof(chunk) + STATE_ALIGN(len);
+    }
+
+    header.save_ver = DRACO_SAVE_VER;
+    header.flags    = flags;
+    header.length   = pos - sizeof(header);
+    header.crc      = (flags & STATE_FLAG_NO_CRC) ? 0 : getCRC32(buf + sizeof(header), header.length);
+    memcpy(buf, &header, sizeof(header));
+
+    return pos;
+}
+
+static const state_handler_t *state_find_handler(u32 tag)
+{
+    for (u8 i=0; i < STATE_NUM_HANDLERS; i++)
+    {
+        if (state_handlers[i].tag == tag) return &state_handlers[i];
+    }
+    return NULL;    // Unknown chunk - from a newer build, skip it
+}
+
+// ---------------------------------------------------------------------------------------
+// Restore the machine from a state built by DracoStateSerialize(). The chunks are walked
+// twice: first to check every header, length and version, and only then to apply them -
+// a bad chunk part way through must not leave the machine half restored. Unknown chunks
+// are skipped. Returns 1 on success.
+// ---------------------------------------------------------------------------------------
+u8 DracoStateDeserialize(const u8 *buf, u32 len, u16 flags)
+{
+    struct state_header_t header;
+    struct state_chunk_t  chunk;
+    const state_handler_t *h;
+
+    if (len < sizeof(header)) return 0;
+    memcpy(&header, buf, sizeof(header));
+
+    if (header.save_ver != DRACO_SAVE_VER) return 0;
+    if (header.length > (len - sizeof(header))) return 0;
+    if ((flags & STATE_FLAG_VERIFY_CRC) && (header.flags & STATE_FLAG_NO_CRC)) return 0;
+    if (!(header.flags & STATE_FLAG_NO_CRC) && (getCRC32((u8 *)buf + sizeof(header), header.length) != header.crc)) return 0;
+
+    u32 end = sizeof(header) + header.length;
+
+    for (u8 apply = 0; apply < 2; apply++)
+    {
+        u32 pos = sizeof(header);
+
+        while (1)
+        {
+            if ((pos + sizeof(chunk)) > end) return 0;  // Never found the end marker
+            memcpy(&chunk, buf + pos, sizeof(chunk));
+            pos += sizeof(chunk);
+
+            if (chunk.tag == STATE_TAG_END) break;
+            if (chunk.length > (end - pos)) return 0;
+
+            h = state_find_handler(chunk.tag);
+
+            if (h && !apply)
+            {
+                if (chunk.version < h->oldest) return 0;
+                if (!h->items && !h->check(buf + pos, chunk.length, chunk.version)) return 0;
+            }
+            else if (h && h->items)
+            {
+                u32 idx = 0;
+                for (const state_item_t *item = h->items; item->ptr && ((idx + item->size) <= chunk.length); item++)
+                {
+                    memcpy(item->ptr, buf + pos + idx, item->size);
+                    idx += item->size;
+                }
+                if (h->post_load) h->post_load();
+            }
+            else if (h && !h->load(buf + pos, chunk.length, chunk.version, flags)) return 0;
+
+            pos += STATE_ALIGN(chunk.length);
+        }
+    }
+
+    return 1;
+}
+
+/*********************************************************************************
+ * Save the current state - everything is assembled in memory and written at once.
+ ********************************************************************************/
+void DracoSaveState()
+{
+  size_t retVal = 0;
+
+  // Init filename = romname and SAV in place of ROM
+  DracoSavFilename(szLoadFile, "sav");
 
   strcpy(tmpStr,"SAVING...");
   DSPrint(12,0,0,tmpStr);
@@ -64,85 +506,10 @@ void DracoSaveState()
   FILE *handle = fopen(szLoadFile, "wb+");
   if (handle != NULL)
   {
-    // Write Version
-    u16 save_ver = DRACO_SAVE_VER;
-    retVal = fwrite(&save_ver, sizeof(u16), 1, handle);
-
-    // Write Last Directory Path / Tape File
-    if (retVal) retVal = fwrite(&last_path, sizeof(last_path), 1, handle);
-    if (retVal) retVal = fwrite(&last_file, sizeof(last_file), 1, handle);
-    
-    // Write Motorola 6809 CPU
-    if (retVal) retVal = fwrite(&cpu, sizeof(cpu), 1, handle);
-
-    // Write SAM registers
-    if (retVal) retVal = fwrite(&sam_registers, sizeof(sam_registers), 1, handle);
-    
-    // Write DISK vars
-    if (retVal) retVal = fwrite(&nmi_enable, sizeof(nmi_enable), 1, handle);
-    if (retVal) retVal = fwrite(&halt_flag,  sizeof(halt_flag),  1, handle);
-    
-    // Write FDC vars
-    if (retVal) retVal = fwrite(&FDC,                   sizeof(FDC),                1, handle);
-    if (retVal) retVal = fwrite(&Geom,                  sizeof(Geom),               1, handle);
-    if (retVal) retVal = fwrite(&io_show_status,        sizeof(io_show_status),     1, handle);
-    
-    // Write PIA vars
-    if (retVal) retVal = fwrite(&pia0_ca1_int_enabled,  sizeof(pia0_ca1_int_enabled),   1, handle);
-    if (retVal) retVal = fwrite(&pia0_cb1_int_enabled,  sizeof(pia0_cb1_int_enabled),   1, handle);
-    if (retVal) retVal = fwrite(&pia1_cb1_int_enabled,  sizeof(pia1_cb1_int_enabled),   1, handle);
-    if (retVal) retVal = fwrite(&mux_select,            sizeof(mux_select),             1, handle);
-    if (retVal) retVal = fwrite(&dac_output,            sizeof(dac_output),             1, handle);
-    if (retVal) retVal = fwrite(&sound_enable,          sizeof(sound_enable),           1, handle);
-    if (retVal) retVal = fwrite(&cas_eof,               sizeof(cas_eof),                1, handle);
-    if (retVal) retVal = fwrite(&tape_pos,              sizeof(tape_pos),               1, handle);
-    if (retVal) retVal = fwrite(&tape_motor,            sizeof(tape_motor),             1, handle);
-    if (retVal) retVal = fwrite(keyboard_rows,          sizeof(keyboard_rows),          1, handle);    
-    if (retVal) retVal = fwrite(&pia0_ddr_a,            sizeof(pia0_ddr_a),             1, handle);
-    if (retVal) retVal = fwrite(&pia0_ddr_b,            sizeof(pia0_ddr_b),             1, handle);
-    if (retVal) retVal = fwrite(&pia1_ddr_a,            sizeof(pia1_ddr_a),             1, handle);
-    if (retVal) retVal = fwrite(&pia1_ddr_b,            sizeof(pia1_ddr_b),             1, handle);
-    if (retVal) retVal = fwrite(&pia0_ddr_a_mask,       sizeof(pia0_ddr_a_mask),        1, handle);
-    if (retVal) retVal = fwrite(&pia0_ddr_b_mask,       sizeof(pia0_ddr_b_mask),        1, handle);
-    if (retVal) retVal = fwrite(&pia1_ddr_a_mask,       sizeof(pia1_ddr_a_mask),        1, handle);
-    if (retVal) retVal = fwrite(&pia1_ddr_b_mask,       sizeof(pia1_ddr_b_mask),        1, handle);
-    if (retVal) retVal = fwrite(&pia0_a_output_latch,   sizeof(pia0_a_output_latch),    1, handle);
-    if (retVal) retVal = fwrite(&pia0_b_output_latch,   sizeof(pia0_b_output_latch),    1, handle);
-    if (retVal) retVal = fwrite(&pia1_a_output_latch,   sizeof(pia1_a_output_latch),    1, handle);
-    if (retVal) retVal = fwrite(&pia1_b_output_latch,   sizeof(pia1_b_output_latch),    1, handle);
-    
-    // Write VDG vars
-    if (retVal) retVal = fwrite(&video_ram_offset,      sizeof(video_ram_offset),       1, handle);
-    if (retVal) retVal = fwrite(&sam_video_mode,        sizeof(sam_video_mode),         1, handle);
-    if (retVal) retVal = fwrite(&video_ram_offset,      sizeof(video_ram_offset),       1, handle);
-    if (retVal) retVal = fwrite(&sam_2x_rez,            sizeof(sam_2x_rez),             1, handle);
-    if (retVal) retVal = fwrite(&pia_video_mode,        sizeof(pia_video_mode),         1, handle);
-    if (retVal) retVal = fwrite(&current_mode,          sizeof(current_mode),           1, handle);
-    
-    // And some DracoDS handling memory
-    if (retVal) retVal = fwrite(&draco_line,              sizeof(draco_line),               1, handle);
-    if (retVal) retVal = fwrite(&draco_special_key,       sizeof(draco_special_key),        1, handle);
-    if (retVal) retVal = fwrite(&last_file_size,          sizeof(last_file_size),           1, handle);
-    if (retVal) retVal = fwrite(&tape_play_skip_frame,    sizeof(tape_play_skip_frame),     1, handle);
-    if (retVal) retVal = fwrite(&draco_scanline_counter,  sizeof(draco_scanline_counter),   1, handle);
-    if (retVal) retVal = fwrite(&joy_x,                   sizeof(joy_x),                    1, handle);
-    if (retVal) retVal = fwrite(&joy_x,                   sizeof(joy_x),                    1, handle);
-    if (retVal) retVal = fwrite(&emuFps,                  sizeof(emuFps),                   1, handle);
-    if (retVal) retVal = fwrite(&emuActFrames,            sizeof(emuActFrames),             1, handle);
-    if (retVal) retVal = fwrite(&timingFrames,            sizeof(timingFrames),             1, handle);
-    
-    // And some spare bytes we can eat into as needed without bumping the SAVE version
-    if (retVal) retVal = fwrite(spare,                    16,                               1, handle);    
-    
-    // -----------------------------------------------------------------------
-    // Compress the 64K RAM data using 'high' compression ratio... it's
-    // still quite fast for such small memory buffers and gets us under 32K
-    // -----------------------------------------------------------------------
-    int max_len = lzav_compress_bound_hi( 0x10000 );
-    int comp_len = lzav_compress_hi( memory_RAM, CompressBuffer, 0x10000, max_len );
-
-    if (retVal) retVal = fwrite(&comp_len,          sizeof(comp_len), 1, handle);
-    if (retVal) retVal = fwrite(&CompressBuffer,    comp_len,         1, handle);
+    u32 state_len = DracoStateSerialize(CompressBuffer, sizeof(CompressBuffer), 0);
+
+    if (state_len) retVal = fwrite(CompressBuffer, state_len, 1, handle);
+    fclose(handle);
 
     strcpy(tmpStr, (retVal ? "OK ":"ERR"));
     DSPrint(21,0,0,tmpStr);
@@ -154,143 +521,38 @@ void DracoSaveState()
       strcpy(tmpStr,"Error opening SAV file ...");
       DSPrint(2,0,0,tmpStr);
   }
-  fclose(handle);
 }
 
 
 /*********************************************************************************
- * Load the current state - read everything back from the .sav file.
+ * Load the current state - read the whole .sav file in one go and restore it.
  ********************************************************************************/
 void DracoLoadState()
 {
-  size_t retVal;
+  u8 retVal = 0;
 
-  // Return to the original path
-  chdir(initial_path);
+  MovieStop();    // A movie can't follow the machine to another point in time
 
   // Init filename = romname and SAV in place of ROM
-  DIR* dir = opendir("sav");
-  if (dir) closedir(dir);    // Directory exists... close it out and move on.
-  else mkdir("sav", 0777);   // Otherwise create the directory...
-  sprintf(szLoadFile,"sav/%s", initial_file);
-
-  int len = strlen(szLoadFile);
-  szLoadFile[len-3] = 's';
-  szLoadFile[len-2] = 'a';
-  szLoadFile[len-1] = 'v';
-  
-  memset(spare, 0x00, sizeof(spare));
+  DracoSavFilename(szLoadFile, "sav");
 
   FILE *handle = fopen(szLoadFile, "rb");
   if (handle != NULL)
   {
-     strcpy(tmpStr,"LOADING...");
-     DSPrint(12,0,0,tmpStr);
+    strcpy(tmpStr,"LOADING...");
+    DSPrint(12,0,0,tmpStr);
 
-    // Read Version
-    u16 save_ver = 0xBEEF;
-    retVal = fread(&save_ver, sizeof(u16), 1, handle);
+    u32 state_len = fread(CompressBuffer, 1, sizeof(CompressBuffer), handle);
+    fclose(handle);
 
-    if (save_ver == DRACO_SAVE_VER)
-    {
-        // Restore Last Directory Path / Tape File
-        if (retVal) retVal = fread(&last_path, sizeof(last_path), 1, handle);
-        if (retVal) retVal = fread(&last_file, sizeof(last_file), 1, handle);
-        
-        // ---------------------------------------------------------------
-        // If we saved a last path/file, we load it back up if possible....
-        // ---------------------------------------------------------------
-        if (strlen(last_path) > 1)
-        {
-            chdir(last_path);
-            
-            if (strlen(last_file) > 1)
-            {
-                ReadFileCarefully(last_file, TapeCartDiskBuffer, sizeof(TapeCartDiskBuffer), 0);
-            }
-        }
+    retVal = DracoStateDeserialize(CompressBuffer, state_len, STATE_FLAG_RELOAD_MEDIA | STATE_FLAG_VERIFY_CRC);
+    RewindReset();      // The rewind history is from a different timeline now
+
+    strcpy(tmpStr, (retVal ? "OK ":"ERR"));
+    DSPrint(21,0,0,tmpStr);
 
-        // Restore Motorola 6809 CPU
-        if (retVal) retVal = fread(&cpu, sizeof(cpu), 1, handle);
-
-        // Restore SAM registers
-        if (retVal) retVal = fread(&sam_registers, sizeof(sam_registers), 1, handle);
-        
-        // Restore DISK vars
-        if (retVal) retVal = fread(&nmi_enable, sizeof(nmi_enable), 1, handle);
-        if (retVal) retVal = fread(&halt_flag,  sizeof(halt_flag),  1, handle);
-        
-        // Restore FDC vars
-        if (retVal) retVal = fread(&FDC,                    sizeof(FDC),                1, handle);
-        if (retVal) retVal = fread(&Geom,                   sizeof(Geom),               1, handle);
-        if (retVal) retVal = fread(&io_show_status,         sizeof(io_show_status),     1, handle);
-        
-        Geom.disk0 = TapeCartDiskBuffer;    // Always... in case memory shifted
-        
-        // Restore PIA vars
-        if (retVal) retVal = fread(&pia0_ca1_int_enabled,  sizeof(pia0_ca1_int_enabled),   1, handle);
-        if (retVal) retVal = fread(&pia0_cb1_int_enabled,  sizeof(pia0_cb1_int_enabled),   1, handle);
-        if (retVal) retVal = fread(&pia1_cb1_int_enabled,  sizeof(pia1_cb1_int_enabled),   1, handle);
-        if (retVal) retVal = fread(&mux_select,            sizeof(mux_select),             1, handle);
-        if (retVal) retVal = fread(&dac_output,            sizeof(dac_output),             1, handle);
-        if (retVal) retVal = fread(&sound_enable,          sizeof(sound_enable),           1, handle);
-        if (retVal) retVal = fread(&cas_eof,               sizeof(cas_eof),                1, handle);
-        if (retVal) retVal = fread(&tape_pos,              sizeof(tape_pos),               1, handle);
-        if (retVal) retVal = fread(&tape_motor,            sizeof(tape_motor),             1, handle);
-        if (retVal) retVal = fread(keyboard_rows,          sizeof(keyboard_rows),          1, handle);    
-        if (retVal) retVal = fread(&pia0_ddr_a,            sizeof(pia0_ddr_a),             1, handle);
-        if (retVal) retVal = fread(&pia0_ddr_b,            sizeof(pia0_ddr_b),             1, handle);
-        if (retVal) retVal = fread(&pia1_ddr_a,            sizeof(pia1_ddr_a),             1, handle);
-        if (retVal) retVal = fread(&pia1_ddr_b,            sizeof(pia1_ddr_b),             1, handle);
-        if (retVal) retVal = fread(&pia0_ddr_a_mask,       sizeof(pia0_ddr_a_mask),        1, handle);
-        if (retVal) retVal = fread(&pia0_ddr_b_mask,       sizeof(pia0_ddr_b_mask),        1, handle);
-        if (retVal) retVal = fread(&pia1_ddr_a_mask,       sizeof(pia1_ddr_a_mask),        1, handle);
-        if (retVal) retVal = fread(&pia1_ddr_b_mask,       sizeof(pia1_ddr_b_mask),        1, handle);
-        if (retVal) retVal = fread(&pia0_a_output_latch,   sizeof(pia0_a_output_latch),    1, handle);
-        if (retVal) retVal = fread(&pia0_b_output_latch,   sizeof(pia0_b_output_latch),    1, handle);
-        if (retVal) retVal = fread(&pia1_a_output_latch,   sizeof(pia1_a_output_latch),    1, handle);
-        if (retVal) retVal = fread(&pia1_b_output_latch,   sizeof(pia1_b_output_latch),    1, handle);
-
-        // Restore VDG vars
-        if (retVal) retVal = fread(&video_ram_offset,      sizeof(video_ram_offset),       1, handle);
-        if (retVal) retVal = fread(&sam_video_mode,        sizeof(sam_video_mode),         1, handle);
-        if (retVal) retVal = fread(&video_ram_offset,      sizeof(video_ram_offset),       1, handle);
-        if (retVal) retVal = fread(&sam_2x_rez,            sizeof(sam_2x_rez),             1, handle);
-        if (retVal) retVal = fread(&pia_video_mode,        sizeof(pia_video_mode),         1, handle);
-        if (retVal) retVal = fread(&current_mode,          sizeof(current_mode),           1, handle);
-        
-        // Restore some DracoDS handling memory
-        if (retVal) retVal = fread(&draco_line,              sizeof(draco_line),               1, handle);
-        if (retVal) retVal = fread(&draco_special_key,       sizeof(draco_special_key),        1, handle);
-        if (retVal) retVal = fread(&last_file_size,          sizeof(last_file_size),           1, handle);
-        if (retVal) retVal = fread(&tape_play_skip_frame,    sizeof(tape_play_skip_frame),     1, handle);
-        if (retVal) retVal = fread(&draco_scanline_counter,  sizeof(draco_scanline_counter),   1, handle);
-        if (retVal) retVal = fread(&joy_x,                   sizeof(joy_x),                    1, handle);
-        if (retVal) retVal = fread(&joy_x,                   sizeof(joy_x),                    1, handle);
-        if (retVal) retVal = fread(&emuFps,                  sizeof(emuFps),                   1, handle);
-        if (retVal) retVal = fread(&emuActFrames,            sizeof(emuActFrames),             1, handle);
-        if (retVal) retVal = fread(&timingFrames,            sizeof(timingFrames),             1, handle);
-        
-        // And some spare bytes we can eat into as needed without bumping the SAVE version
-        if (retVal) retVal = fread(spare,                    16,                               1, handle);    
-
-        // Restore Main RAM memory
-        int comp_len = 0;
-        if (retVal) retVal = fread(&comp_len,          sizeof(comp_len), 1, handle);
-        if (retVal) retVal = fread(&CompressBuffer,    comp_len,         1, handle);
-
-        // ------------------------------------------------------------------
-        // Decompress the previously compressed RAM and put it back into the
-        // right memory location... this is quite fast all things considered.
-        // ------------------------------------------------------------------
-        (void)lzav_decompress( CompressBuffer, memory_RAM, comp_len, 0x10000 );
-        
-        strcpy(tmpStr, (retVal ? "OK ":"ERR"));
-        DSPrint(21,0,0,tmpStr);
-
-        WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;
-        DSPrint(12,0,0,"             ");
-      }
+    WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;
+    DSPrint(12,0,0,"             ");
   }
   else
   {
@@ -298,8 +560,320 @@ void DracoLoadState()
       WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;
       DSPrint(12,0,0,"             ");
   }
+}
 
-    fclose(handle);
+// ---------------------------------------------------------------------------------------
+// Quick-save slots. These are held in main RAM as raw (uncompressed RAM, no CRC) states
+// so both saving and loading are little more than a memcpy and fit easily in one frame.
+// Nothing is re-read from the SD card on a quick load - the tape/disk stays as it is.
+//
+// If enabled in the global options, a slot is also lazily written to the SD card a few
+// K at a time over the frames that follow so it can survive a power-off. That copy gets
+// the CRC the RAM copy goes without, and an empty slot filled back in from the SD card
+// the first time it's loaded must pass it.
+// ---------------------------------------------------------------------------------------
+static u8  *quick_slot[QUICK_SLOTS]     = {NULL};
+static u32  quick_slot_len[QUICK_SLOTS] = {0};
+u8          quick_slot_sel              = 0;        // Currently selected slot (0 based)
+
+static u8   quick_keys_last  = 0;       // Quick keys held last frame - we only act on a new press
+static u8   quick_keys       = 0;       // Quick keys held this frame
+static u8   quick_msg_frames = 0;       // Countdown to clear the status message
+
+static u8   quick_dirty      = 0;       // Bitmask of slots that need writing to the SD card
+static FILE *quick_fp        = NULL;    // SD card file being written (one at a time)
+static u8   quick_fp_slot    = 0;
+static u32  quick_fp_pos     = 0;
+
+static void quick_slot_filename(u8 slot)
+{
+    char ext[3] = {'q', 's', '1' + slot};
+    DracoSavFilename(szLoadFile, ext);
+}
+
+static void quick_message(const char *msg)
+{
+    sprintf(tmpStr, "%s %d", msg, quick_slot_sel+1);
+    DSPrint(12,0,0,tmpStr);
+    quick_msg_frames = 60;
+}
+
+// Forget all slots - they belong to the game that was running
+void DracoQuickReset(void)
+{
+    if (quick_fp) fclose(quick_fp);
+    quick_fp = NULL;
+    quick_dirty = 0;
+    quick_slot_sel = 0;
+    quick_keys = quick_keys_last = 0;
+    memset(quick_slot_len, 0x00, sizeof(quick_slot_len));
+}
+
+void DracoQuickSave(void)
+{
+    u8 slot = quick_slot_sel;
+
+    if (!quick_slot[slot]) quick_slot[slot] = malloc(QUICK_SLOT_SIZE);
+    if (!quick_slot[slot]) return;
+
+    quick_slot_len[slot] = DracoStateSerialize(quick_slot[slot], QUICK_SLOT_SIZE, STATE_FLAG_RAM_RAW | STATE_FLAG_NO_CRC);
+
+    if (quick_slot_len[slot])
+    {
+        if (myGlobalConfig.quickPersist) quick_dirty |= (1 << slot);
+        if (quick_fp && (quick_fp_slot == slot)) // Slot changed under us - start that write over
+        {
+            fclose(quick_fp);
+            quick_fp = NULL;
+        }
+        quick_message("QSAVE");
+    }
+    else quick_message("QERR ");
+}
+
+void DracoQuickLoad(void)
+{
+    u8 slot = quick_slot_sel;
+    u16 flags = 0;
+
+    MovieStop();    // A movie can't follow the machine to another point in time
+
+    // An empty slot might have been persisted to the SD card on a previous run
+    if (!quick_slot_len[slot] && myGlobalConfig.quickPersist && !(quick_fp && (quick_fp_slot == slot)))
+    {
+        if (!quick_slot[slot]) quick_slot[slot] = malloc(QUICK_SLOT_SIZE);
+        if (quick_slot[slot])
+        {
+            quick_slot_filename(slot);
+            FILE *handle = fopen(szLoadFile, "rb");
+            if (handle)
+            {
+                quick_slot_len[slot] = fread(quick_slot[slot], 1, QUICK_SLOT_SIZE, handle);
+                fclose(handle);
+                flags = STATE_FLAG_VERIFY_CRC;
+            }
+        }
+    }
+
+    if (quick_slot_len[slot] && DracoStateDeserialize(quick_slot[slot], quick_slot_len[slot], flags))
+    {
+        RewindReset();
+        quick_message("QLOAD");
+    }
+    else
+    {
+        quick_slot_len[slot] = 0;
+        quick_message("QNONE");
+    }
+}
+
+// Called by the key handler each frame for any of the quick keys being held
+void DracoQuickKey(u8 key)
+{
+    quick_keys |= key;
+}
+
+// ---------------------------------------------------------------------------------------
+// Called once per frame - handles a new press of the quick keys, clears the status
+// message and trickles any dirty slot out to the SD card QUICK_PERSIST_CHUNK at a time.
+// ---------------------------------------------------------------------------------------
+void DracoQuickFrame(void)
+{
+    u8 pressed = quick_keys & ~quick_keys_last;
+    quick_keys_last = quick_keys;
+    quick_keys = 0;
+
+    if (pressed & QUICK_KEY_SLOT)
+    {
+        quick_slot_sel = (quick_slot_sel + 1) % QUICK_SLOTS;
+        quick_message(quick_slot_len[quick_slot_sel] ? "QSLOT":"QFREE");
+    }
+    if (pressed & QUICK_KEY_SAVE) DracoQuickSave();
+    if (pressed & QUICK_KEY_LOAD) DracoQuickLoad();
+
+    if (quick_msg_frames)
+    {
+        if (--quick_msg_frames == 0) DSPrint(12,0,0,"          ");
+    }
+
+    if (!quick_fp && quick_dirty)
+    {
+        for (quick_fp_slot = 0; !(quick_dirty & (1 << quick_fp_slot)); quick_fp_slot++);
+
+        quick_slot_filename(quick_fp_slot);
+
+        quick_fp = fopen(szLoadFile, "wb");
+        quick_fp_pos = 0;
+        quick_dirty &= ~(1 << quick_fp_slot);
+
+        if (quick_fp)   // The SD card copy goes out with a CRC in place of the RAM copy's header
+        {
+            struct state_header_t header;
+            memcpy(&header, quick_slot[quick_fp_slot], sizeof(header));
+            header.flags &= ~STATE_FLAG_NO_CRC;
+            header.crc    = getCRC32(quick_slot[quick_fp_slot] + sizeof(header), header.length);
+            fwrite(&header, sizeof(header), 1, quick_fp);
+            quick_fp_pos = sizeof(header);
+        }
+    }
+    else if (quick_fp)
+    {
+        u32 len = quick_slot_len[quick_fp_slot] - quick_fp_pos;
+        if (len > QUICK_PERSIST_CHUNK) len = QUICK_PERSIST_CHUNK;
+
+        if (len) fwrite(quick_slot[quick_fp_slot] + quick_fp_pos, len, 1, quick_fp);
+        quick_fp_pos += len;
+
+        if (quick_fp_pos >= quick_slot_len[quick_fp_slot])
+        {
+            fclose(quick_fp);
+            quick_fp = NULL;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// Boot snapshots: the BASIC cold start (RAM test, clearing memory, Extended/Disk BASIC
+// initialization) takes a second or two and is always the same for a given set of ROMs.
+// The first time a ROM set reaches the OK prompt we capture the machine and write it to
+// the SD card - every reset after that simply restores it. The media (tape/disk/cart) is
+// never part of a boot snapshot so it can be used with any game.
+// ---------------------------------------------------------------------------------------
+static u8  *boot_snap      = NULL;  // The last snapshot used - saves going back to the SD card
+static u32  boot_snap_len  = 0;
+static u32  boot_snap_key  = 0;
+static u16  boot_frames    = 0;     // Frames since reset while we wait for the OK prompt (0 = not waiting)
+static u8   boot_ok_frames = 0;     // Frames the OK prompt has been showing
+
+// The BIOS checksums along with which ROMs are mapped for this machine and media
+static u32 boot_key(void)
+{
+    u8 key[6];
+
+    memcpy(key, &myGlobalConfig.bios_checksums, 4);
+    key[4] = myConfig.machine;
+    key[5] = (draco_mode >= MODE_DSK);
+
+    return CRC32_FINAL(crc32_update(CRC32_START, key, sizeof(key)));
+}
+
+static void boot_filename(u32 key)
+{
+    sprintf(szLoadFile, "/data/boot/%08lX.snp", key);
+}
+
+// Has BASIC printed OK and is waiting for input? Look for it at the start of a line on the text screen.
+u8 boot_at_ok_prompt(void)
+{
+    for (u16 addr = 0x400; addr < 0x600; addr += 32)
+    {
+        if ((memory_RAM[addr] == 0x4F) && (memory_RAM[addr+1] == 0x4B) && (memory_RAM[addr+2] == 0x60)) return 1;
+    }
+    return 0;
+}
+
+static void boot_cache(const u8 *buf, u32 len, u32 key)
+{
+    if (boot_snap) free(boot_snap);
+    boot_snap = malloc(len);
+    boot_snap_len = boot_snap ? len : 0;
+    boot_snap_key = key;
+    if (boot_snap) memcpy(boot_snap, buf, len);
+}
+
+// ---------------------------------------------------------------------------------------
+// Called right after the machine is reset. If we have a snapshot of this ROM set at the
+// OK prompt, jump straight to it. Otherwise start watching for the OK prompt so we can
+// capture one. Returns 1 if the machine was restored from a snapshot.
+// ---------------------------------------------------------------------------------------
+u8 DracoBootRestore(void)
+{
+    boot_frames = 0;
+    boot_ok_frames = 0;
+
+    if (!myGlobalConfig.bootSnap || (draco_mode == MODE_CART)) return 0;   // Carts auto-start - nothing to skip
+
+    u32 key = boot_key();
+
+    if (!boot_snap_len || (boot_snap_key != key))
+    {
+        u32 len = 0;
+        boot_filename(key);
+        FILE *handle = fopen(szLoadFile, "rb");
+        if (handle)
+        {
+            len = fread(CompressBuffer, 1, sizeof(CompressBuffer), handle);
+            fclose(handle);
+        }
+        if (len) boot_cache(CompressBuffer, len, key);
+        else boot_snap_len = 0;
+    }
+
+    if (boot_snap_len)
+    {
+        // The disk geometry comes from the media, not the snapshot
+        struct FDC_GEOMETRY_t geom_save = Geom;
+        u32 file_size_save = last_file_size;
+
+        if (DracoStateDeserialize(boot_snap, boot_snap_len, STATE_FLAG_VERIFY_CRC))
+        {
+            Geom = geom_save;
+            last_file_size = file_size_save;
+            return 1;
+        }
+
+        // A bad snapshot leaves the machine half restored - start over and capture a new one
+        boot_snap_len = 0;
+        Geom = geom_save;
+        last_file_size = file_size_save;
+        dragon_reset();
+    }
+
+    boot_frames = 1;
+    return 0;
+}
+
+// ---------------------------------------------------------------------------------------
+// Called once per frame - after a cold start, wait for BASIC to settle at the OK prompt
+// (with nothing typed and the tape idle) and capture the machine for next time.
+// ---------------------------------------------------------------------------------------
+void DracoBootFrame(void)
+{
+    if (!boot_frames) return;
+
+    // Give up if BASIC never gets there or if anything else starts happening
+    if ((++boot_frames > BOOT_MAX_FRAMES) || tape_motor || keysCurrent() || (BufferedKeysReadIdx != BufferedKeysWriteIdx))
+    {
+        boot_frames = 0;
+        return;
+    }
+
+    if (!boot_at_ok_prompt())
+    {
+        boot_ok_frames = 0;
+        return;
+    }
+
+    if (++boot_ok_frames < BOOT_SETTLE_FRAMES) return;
+    boot_frames = 0;
+
+    u32 len = DracoStateSerialize(CompressBuffer, sizeof(CompressBuffer), STATE_FLAG_NO_MEDIA);
+    if (!len) return;
+
+    u32 key = boot_key();
+    boot_cache(CompressBuffer, len, key);
+
+    DIR* dir = opendir("/data/boot");
+    if (dir) closedir(dir);             // Directory exists... close it out and move on.
+    else mkdir("/data/boot", 0777);     // Otherwise create the directory...
+
+    boot_filename(key);
+    FILE *handle = fopen(szLoadFile, "wb");
+    if (handle)
+    {
+        fwrite(CompressBuffer, len, 1, handle);
+        fclose(handle);
+    }
 }
 
 // End of file
@@ -0,0 +1,78 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#ifndef _SAVELOAD_H_
+#define _SAVELOAD_H_
+
+#include <nds.h>
+
+// ---------------------------------------------------------------------------------------
+// A machine state is a small header followed by a list of tagged chunks - one for each
+// subsystem. Every chunk carries its own version and length so a loader can skip chunks
+// it doesn't know and a chunk can grow new fields on the end without breaking old saves.
+// ---------------------------------------------------------------------------------------
+#define STATE_TAG(a,b,c,d)      ((u32)(a) | ((u32)(b) << 8) | ((u32)(c) << 16) | ((u32)(d) << 24))
+
+#define STATE_TAG_END           STATE_TAG('E','N','D',' ')
+
+#define STATE_FLAG_RAM_RAW      0x01    // Store the 64K of RAM uncompressed (fastest - for in-memory snapshots)
+#define STATE_FLAG_RAM_FAST     0x02    // Use the fast lzav compressor rather than the high-ratio one
+#define STATE_FLAG_RELOAD_MEDIA 0x04    // On restore, re-read the tape/disk/cart file named in the state
+#define STATE_FLAG_NO_CRC       0x08    // Skip the integrity CRC (in-memory snapshots that never leave RAM)
+#define STATE_FLAG_NO_MEDIA     0x10    // Leave out the tape/disk/cart file (boot snapshots work with any game)
+#define STATE_FLAG_VERIFY_CRC   0x20    // On restore, refuse a state saved without a CRC (anything read back from the SD card)
+
+#define STATE_BUFFER_SIZE       (128*1024)
+
+#define QUICK_SLOTS             4
+#define QUICK_SLOT_SIZE         (96*1024)   // A raw state is a bit over 64K
+#define QUICK_PERSIST_CHUNK     4096        // Bytes written to the SD card per frame when persisting a slot
+
+#define BOOT_MAX_FRAMES         600         // Stop waiting for the OK prompt after this many frames
+#define BOOT_SETTLE_FRAMES      5           // The OK prompt must be showing this many frames before capture
+
+#define QUICK_KEY_SAVE          0x01
+#define QUICK_KEY_LOAD          0x02
+#define QUICK_KEY_SLOT          0x04
+
+struct __attribute__((__packed__)) state_header_t
+{
+    u16 save_ver;       // DRACO_SAVE_VER - the container format
+    u16 flags;          // STATE_FLAG_xxx used to build this state
+    u32 length;         // Bytes of chunk data that follow this header
+    u32 crc;            // CRC32 of the chunk data
+};
+
+struct __attribute__((__packed__)) state_chunk_t
+{
+    u32 tag;            // STATE_TAG() four character code
+    u16 version;        // Version of this chunk's layout
+    u16 reserved;
+    u32 length;         // Bytes of data that follow (not including this chunk header)
+};
+
+extern u8 CompressBuffer[STATE_BUFFER_SIZE];
+
+extern u32 DracoStateSerialize(u8 *buf, u32 buf_size, u16 flags);
+extern u8  DracoStateDeserialize(const u8 *buf, u32 len, u16 flags);
+
+extern u8   DracoBootRestore(void);
+extern void DracoBootFrame(void);
+extern u8   boot_at_ok_prompt(void);
+
+extern u8   quick_slot_sel;
+extern void DracoQuickReset(void);
+extern void DracoQuickSave(void);
+extern void DracoQuickLoad(void);
+extern void DracoQuickKey(u8 key);
+extern void DracoQuickFrame(void);
+
+#endif // _SAVELOAD_H_
@@ -0,0 +1,113 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#include <nds.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "DracoDS.h"
+#include "DracoUtils.h"
+
+#include "stats.h"
+
+#if DRACO_STATS
+
+// ---------------------------------------------------------------------------------------
+// Which opcodes does a game actually lean on, which addressing modes do they use and
+// which IO registers get hammered? Every instruction executed bumps a counter for its
+// opcode (per page) and addressing mode, and every access to $FF00-$FFFF through the
+// IO callbacks bumps a read or write counter. The counts run from the last reset along
+// with the number of frames so the export can show both the totals and the per-frame
+// average. They are written as sav/<game>.csv with the snapshot keys (L+R+Y) which then
+// starts a fresh count.
+// ---------------------------------------------------------------------------------------
+u32 stats_op[STATS_PAGES][256];
+u32 stats_mode[STATS_MODES];
+u32 stats_io_read[256];
+u32 stats_io_write[256];
+
+static u32 stats_frames = 0;
+
+static const char *stats_mode_names[STATS_MODES] = {"-", "DIRECT", "INHERENT", "RELATIVE", "LRELATIVE", "INDEXED", "EXTENDED", "IMMEDIATE", "LIMMEDIATE", "PREFIX", "ILLEGAL"};
+static const char *stats_page_names[STATS_PAGES] = {"00", "10", "11"};
+
+void StatsReset(void)
+{
+    memset(stats_op,       0x00, sizeof(stats_op));
+    memset(stats_mode,     0x00, sizeof(stats_mode));
+    memset(stats_io_read,  0x00, sizeof(stats_io_read));
+    memset(stats_io_write, 0x00, sizeof(stats_io_write));
+    stats_frames = 0;
+}
+
+void StatsFrame(void)
+{
+    stats_frames++;
+}
+
+// The IO page is mirrored heavily - name the chip each address decodes to
+static const char *stats_io_name(u8 reg)
+{
+    if (reg < 0x20) return "PIA0";
+    if (reg < 0x40) return "PIA1";
+    if (reg < 0x60) return "DISK";
+    if (reg < 0xC0) return "CART";
+    if (reg < 0xE0) return "SAM";
+    return "VECTOR";
+}
+
+// Count and per-frame average (to two places) as the last columns of a row
+static void stats_put(FILE *fp, const char *kind, const char *page, u16 code, const char *name, u32 count)
+{
+    u32 avg = stats_frames ? (u32)(((u64)count * 100) / stats_frames) : 0;
+    fprintf(fp, "%s,%s,%02X,%s,%lu,%lu.%02lu\n", kind, page, code, name, count, avg / 100, avg % 100);
+}
+
+void StatsExport(void)
+{
+    char szFile[MAX_FILENAME_LEN+8];
+
+    DracoSavFilename(szFile, "csv");
+
+    FILE *fp = fopen(szFile, "w");
+    if (!fp) return;
+
+    fprintf(fp, "# %s FRAMES=%lu\n", initial_file, stats_frames);
+    fputs("kind,page,code,name,count,per_frame\n", fp);
+
+    for (u8 page=0; page<STATS_PAGES; page++)
+    {
+        for (u16 op=0; op<256; op++)
+        {
+            if (stats_op[page][op]) stats_put(fp, "OP", stats_page_names[page], op, "", stats_op[page][op]);
+        }
+    }
+
+    for (u8 mode=1; mode<STATS_MODES; mode++)
+    {
+        stats_put(fp, "MODE", "", mode, stats_mode_names[mode], stats_mode[mode]);
+    }
+
+    for (u16 reg=0; reg<256; reg++)
+    {
+        if (stats_io_read[reg])  stats_put(fp, "IO_RD", "FF", reg, stats_io_name(reg), stats_io_read[reg]);
+        if (stats_io_write[reg]) stats_put(fp, "IO_WR", "FF", reg, stats_io_name(reg), stats_io_write[reg]);
+    }
+
+    fclose(fp);
+
+    StatsReset();
+}
+
+#endif // DRACO_STATS
+
+// End of file
@@ -0,0 +1,58 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#ifndef _STATS_H_
+#define _STATS_H_
+
+#include <nds.h>
+
+// ---------------------------------------------------------------------------------------
+// Opcode and IO register counters. These sit right in the CPU and memory hot paths so
+// they are compiled out unless the build sets DRACO_STATS to 1 (e.g. -DDRACO_STATS=1 in
+// the Makefile CFLAGS). With it left at 0 the hooks below expand to nothing at all.
+// ---------------------------------------------------------------------------------------
+#ifndef DRACO_STATS
+#define DRACO_STATS             0
+#endif
+
+#define STATS_PAGES             3               // Page 0 plus the 0x10 and 0x11 prefixed pages
+#define STATS_MODES             11              // Addressing modes as numbered in mc6809e.h
+
+#if DRACO_STATS
+
+extern u32 stats_op[STATS_PAGES][256];
+extern u32 stats_mode[STATS_MODES];
+extern u32 stats_io_read[256];
+extern u32 stats_io_write[256];
+
+#define STATS_OP(page, op)      stats_op[(page)][(op)]++
+#define STATS_MODE(mode)        stats_mode[(mode)]++
+#define STATS_IO_READ(addr)     stats_io_read[(addr) & 0xFF]++
+#define STATS_IO_WRITE(addr)    stats_io_write[(addr) & 0xFF]++
+
+extern void StatsReset(void);
+extern void StatsFrame(void);
+extern void StatsExport(void);
+
+#else
+
+#define STATS_OP(page, op)
+#define STATS_MODE(mode)
+#define STATS_IO_READ(addr)
+#define STATS_IO_WRITE(addr)
+
+static inline void StatsReset(void)  {}
+static inline void StatsFrame(void)  {}
+static inline void StatsExport(void) {}
+
+#endif // DRACO_STATS
+
+#endif // _STATS_H_
@@ -0,0 +1,305 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#include <nds.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "DracoDS.h"
+#include "DracoUtils.h"
+#include "cpu.h"
+#include "mem.h"
+#include "printf.h"
+
+#include "trace.h"
+
+#if DRACO_TRACE
+
+// ---------------------------------------------------------------------------------------
+// When an optimization breaks a game we want the first instruction where it went wrong.
+// Every reset (and the start of every movie playback - the best way to get the same input
+// twice) traces the next TRACE_FRAMES frames to sav/<game>.dtr. When the trace is done it
+// is compared against sav/<game>.ref if there is one - copy a good build's .dtr there
+// (or convert another emulator's log to the same layout). The first record that doesn't
+// match is written to sav/<game>.dif along with the one before it.
+// ---------------------------------------------------------------------------------------
+u8  trace_active = 0;
+int trace_last_cycles = 0;                  // cycles_this_scanline at the previous record
+
+typedef struct
+{
+    u32 cycle;
+    u16 pc, x, y, u, s;
+    u8  a, b, cc, dp, op;
+    u8  zero;                               // Keeps the size even with no padding so memcmp() is safe
+} trace_state_t;
+
+static FILE *trace_fp = NULL;
+static u8   trace_buf[TRACE_IO_CHUNK];
+static u32  trace_buf_pos = 0;
+static u16  trace_frames_left = 0;
+static u8   trace_first = 0;
+static trace_state_t trace_prev;
+
+static void trace_message(const char *msg)
+{
+    DSPrint(12,0,0,msg);
+    WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;WAITVBL;
+    DSPrint(12,0,0,"             ");
+}
+
+static inline void trace_put16(u8 **p, u16 val)
+{
+    *(*p)++ = val & 0xFF;
+    *(*p)++ = val >> 8;
+}
+
+// ---------------------------------------------------------------------------------------
+// Called from cpu_run() just before each instruction is fetched.
+// ---------------------------------------------------------------------------------------
+void TraceRecord(void)
+{
+    trace_state_t cur;
+    u8 mask = 0;
+
+    int cycles = cycles_this_scanline - trace_last_cycles;
+    trace_last_cycles = cycles_this_scanline;
+
+    cur.pc = cpu.pc;  cur.op = mem_read_pc(cpu.pc);
+    cur.a  = cpu.a;   cur.b  = cpu.b;
+    cur.x  = cpu.x;   cur.y  = cpu.y;
+    cur.u  = cpu.u;   cur.s  = cpu.s;
+    cur.cc = cpu_get_cc();
+    cur.dp = cpu.dp;
+
+    s16 pc_delta = (s16)(cur.pc - trace_prev.pc);
+    if (trace_first || (pc_delta < -128) || (pc_delta > 127)) mask |= TRACE_PC_LONG;
+    if (trace_first || (cur.a != trace_prev.a)) mask |= TRACE_A;
+    if (trace_first || (cur.b != trace_prev.b)) mask |= TRACE_B;
+    if (trace_first || (cur.x != trace_prev.x)) mask |= TRACE_X;
+    if (trace_first || (cur.y != trace_prev.y)) mask |= TRACE_Y;
+    if (trace_first || (cur.u != trace_prev.u)) mask |= TRACE_U;
+    if (trace_first || (cur.s != trace_prev.s)) mask |= TRACE_S;
+    if (trace_first || (cur.cc != trace_prev.cc) || (cur.dp != trace_prev.dp)) mask |= TRACE_CC_DP;
+    trace_first = 0;
+
+    if (trace_buf_pos > (TRACE_IO_CHUNK - 32))
+    {
+        fwrite(trace_buf, trace_buf_pos, 1, trace_fp);
+        trace_buf_pos = 0;
+    }
+
+    u8 *p = &trace_buf[trace_buf_pos];
+    *p++ = mask;
+    *p++ = (cycles < 0) ? 0 : ((cycles > 255) ? 255 : cycles);
+    *p++ = cur.op;
+    if (mask & TRACE_PC_LONG) trace_put16(&p, cur.pc); else *p++ = (u8)pc_delta;
+    if (mask & TRACE_A) *p++ = cur.a;
+    if (mask & TRACE_B) *p++ = cur.b;
+    if (mask & TRACE_X) trace_put16(&p, cur.x);
+    if (mask & TRACE_Y) trace_put16(&p, cur.y);
+    if (mask & TRACE_U) trace_put16(&p, cur.u);
+    if (mask & TRACE_S) trace_put16(&p, cur.s);
+    if (mask & TRACE_CC_DP) {*p++ = cur.cc; *p++ = cur.dp;}
+    trace_buf_pos = p - trace_buf;
+
+    trace_prev = cur;
+}
+
+// ---------------------------------------------------------------------------------------
+// Reading a trace back - each reader keeps its own chunk of the file and running state.
+// ---------------------------------------------------------------------------------------
+typedef struct
+{
+    FILE *fp;
+    u8    buf[TRACE_IO_CHUNK];
+    u32   pos, len;
+    trace_state_t st;
+} trace_reader_t;
+
+static trace_reader_t trace_rd[2];
+
+static u8 trace_get(trace_reader_t *rd, u8 *dst, u8 len)
+{
+    for (u8 i=0; i<len; i++)
+    {
+        if (rd->pos == rd->len)
+        {
+            rd->len = fread(rd->buf, 1, TRACE_IO_CHUNK, rd->fp);
+            rd->pos = 0;
+            if (!rd->len) return 0;
+        }
+        dst[i] = rd->buf[rd->pos++];
+    }
+    return 1;
+}
+
+static u8 trace_get16(trace_reader_t *rd, u16 *val)
+{
+    u8 b[2];
+    if (!trace_get(rd, b, 2)) return 0;
+    *val = b[0] | (b[1] << 8);
+    return 1;
+}
+
+static u8 trace_next(trace_reader_t *rd)
+{
+    u8 hdr[3], pc8, ccdp[2];
+
+    if (!trace_get(rd, hdr, 3)) return 0;
+
+    u8 mask = hdr[0];
+    rd->st.cycle += hdr[1];
+    rd->st.op = hdr[2];
+
+    if (mask & TRACE_PC_LONG) {if (!trace_get16(rd, &rd->st.pc)) return 0;}
+    else {if (!trace_get(rd, &pc8, 1)) return 0; rd->st.pc += (s8)pc8;}
+
+    if ((mask & TRACE_A) && !trace_get(rd, &rd->st.a, 1)) return 0;
+    if ((mask & TRACE_B) && !trace_get(rd, &rd->st.b, 1)) return 0;
+    if ((mask & TRACE_X) && !trace_get16(rd, &rd->st.x)) return 0;
+    if ((mask & TRACE_Y) && !trace_get16(rd, &rd->st.y)) return 0;
+    if ((mask & TRACE_U) && !trace_get16(rd, &rd->st.u)) return 0;
+    if ((mask & TRACE_S) && !trace_get16(rd, &rd->st.s)) return 0;
+    if (mask & TRACE_CC_DP)
+    {
+        if (!trace_get(rd, ccdp, 2)) return 0;
+        rd->st.cc = ccdp[0];
+        rd->st.dp = ccdp[1];
+    }
+    return 1;
+}
+
+static u8 trace_open(trace_reader_t *rd, const char *ext)
+{
+    char szFile[MAX_FILENAME_LEN+8];
+    struct trace_header_t header;
+
+    memset(rd, 0x00, sizeof(*rd));
+    DracoSavFilename(szFile, ext);
+    rd->fp = fopen(szFile, "rb");
+    if (!rd->fp) return 0;
+
+    if ((fread(&header, sizeof(header), 1, rd->fp) != 1) || (header.magic != TRACE_MAGIC) || (header.version != TRACE_VERSION) ||
+        (header.machine != myConfig.machine) || (header.game_crc != file_crc))
+    {
+        fclose(rd->fp);
+        rd->fp = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+static void trace_print(FILE *fp, const char *name, u32 idx, const trace_state_t *st)
+{
+    fprintf(fp, "%s #%-9ld CYC=%-10ld PC=%04X OP=%02X A=%02X B=%02X X=%04X Y=%04X U=%04X S=%04X CC=%02X DP=%02X\n",
+            name, idx, st->cycle, st->pc, st->op, st->a, st->b, st->x, st->y, st->u, st->s, st->cc, st->dp);
+}
+
+// Walk both traces side by side and stop at the first record that isn't identical
+static void trace_compare(void)
+{
+    char szFile[MAX_FILENAME_LEN+8];
+    char szLine[32];
+    trace_state_t ref_prev, new_prev;
+    u32 idx = 0;
+
+    if (!trace_open(&trace_rd[0], "ref")) return;
+    if (!trace_open(&trace_rd[1], "dtr")) {fclose(trace_rd[0].fp); return;}
+
+    memset(&ref_prev, 0x00, sizeof(ref_prev));
+    memset(&new_prev, 0x00, sizeof(new_prev));
+
+    u8 more_ref, more_new, diff = 0;
+    while (1)
+    {
+        more_ref = trace_next(&trace_rd[0]);
+        more_new = trace_next(&trace_rd[1]);
+        if (!more_ref || !more_new) {diff = (more_ref != more_new); break;}
+        if (memcmp(&trace_rd[0].st, &trace_rd[1].st, sizeof(trace_state_t))) {diff = 1; break;}
+        ref_prev = trace_rd[0].st;
+        new_prev = trace_rd[1].st;
+        idx++;
+    }
+
+    fclose(trace_rd[0].fp);
+    fclose(trace_rd[1].fp);
+
+    DracoSavFilename(szFile, "dif");
+    FILE *fp = fopen(szFile, "w");
+    if (fp)
+    {
+        if (!diff) fprintf(fp, "SAME - %ld instructions\n", idx);
+        else
+        {
+            fprintf(fp, "FIRST DIFFERENCE AT INSTRUCTION %ld%s\n", idx, (more_ref && more_new) ? "" : " (one trace is shorter)");
+            if (idx)
+            {
+                trace_print(fp, "REF", idx-1, &ref_prev);
+                trace_print(fp, "NEW", idx-1, &new_prev);
+            }
+            if (more_ref) trace_print(fp, "REF", idx, &trace_rd[0].st);
+            if (more_new) trace_print(fp, "NEW", idx, &trace_rd[1].st);
+        }
+        fclose(fp);
+    }
+
+    if (diff) sprintf(szLine, "DIFF@%-8ld", idx);
+    else      sprintf(szLine, "TRACE SAME");
+    trace_message(szLine);
+}
+
+void TraceStop(void)
+{
+    if (!trace_active) return;
+
+    if (trace_buf_pos) fwrite(trace_buf, trace_buf_pos, 1, trace_fp);
+    fclose(trace_fp);
+    trace_fp = NULL;
+    trace_active = 0;
+
+    trace_compare();
+}
+
+void TraceStart(void)
+{
+    char szFile[MAX_FILENAME_LEN+8];
+    struct trace_header_t header;
+
+    TraceStop();
+
+    DracoSavFilename(szFile, "dtr");
+    trace_fp = fopen(szFile, "wb");
+    if (!trace_fp) return;
+
+    header.magic    = TRACE_MAGIC;
+    header.version  = TRACE_VERSION;
+    header.machine  = myConfig.machine;
+    header.reserved = 0;
+    header.game_crc = file_crc;
+    fwrite(&header, sizeof(header), 1, trace_fp);
+
+    trace_buf_pos     = 0;
+    trace_first       = 1;
+    trace_last_cycles = cycles_this_scanline;
+    trace_frames_left = TRACE_FRAMES;
+    trace_active      = 1;
+}
+
+void TraceFrame(void)
+{
+    if (trace_active && (--trace_frames_left == 0)) TraceStop();
+}
+
+#endif // DRACO_TRACE
+
+// End of file
@@ -0,0 +1,91 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <nds.h>
+
+// ---------------------------------------------------------------------------------------
+// Instruction trace. Like the opcode statistics, this hooks every instruction in cpu_run()
+// so it is compiled out unless the build sets DRACO_TRACE to 1 (-DDRACO_TRACE=1).
+//
+// A trace file is a header followed by one record per instruction, taken just before the
+// instruction executes. Each record holds only what changed since the one before:
+//
+//   mask     which of the fields below follow (TRACE_xxx bits)
+//   cycles   6809 cycles since the previous record (capped at 255)
+//   opcode   first byte of the instruction (a page prefix is recorded as 0x10 or 0x11)
+//   pc       signed 8-bit difference from the previous PC or, with TRACE_PC_LONG, the
+//            full 16-bit PC
+//   a, b     one byte each if flagged
+//   x,y,u,s  16-bit little endian each if flagged
+//   cc, dp   both bytes if either changed
+//
+// The first record always has every field. A trace from another emulator converted to
+// this layout can be compared just the same.
+// ---------------------------------------------------------------------------------------
+#ifndef DRACO_TRACE
+#define DRACO_TRACE             0
+#endif
+
+#define TRACE_MAGIC             0x43525444      // 'DTRC'
+#define TRACE_VERSION           1
+#define TRACE_FRAMES            60              // Frames traced after each reset or movie start
+#define TRACE_IO_CHUNK          (16*1024)       // Trace is written/read this many bytes at a time
+
+#define TRACE_PC_LONG           0x01
+#define TRACE_A                 0x02
+#define TRACE_B                 0x04
+#define TRACE_X                 0x08
+#define TRACE_Y                 0x10
+#define TRACE_U                 0x20
+#define TRACE_S                 0x40
+#define TRACE_CC_DP             0x80
+
+struct __attribute__((__packed__)) trace_header_t
+{
+    u32 magic;
+    u16 version;
+    u8  machine;        // myConfig.machine the trace was taken with
+    u8  reserved;
+    u32 game_crc;       // file_crc of the game
+};
+
+#if DRACO_TRACE
+
+extern u8  trace_active;
+extern int trace_last_cycles;
+
+extern void TraceRecord(void);
+
+#define TRACE_ACTIVE            trace_active
+// 'spill' writes cpu_run()'s working registers back to 'cpu' so TraceRecord() sees them
+#define TRACE_OP(spill)         if (trace_active) {spill; TraceRecord();}
+#define TRACE_LINE(cycles)      trace_last_cycles -= (cycles)
+
+extern void TraceStart(void);
+extern void TraceStop(void);
+extern void TraceFrame(void);
+
+#else
+
+#define TRACE_ACTIVE            0
+#define TRACE_OP(spill)
+#define TRACE_LINE(cycles)
+
+static inline void TraceStart(void) {}
+static inline void TraceStop(void)  {}
+static inline void TraceFrame(void) {}
+
+#endif // DRACO_TRACE
+
+#endif // _TRACE_H_
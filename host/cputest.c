@@ -0,0 +1,291 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#include <nds.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpu.h"
+#include "mem.h"
+#include "sam.h"
+
+#ifndef CPUTEST_NO_SELFCHECK
+#include "cpucheck.h"
+#endif
+
+// ---------------------------------------------------------------------------------------
+// Host test suite for the 6809 core. Every op-code on all three pages is run one
+// instruction at a time from a set of random machine states (all 64K of memory, every
+// register and every CC bit), and the registers, flags, state, cycles taken and every
+// byte of memory that changed are folded into one CRC per test. Op-codes that take an
+// indexed post-byte get one test per indexed mode, each covering all four index
+// registers with and without indirection.
+//
+// The results are checked against cputest.expect, which was written by the core before
+// the flag table, indexed table and op-code fusion changes - so any difference in what
+// an instruction does, down to a single cycle or flag, shows up here by op-code and mode.
+// 'make diff REF=<rev>' runs the same tests against the core from any other revision.
+//
+// The on-DS self-check (cpucheck.c) is run here too.
+// ---------------------------------------------------------------------------------------
+#define CPUTEST_TRIALS          3           // Random starting states per op-code / post-byte
+#define CPUTEST_MAX_LINE        64
+
+typedef struct
+{
+    u8          class;                      // Low nibble of the post-byte, or 0x10 for a 5-bit offset
+    const char *name;
+} cputest_index_t;
+
+static const cputest_index_t cputest_index[] =
+{
+    {0x10, "n5,R"},
+    {0x00, ",R+"},      {0x01, ",R++"},     {0x02, ",-R"},      {0x03, ",--R"},
+    {0x04, ",R"},       {0x05, "B,R"},      {0x06, "A,R"},      {0x07, "ILL7"},
+    {0x08, "n8,R"},     {0x09, "n16,R"},    {0x0A, "ILLA"},     {0x0B, "D,R"},
+    {0x0C, "n8,PCR"},   {0x0D, "n16,PCR"},  {0x0E, "ILLE"},     {0x0F, "[n16]"},
+};
+
+#define CPUTEST_INDEX_MODES     (sizeof(cputest_index) / sizeof(cputest_index[0]))
+
+static const u8 cputest_offsets5[] = {0x00, 0x01, 0x0F, 0x10, 0x1F};
+
+static u8  cputest_before[0x10000];
+static u32 cputest_rand_state;
+static u32 cputest_tests  = 0;
+static u32 cputest_failed = 0;
+
+static u32 cputest_rand(void)
+{
+    cputest_rand_state ^= cputest_rand_state << 13;
+    cputest_rand_state ^= cputest_rand_state >> 17;
+    cputest_rand_state ^= cputest_rand_state << 5;
+    return cputest_rand_state;
+}
+
+static u32 cputest_fold(u32 crc, u32 value)
+{
+    crc ^= value;
+    for (u8 i=0; i<32; i++) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    return crc;
+}
+
+// Where the op-code sits in the 6809 map - used to label the results, and undefined
+// op-codes (no cycles in the core's tables) get a single test rather than a mode sweep
+static const char *cputest_mode(u8 page, u8 op)
+{
+    if (!page && ((op == 0x10) || (op == 0x11))) return "PAGE";
+    if (!cpu_op_cycles(page, op)) return "ILL";
+
+    switch (op >> 4)
+    {
+        case 0x0: return "DIR";
+        case 0x1: return ((op == 0x16) || (op == 0x17)) ? "REL16" : (((op >= 0x1A) && (op != 0x1D)) ? "IMM" : "INH");
+        case 0x2: return page ? "REL16" : "REL";
+        case 0x3: return (op <= 0x33) ? "IDX" : (((op <= 0x37) || (op == 0x3C)) ? "IMM" : "INH");
+        case 0x4:
+        case 0x5: return "INH";
+        case 0x6: return "IDX";
+        case 0x7: return "EXT";
+        case 0x8: return (op == 0x8D) ? "REL" : "IMM";
+        case 0xC: return "IMM";
+        case 0x9:
+        case 0xD: return "DIR";
+        case 0xA:
+        case 0xE: return "IDX";
+        default:  return "EXT";
+    }
+}
+
+// Run the instruction at a random PC from a random machine state and fold the outcome into 'crc'
+static u32 cputest_trial(u32 crc, u8 page, u8 op, int post, u32 seed)
+{
+    cputest_rand_state = seed | 1;
+
+    for (u32 i=0; i<0x10000; i+=4)
+    {
+        u32 fill = cputest_rand();
+        memcpy(&memory_RAM[i], &fill, sizeof(fill));
+    }
+
+    u16 pc = 0x0100 + (cputest_rand() % 0xFD00);
+    u16 at = pc;
+    if (page) memory_RAM[at++] = page;
+    memory_RAM[at++] = op;
+    if (post >= 0) memory_RAM[at] = post;
+
+    cpu.a  = cputest_rand();    cpu.b  = cputest_rand();
+    cpu.x  = cputest_rand();    cpu.y  = cputest_rand();
+    cpu.u  = cputest_rand();    cpu.s  = cputest_rand();
+    cpu.dp = cputest_rand();
+    cpu.pc = pc;
+    cpu_set_cc(cputest_rand());
+
+    cpu.cpu_state     = CPU_EXEC;
+    cpu.nmi_armed     = 1;
+    cpu.nmi_latched   = 0;
+    cpu.irq_asserted  = 0;
+    cpu.firq_asserted = 0;
+    cpu.halt_asserted = 0;
+    cpu.reset_asserted = 0;
+
+    memcpy(cputest_before, memory_RAM, sizeof(cputest_before));
+
+    cycles_this_scanline = CPU_CYCLES_PER_LINE - 1;
+    cpu_run();
+
+    crc = cputest_fold(crc, (cpu.a << 24) | (cpu.b << 16) | (cpu.dp << 8) | cpu_get_cc());
+    crc = cputest_fold(crc, (cpu.x << 16) | cpu.y);
+    crc = cputest_fold(crc, (cpu.u << 16) | cpu.s);
+    crc = cputest_fold(crc, (cpu.pc << 16) | (cpu.cpu_state << 8) | (u8)(cycles_this_scanline + 1));
+
+    for (u32 block=0; block<0x10000; block+=64)
+    {
+        if (!memcmp(&memory_RAM[block], &cputest_before[block], 64)) continue;
+        for (u32 i=block; i<block+64; i++)
+        {
+            if (memory_RAM[i] != cputest_before[i]) crc = cputest_fold(crc, (i << 8) | memory_RAM[i]);
+        }
+    }
+
+    return crc;
+}
+
+static u32 cputest_seed(u8 page, u8 op, int post, u8 trial)
+{
+    return (page << 24) ^ (op << 16) ^ ((post & 0x1FF) << 4) ^ trial ^ 0x6809;
+}
+
+// Check one result against the expected list (or just print it when writing a new list)
+static void cputest_result(FILE *expect, const char *label, u32 crc)
+{
+    char line[CPUTEST_MAX_LINE];
+    char want[CPUTEST_MAX_LINE];
+
+    snprintf(line, sizeof(line), "%-20s %08X", label, crc);
+    cputest_tests++;
+
+    if (!expect)
+    {
+        printf("%s\n", line);
+        return;
+    }
+
+    do
+    {
+        if (!fgets(want, sizeof(want), expect)) want[0] = 0;
+    } while (want[0] == '#');
+
+    want[strcspn(want, "\r\n")] = 0;
+    if (strcmp(line, want))
+    {
+        printf("FAIL %-20s got %08X  expected %s\n", label, crc, want[0] ? want + 21 : "(nothing)");
+        cputest_failed++;
+    }
+}
+
+static void cputest_opcode(FILE *expect, u8 page, u8 op)
+{
+    char label[CPUTEST_MAX_LINE];
+    const char *mode = cputest_mode(page, op);
+
+    if (strcmp(mode, "IDX"))
+    {
+        u32 crc = 0xFFFFFFFF;
+        for (u8 t=0; t<CPUTEST_TRIALS; t++) crc = cputest_trial(crc, page, op, -1, cputest_seed(page, op, -1, t));
+        snprintf(label, sizeof(label), "%02X %02X %s", page, op, mode);
+        cputest_result(expect, label, ~crc);
+        return;
+    }
+
+    for (u8 m=0; m<CPUTEST_INDEX_MODES; m++)
+    {
+        u32 crc = 0xFFFFFFFF;
+        for (u8 reg=0; reg<4; reg++)
+        {
+            if (cputest_index[m].class & 0x10)
+            {
+                for (u8 o=0; o<sizeof(cputest_offsets5); o++)
+                {
+                    u8 post = (reg << 5) | cputest_offsets5[o];
+                    for (u8 t=0; t<CPUTEST_TRIALS; t++) crc = cputest_trial(crc, page, op, post, cputest_seed(page, op, post, t));
+                }
+            }
+            else
+            {
+                for (u8 ind=0; ind<2; ind++)
+                {
+                    u8 post = 0x80 | (reg << 5) | (ind << 4) | cputest_index[m].class;
+                    for (u8 t=0; t<CPUTEST_TRIALS; t++) crc = cputest_trial(crc, page, op, post, cputest_seed(page, op, post, t));
+                }
+            }
+        }
+        snprintf(label, sizeof(label), "%02X %02X IDX %s", page, op, cputest_index[m].name);
+        cputest_result(expect, label, ~crc);
+    }
+}
+
+#ifndef CPUTEST_NO_SELFCHECK
+static u8 cputest_selfcheck(void)
+{
+    cpu_selfcheck();
+
+    printf("self-check: %d/%d passed, %d known deviation(s), %d table error(s), %ld KIPS (%ld%%)\n",
+           cpucheck_ops_passed, cpucheck_ops_total, cpucheck_deviations, cpucheck_table_errors,
+           (long)cpucheck_kips, (long)cpucheck_speed);
+    if (cpucheck_first_fail != 0xFF) printf("self-check: first failure is test %d\n", cpucheck_first_fail);
+
+    return (cpucheck_ops_passed == cpucheck_ops_total) && !cpucheck_table_errors;
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    FILE *expect = NULL;
+    u8 ok = 1;
+
+    if ((argc > 1) && strcmp(argv[1], "-w"))
+    {
+        expect = fopen(argv[1], "r");
+        if (!expect)
+        {
+            printf("cputest: can't open %s\n", argv[1]);
+            return 2;
+        }
+    }
+
+#ifndef CPUTEST_NO_SELFCHECK
+    if (expect) ok = cputest_selfcheck();
+#endif
+
+    mem_init();
+    cpu_init(0);
+    sam_registers.mpu_rate = 0;
+    sam_registers.memory_map_type = 0;     // All RAM
+
+    if (!expect) printf("# page op mode          crc - written by 'make expect'\n");
+
+    for (u16 op=0; op<256; op++) cputest_opcode(expect, 0x00, op);
+    for (u16 op=0; op<256; op++) cputest_opcode(expect, 0x10, op);
+    for (u16 op=0; op<256; op++) cputest_opcode(expect, 0x11, op);
+
+    if (expect)
+    {
+        fclose(expect);
+        printf("cputest: %ld/%ld op-code tests passed\n", (long)(cputest_tests - cputest_failed), (long)cputest_tests);
+        if (cputest_failed) ok = 0;
+    }
+
+    return ok ? 0 : 1;
+}
+
+// End of file
@@ -0,0 +1,71 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#include <nds.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "cpu.h"
+#include "mem.h"
+#include "sam.h"
+
+// ---------------------------------------------------------------------------------------
+// Fuzz target: an arbitrary instruction stream into cpu_run(). The input is laid over
+// all of RAM below the IO page (and the upper 32K of ROM) so wherever execution wanders
+// it runs fuzzer bytes. The first bytes double as the starting registers, and each
+// scanline takes its interrupt lines from the input too.
+// ---------------------------------------------------------------------------------------
+#define FUZZ_CPU_LINES      512             // A couple of frames worth of scanlines per input
+#define FUZZ_CPU_REGS       12
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size < FUZZ_CPU_REGS) return 0;
+
+    mem_init();
+    for (u32 i=0; i<0xFF00; i++) memory_RAM[i] = data[i % size];
+    for (u32 i=0x8000; i<0xFF00; i++) memory_ROM[i] = data[(i * 7) % size];
+    memcpy(&memory_RAM[0xFFF0], data, FUZZ_CPU_REGS);   // Vectors (read through the IO page)
+
+    sam_registers.mpu_rate        = data[0] & 0x01;
+    sam_registers.memory_map_type = (data[0] & 0x02) ? 0x8000 : 0x0000;
+
+    cpu_init(0);
+    cpu.a  = data[1];
+    cpu.b  = data[2];
+    cpu.dp = data[3];
+    cpu.x  = (data[4] << 8) | data[5];
+    cpu.y  = (data[6] << 8) | data[7];
+    cpu.u  = (data[8] << 8) | data[9];
+    cpu.s  = (data[10] << 8) | data[11];
+    cpu.pc = (data[11] << 8) | data[4];
+    cpu_set_cc(data[0] & 0xF0);
+    cpu.cpu_state = CPU_EXEC;
+    cpu.nmi_armed = 1;
+    cycles_this_scanline = 0;
+
+    for (u32 line=0; line<FUZZ_CPU_LINES; line++)
+    {
+        u8 lines = data[(line + FUZZ_CPU_REGS) % size];
+
+        cpu_irq((lines & 0x01) ? INT_IRQ : 0);
+        cpu_firq((lines & 0x02) ? INT_FIRQ : 0);
+        if ((lines & 0x1C) == 0x1C) cpu_nmi_trigger();
+
+        cpu_run();
+
+        if (cpu.cpu_state == CPU_EXCEPTION) break;  // Undefined op-code - the DS stops here too
+    }
+
+    return 0;
+}
+
+// End of file
@@ -0,0 +1,134 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#include <nds.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "DracoDS.h"
+#include "DracoUtils.h"
+#include "cpu.h"
+#include "mem.h"
+#include "disk.h"
+#include "fdc.h"
+
+// ---------------------------------------------------------------------------------------
+// Fuzz target: FDC register sequences against a random disk image. The first bytes pick
+// the controller, the geometry and the timing model, and the disk images are allocated
+// at exactly the size that geometry needs (so a read or write-back off the end of the
+// image is caught) and filled from a generator seeded by the input. The rest of the
+// input is a list of two byte operations - the guest's register reads and writes through
+// the disk IO page, drive/side changes, scanlines of rotation and data register drains.
+// ---------------------------------------------------------------------------------------
+#define FUZZ_FDC_HEADER     8
+#define FUZZ_FDC_MAX_OPS    4096
+#define FUZZ_FDC_DRAIN      (2 * FDC_RAW_TRACK_LEN)     // Longest data transfer a command can run to
+
+static u32 fuzz_fdc_rand_state;
+
+static u32 fuzz_fdc_rand(void)
+{
+    fuzz_fdc_rand_state ^= fuzz_fdc_rand_state << 13;
+    fuzz_fdc_rand_state ^= fuzz_fdc_rand_state >> 17;
+    fuzz_fdc_rand_state ^= fuzz_fdc_rand_state << 5;
+    return fuzz_fdc_rand_state;
+}
+
+static u8 *fuzz_fdc_image(u32 size)
+{
+    u8 *image = malloc(size);
+    if (image) for (u32 i=0; i<size; i++) image[i] = fuzz_fdc_rand();
+    return image;
+}
+
+// One scanline of the disk as dragon.c runs it - the CPU has used up the line
+static void fuzz_fdc_line(void)
+{
+    cycles_this_scanline = CPU_CYCLES_PER_LINE;
+    fdc_tick();
+    cycles_this_scanline = 0;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size < FUZZ_FDC_HEADER) return 0;
+
+    // Same limits fdc_init() puts on the geometry so the images match what it will use
+    u8  fdc_type    = (data[0] & 0x01) ? WD2793 : WD1770;
+    u8  drives      = 1 + ((data[0] >> 1) & 0x01);
+    u8  sides       = 1 + ((data[0] >> 2) & 0x01);
+    u8  tracks      = 1 + (data[1] % FDC_MAX_TRACK);
+    u8  sectors     = 1 + (data[2] & 0x1F);
+    u16 sectorSize  = 128 << (data[3] & 0x03);
+    u8  startSector = (data[3] >> 2) & 0x01;
+
+    if ((sectors * sectorSize) > sizeof(FDC.track_buffer)) sectors = sizeof(FDC.track_buffer) / sectorSize;
+
+    u32 image_size = sides * tracks * sectors * sectorSize;
+
+    fuzz_fdc_rand_state = (((u32)data[4] << 24) | (data[5] << 16) | (data[6] << 8) | data[7]) | 1;
+    u8 *disk0 = fuzz_fdc_image(image_size);
+    u8 *disk1 = (drives > 1) ? fuzz_fdc_image(image_size) : NULL;
+    if (!disk0 || ((drives > 1) && !disk1))
+    {
+        free(disk0); free(disk1);
+        return 0;
+    }
+
+    mem_init();
+    cpu_init(0);
+    cycles_this_scanline = 0;
+
+    draco_mode = MODE_DSK;
+    myConfig.diskTiming = (data[0] & 0x08) ? FDC_TIMING_ACCURATE : FDC_TIMING_INSTANT;
+    disk_init();                                        // Maps the disk IO page
+    fdc_init(fdc_type, drives, sides, tracks, sectors, sectorSize, startSector, disk0, disk1);
+
+    u32 ops = 0;
+    for (size_t pos=FUZZ_FDC_HEADER; ((pos + 1) < size) && (ops < FUZZ_FDC_MAX_OPS); pos += 2, ops++)
+    {
+        u8 op  = data[pos];
+        u8 arg = data[pos+1];
+        u8 reg = (op >> 3) & 0x03;
+
+        switch (op & 0x07)
+        {
+            case 0: mem_write(0xFF48 + reg, arg);   break;  // Command, track, sector or data register
+            case 1: (void)mem_read(0xFF48 + reg);   break;  // Status, track, sector or data register
+            case 2: mem_write(0xFF40, arg);         break;  // Drive control (motor, density/NMI enable)
+            case 3:
+                fdc_setDrive(arg & 0x01);                   // The controller allows for two drives and sides...
+                fdc_setSide((arg >> 1) & 0x01);             // ...even though the CoCo interface only uses one
+                break;
+            case 4:
+                for (u16 line=0; line<=(arg * 8); line++) fuzz_fdc_line();
+                break;
+            case 5:
+                // Move bytes through the data register for as long as the FDC wants them
+                for (u16 n=0; (n < FUZZ_FDC_DRAIN) && (fdc_read(0) & 0x02); n++)
+                {
+                    if (op & 0x08) mem_write(0xFF4B, arg + n);
+                    else (void)mem_read(0xFF4B);
+                    if (op & 0x10) fuzz_fdc_line();
+                }
+                break;
+            case 6: fdc_reset(arg & 0x01);          break;
+            case 7: fdc_timing = arg & 0x01;        break;
+        }
+    }
+
+    free(disk0);
+    free(disk1);
+
+    return 0;
+}
+
+// End of file
@@ -0,0 +1,122 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// ---------------------------------------------------------------------------------------
+// A stand-in for libFuzzer's main() so the fuzz targets also build with a compiler that
+// doesn't have it ('make fuzz-smoke'). Given files it runs each one once - handy for
+// replaying a crash or slow input that libFuzzer saved. Given '-runs=N' it runs N random
+// inputs of random length instead, and an input that trips a sanitizer is written to
+// 'crash-input' so it can be replayed the same way. There is no coverage feedback here, so this only
+// shakes out the shallow problems; use 'make fuzz' with clang for the real thing.
+// ---------------------------------------------------------------------------------------
+#define FUZZ_MAIN_MAX_INPUT     (256 * 1024)
+#define FUZZ_MAIN_SLOW_MS       1000
+
+extern int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static uint8_t  fuzz_input[FUZZ_MAIN_MAX_INPUT];
+static size_t   fuzz_input_size = 0;
+static uint32_t fuzz_rand_state = 0x6809;
+
+static uint32_t fuzz_rand(void)
+{
+    fuzz_rand_state ^= fuzz_rand_state << 13;
+    fuzz_rand_state ^= fuzz_rand_state >> 17;
+    fuzz_rand_state ^= fuzz_rand_state << 5;
+    return fuzz_rand_state;
+}
+
+// The sanitizers abort() when they find something (see below) and we save the input on the way out
+static void fuzz_save_crash(int sig)
+{
+    int fd = open("crash-input", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0)
+    {
+        if (write(fd, fuzz_input, fuzz_input_size) < 0) {}
+        close(fd);
+    }
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+const char *__asan_default_options(void)  { return "abort_on_error=1"; }
+const char *__ubsan_default_options(void) { return "abort_on_error=1:print_stacktrace=1"; }
+
+static int fuzz_one(const char *name, size_t size)
+{
+    fuzz_input_size = size;
+
+    uint8_t *data = malloc(size ? size : 1);     // Exactly the input's size, as libFuzzer hands it over
+    memcpy(data, fuzz_input, size);
+
+    clock_t start = clock();
+    LLVMFuzzerTestOneInput(data, size);
+    free(data);
+
+    long ms = (long)((clock() - start) * 1000 / CLOCKS_PER_SEC);
+    if (ms > FUZZ_MAIN_SLOW_MS)
+    {
+        printf("fuzz: slow input %s (%ld bytes, %ld ms)\n", name, (long)size, ms);
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int slow = 0;
+
+    if ((argc > 1) && !strncmp(argv[1], "-runs=", 6))
+    {
+        long runs = atol(argv[1] + 6);
+        char name[32];
+
+        signal(SIGABRT, fuzz_save_crash);
+
+        for (long run=0; run<runs; run++)
+        {
+            // Mostly short inputs with the odd long one - the length is a power of two scaled at random
+            size_t size = (fuzz_rand() % (1 << (fuzz_rand() % 18))) + 1;
+            for (size_t i=0; i<size; i++) fuzz_input[i] = fuzz_rand();
+            snprintf(name, sizeof(name), "#%ld", run);
+            slow += fuzz_one(name, size);
+        }
+        printf("fuzz: %s ran %ld random inputs\n", argv[0], runs);
+        return slow ? 1 : 0;
+    }
+
+    for (int i=1; i<argc; i++)
+    {
+        FILE *fp = fopen(argv[i], "rb");
+        if (!fp)
+        {
+            printf("fuzz: can't open %s\n", argv[i]);
+            return 2;
+        }
+        size_t size = fread(fuzz_input, 1, sizeof(fuzz_input), fp);
+        fclose(fp);
+        slow += fuzz_one(argv[i], size);
+    }
+
+    return slow ? 1 : 0;
+}
+
+// End of file
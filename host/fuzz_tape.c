@@ -0,0 +1,74 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#include <nds.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "DracoDS.h"
+#include "DracoUtils.h"
+#include "cpu.h"
+#include "mem.h"
+#include "pia.h"
+#include "disk.h"
+#include "loadm.h"
+
+#ifdef __SANITIZE_ADDRESS__
+#include <sanitizer/asan_interface.h>
+#define FUZZ_TAPE_POISON(addr, size)    ASAN_POISON_MEMORY_REGION(addr, size)
+#define FUZZ_TAPE_UNPOISON(addr, size)  ASAN_UNPOISON_MEMORY_REGION(addr, size)
+#else
+#define FUZZ_TAPE_POISON(addr, size)
+#define FUZZ_TAPE_UNPOISON(addr, size)
+#endif
+
+// ---------------------------------------------------------------------------------------
+// Fuzz target: raw .CAS / .DSK bytes through everything that parses a loaded image - the
+// LOADM tape and disk parsers, the disk directory peek and the tape bit-faker behind
+// PIA1-PA0. The image is loaded into TapeCartDiskBuffer as the front end does and the
+// rest of the buffer is poisoned, so reading past the end of the file is caught even
+// though it stays inside the (256K) buffer on the DS.
+// ---------------------------------------------------------------------------------------
+#define FUZZ_TAPE_PIA1_PA           0xFF20                  // Cassette input bit is PA0
+#define FUZZ_TAPE_READS_PER_BYTE    (9 * 20)                // Nine bits a byte at the longest bit time (BIT_THRESHOLD_LO)
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size > MAX_FILE_SIZE) return 0;
+
+    memcpy(TapeCartDiskBuffer, data, size);
+    last_file_size = size;
+    file_size      = size;
+    FUZZ_TAPE_POISON(TapeCartDiskBuffer + size, MAX_FILE_SIZE - size);
+
+    mem_init();
+    cpu_init(0);
+    cpu.s = 0x7F00;
+    cpu_set_cc(0);
+
+    (void)LoadmFromTape();
+    (void)LoadmFromDisk(NULL);
+    (void)LoadmFromDisk("FUZZ.BIN");
+    (void)disk_get_filename();
+
+    // And the same bytes as a tape played into the cassette input bit until it runs out
+    pia_init();
+    for (u32 reads=0; !cas_eof && (reads < ((size + 1) * FUZZ_TAPE_READS_PER_BYTE)); reads++)
+    {
+        (void)mem_read(FUZZ_TAPE_PIA1_PA);
+    }
+
+    FUZZ_TAPE_UNPOISON(TapeCartDiskBuffer + size, MAX_FILE_SIZE - size);
+
+    return 0;
+}
+
+// End of file
@@ -0,0 +1,88 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#include <nds.h>
+#include <stdio.h>
+
+#include "DracoDS.h"
+#include "DracoUtils.h"
+#include "sam.h"
+#include "vdg.h"
+#include "saveload.h"
+
+// ---------------------------------------------------------------------------------------
+// The globals and calls the core modules pick up from the front end (DracoDS.c and
+// DracoUtils.c) on the DS. The host builds only link the modules under test, so these
+// stand in for the rest of the program.
+// ---------------------------------------------------------------------------------------
+vu16 host_timer_data[4] = {0};
+vu16 host_timer_cr[4]   = {0};
+
+u32  debug[0x10]        = {0};
+u8   clear_firq_immediate = 0;
+u8   draco_mode         = 0;
+u32  file_size          = 0;
+u32  last_file_size     = 0;
+char initial_file[MAX_FILENAME_LEN] = "";
+char initial_path[MAX_FILENAME_LEN] = "";
+
+u8   TapeCartDiskBuffer[MAX_FILE_SIZE];
+u8   CompressBuffer[STATE_BUFFER_SIZE];
+
+u16  JoyState           = 0;
+u16  joy_x              = 0;
+u16  joy_y              = 0;
+u8   kbd_keys_pressed   = 0;
+u8   kbd_keys[12];
+u8   paste_active       = 0;
+
+s16  beeper_vol         = 0;
+s16  samples_since_last_call[MAX_SOUNDS_PER_SCANLINE];
+u8   samples_since_idx  = 0;
+
+struct Config_t       myConfig;
+struct GlobalConfig_t myGlobalConfig;
+
+struct sam_reg_t sam_registers;
+
+void DSPrint(int iX, int iY, int iScr, const char *szMessage)
+{
+    (void)iX; (void)iY; (void)iScr; (void)szMessage;
+}
+
+// The host tests never write anything out - the name is all that's asked for
+void DracoSavFilename(char *fn, const char *ext)
+{
+    sprintf(fn, "sav/host.%c%c%c", ext[0], ext[1], ext[2]);
+}
+
+void vdg_set_mode_pia(uint8_t pia_mode)
+{
+    (void)pia_mode;
+}
+
+void PasteScan(u8 strobe)
+{
+    (void)strobe;
+}
+
+// LOADM only injects with BASIC idle at the OK prompt - here it always is
+u8 boot_at_ok_prompt(void)
+{
+    return 1;
+}
+
+void _putchar(char character)
+{
+    putchar(character);
+}
+
+// End of file
@@ -0,0 +1,98 @@
+// =====================================================================================
+// Copyright (c) 2025-2026 Dave Bernazzani (wavemotion-dave)
+//
+// Copying and distribution of this emulator, its source code and associated
+// readme files, with or without modification, are permitted in any medium without
+// royalty provided this copyright notice is used and wavemotion-dave and eyalabraham
+// (Dragon 32 emu core) are thanked profusely.
+//
+// The Draco-DS emulator is offered as-is, without any warranty. Please see readme.md
+// =====================================================================================
+
+#ifndef _HOST_NDS_H_
+#define _HOST_NDS_H_
+
+// ---------------------------------------------------------------------------------------
+// Just enough of libnds for the emulator core (CPU, memory, FDC, tape) to build and run
+// on a PC for the host tests and fuzzers. Nothing here draws, plays or reads keys - the
+// timers tick from the host clock so the self-check and load timing still work.
+// ---------------------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+typedef uint8_t             u8;
+typedef uint16_t            u16;
+typedef uint32_t            u32;
+typedef uint64_t            u64;
+typedef int8_t              s8;
+typedef int16_t             s16;
+typedef int32_t             s32;
+typedef int64_t             s64;
+typedef volatile u8         vu8;
+typedef volatile u16        vu16;
+typedef volatile u32        vu32;
+
+#define ITCM_CODE
+#define DTCM_DATA
+#define BIT(n)              (1 << (n))
+
+#define TIMER_ENABLE        0x80
+#define TIMER_CASCADE       0x04
+#define TIMER_DIV_1         0
+#define TIMER_DIV_64        1
+#define TIMER_DIV_256       2
+#define TIMER_DIV_1024      3
+
+// The four timers count at the DS bus clock (33.514MHz) over the divider from the host clock
+extern vu16 host_timer_data[4];
+extern vu16 host_timer_cr[4];
+
+static inline vu16 *host_timer(int n)
+{
+    static const u8 shift[4] = {0, 6, 8, 10};
+    struct timespec ts;
+
+    if (host_timer_cr[n] & TIMER_ENABLE)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        u64 ticks = (((u64)ts.tv_sec * 1000000000ULL + ts.tv_nsec) * 33514ULL) / 1000000ULL;
+        host_timer_data[n] = (u16)(ticks >> shift[host_timer_cr[n] & 3]);
+    }
+    return &host_timer_data[n];
+}
+
+#define TIMER0_DATA         (*host_timer(0))
+#define TIMER1_DATA         (*host_timer(1))
+#define TIMER2_DATA         (*host_timer(2))
+#define TIMER3_DATA         (*host_timer(3))
+#define TIMER0_CR           (host_timer_cr[0])
+#define TIMER1_CR           (host_timer_cr[1])
+#define TIMER2_CR           (host_timer_cr[2])
+#define TIMER3_CR           (host_timer_cr[3])
+
+#define KEY_A               BIT(0)
+#define KEY_B               BIT(1)
+#define KEY_SELECT          BIT(2)
+#define KEY_START           BIT(3)
+#define KEY_RIGHT           BIT(4)
+#define KEY_LEFT            BIT(5)
+#define KEY_UP              BIT(6)
+#define KEY_DOWN            BIT(7)
+#define KEY_R               BIT(8)
+#define KEY_L               BIT(9)
+#define KEY_X               BIT(10)
+#define KEY_Y               BIT(11)
+#define KEY_TOUCH           BIT(12)
+
+#define DC_FlushAll()
+#define DC_FlushRange(addr, len)
+
+static inline int  isDSiMode(void)          {return 0;}
+static inline void swiWaitForVBlank(void)   {}
+static inline u32  keysCurrent(void)        {return 0;}
+
+#endif // _HOST_NDS_H_
+
+// End of file